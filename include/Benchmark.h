@@ -0,0 +1,99 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "Geometry.h"
+#include <string>
+#include <deque>
+
+class Graph;
+class Projection;
+class LayerManager;
+
+// Mediciones de rendimiento reproducibles. Cada función devuelve un
+// informe de texto listo para mostrar en la ventana de estadísticas.
+class Benchmark {
+public:
+    // Apertura completa vs. parcial (por rectángulo) del contenedor binario
+    static std::string containerOpen(const std::string& containerFile, const Rect& window,
+                                     int repetitions = 5);
+
+    // Exactitud y costo de las distancias proyectadas (equirectangular y UTM)
+    // frente a haversine, con pares aleatorios dentro de la extensión
+    static std::string projectionAccuracy(const Rect& extent, int pairs = 200000);
+
+    // Índice de objetos en movimiento con flotas de 10.000 a 1.000.000: rondas
+    // en las que todos reportan posición seguidas de consultas de rango y
+    // k-NN (actuales y a 3 minutos), frente a reconstruir un R-Tree empaquetado
+    static std::string movingObjects(int rounds = 3, int queries = 200);
+
+    // Construcción del grafo: snapping secuencial vs. por franjas en paralelo
+    static std::string graphBuild(const std::deque<Geometry>& geometries,
+                                  double snapThreshold = 0.0001);
+
+    // Contracción de cadenas de grado 2: nodos, aristas y latencia de A*
+    // sobre el grafo completo y el simplificado (mismos pares de puntos)
+    static std::string chainContraction(const std::deque<Geometry>& geometries,
+                                        const Projection& projection,
+                                        double snapThreshold = 0.0001, int queries = 100);
+
+    // Renumerado de nodos en orden de Hilbert frente al orden de carga:
+    // localidad de los vecinos en memoria y latencia de Dijkstra y A*
+    static std::string nodeOrdering(const std::deque<Geometry>& geometries,
+                                    const Projection& projection,
+                                    double snapThreshold = 0.0001, int queries = 100);
+
+    // Instantánea binaria: construcción desde las geometrías frente a abrir
+    // el archivo mapeado, y latencia de la primera consulta en cada caso
+    static std::string graphSnapshot(const std::deque<Geometry>& geometries,
+                                     const Projection& projection,
+                                     double snapThreshold = 0.0001, int queries = 100);
+
+    // Latencia media y nodos asentados de Dijkstra y A* (uni y bidireccionales)
+    // entre pares de nodos aleatorios
+    static std::string routing(Graph& graph, int queries = 100);
+
+    // Contraction Hierarchies: preproceso, guardado/carga y consultas frente a A*
+    static std::string contractionHierarchy(Graph& graph, int queries = 100);
+
+    // CCH: preparación, personalización (1 hilo y todos) y consultas; luego
+    // actualizaciones de tráfico en otro hilo mientras se sigue consultando
+    static std::string customizableHierarchy(Graph& graph, int queries = 100);
+
+    // Matriz de distancias (despacho): un Dijkstra por fila frente a un A* por par
+    static std::string distanceMatrix(Graph& graph, int sources = 10, int targets = 100);
+
+    // k unidades más cercanas por la red con flotas de 10 a 10.000 unidades:
+    // expansión de red (INE) frente a restricción euclidiana (IER) y a un A*
+    // por unidad, y cuántas veces la más cercana en línea recta no lo es por ruta
+    static std::string nearestUnits(Graph& graph, int k = 5, int queries = 50);
+
+    // Map matching de trazas GPS sintéticas (una muestra cada 10 m) con dos
+    // niveles de ruido: puntos por segundo, error frente a la posición real
+    // comparado con ubicar cada punto en la calle más cercana, y uso del caché
+    static std::string mapMatching(Graph& graph, int traces = 20);
+
+    // Dibujo sin ventana con el rasterizador por software: tiempo por cuadro
+    // del mapa completo, con el grafo encima y con zoom al centro, barrido de
+    // zoom con y sin niveles de detalle, y escritura del cuadro a PNG y PPM
+    static std::string rendering(const LayerManager& layers, const Graph& graph,
+                                 int width = 1024, int height = 768, int frames = 10);
+
+    // Pirámide de teselas XYZ en memoria: generación con 1 hilo y con todos,
+    // tamaño medio, lectura desde el caché y actualización incremental tras
+    // cambiar algunas geometrías frente a regenerar todo
+    static std::string tiles(const LayerManager& layers, int minZoom = 12, int maxZoom = 16);
+
+    // Teselas vectoriales (MVT): latencia de cada tesela generada al vuelo
+    // frente a un presupuesto por tesela, tamaño frente al PNG, pirámide en
+    // paralelo y lectura desde el caché
+    static std::string vectorTiles(const LayerManager& layers, int minZoom = 12, int maxZoom = 16,
+                                   double budgetMs = 20);
+
+    // Isócronas de tres presupuestos: una base (interactivo) y varias en lote
+    static std::string isochrones(Graph& graph, int origins = 20);
+
+    // ALT: landmarks por "farthest" y "avoid", nodos asentados frente a A* euclidiano
+    static std::string landmarks(Graph& graph, int landmarkCount = 16, int queries = 100);
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,62 @@
+#ifndef CONTRACTIONHIERARCHY_H
+#define CONTRACTIONHIERARCHY_H
+
+#include "Graph.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Contraction Hierarchies sobre el grafo de calles (no dirigido).
+//
+// Preproceso: los nodos se contraen de menos a más importantes según los
+// atajos que crearían por arista que eliminan, más su profundidad en la
+// jerarquía. Al contraer un nodo se agrega un atajo entre cada par de
+// vecinos salvo que una búsqueda de testigo encuentre un camino igual o más
+// corto que no pase por él. En cada ronda se contrae en paralelo un conjunto
+// independiente de nodos (mínimos de prioridad a dos saltos).
+//
+// Consulta: Dijkstra bidireccional que sólo sube de rango, con
+// stall-on-demand (no expande nodos a los que se llega más barato bajando
+// desde uno ya alcanzado); los atajos se desempaquetan recursivamente para
+// devolver la ruta sobre el grafo original.
+class ContractionHierarchy {
+private:
+    const Graph* graph;
+    uint64_t graphFingerprint;
+
+    std::vector<int> rank;  // Orden de contracción de cada nodo
+
+    // Grafo ascendente en CSR: aristas de cada nodo hacia nodos de mayor rango
+    std::vector<int> upFirst;
+    std::vector<int> upTarget;
+    std::vector<double> upWeight;
+    std::vector<int> upMiddle;  // Nodo contraído del atajo, -1 = arista original
+
+    int shortcutCount;
+    int threadCount;
+
+    void unpackEdge(int from, int to, int middle, std::vector<int>& out) const;
+    int findUpEdge(int from, int to) const;
+
+public:
+    ContractionHierarchy();
+
+    // Preprocesa el grafo (que debe seguir vivo mientras se consulte)
+    void build(const Graph& g);
+    void clear();
+    bool isReady() const { return graph != nullptr; }
+
+    // Ruta entre dos ubicaciones: los extremos se ubican sobre la arista más
+    // cercana como en Graph::findShortestPath, con los mismos costos parciales
+    Route findPath(const Point& start, const Point& end) const;
+
+    // Persistencia: sólo se acepta un archivo construido sobre el mismo grafo
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename, const Graph& g);
+
+    void setThreadCount(int n) { threadCount = n; }
+    int getShortcutCount() const { return shortcutCount; }  // Pares unidos por un atajo nuevo
+    int getUpEdgeCount() const { return (int)upTarget.size(); }
+};
+
+#endif // CONTRACTIONHIERARCHY_H
@@ -0,0 +1,92 @@
+#ifndef CUSTOMIZABLEHIERARCHY_H
+#define CUSTOMIZABLEHIERARCHY_H
+
+#include "Graph.h"
+#include <vector>
+#include <memory>
+
+// Contraction Hierarchies personalizables (CCH) para pesos que cambian,
+// como las velocidades por tramo que llegan con el tráfico.
+//
+// Preparación (una vez por grafo, sin mirar los pesos): el orden sale de una
+// disección anidada geométrica (se corta por la mediana en la dirección con
+// menos nodos frontera y el separador va arriba) y se contraen los nodos en
+// ese orden agregando todos los atajos, sin búsquedas de testigo.
+//
+// Personalización (cada vez que cambian los pesos): cada arco u -> v toma
+// el mínimo entre su peso y el de sus triángulos inferiores w -> u -> v,
+// que se enumeran al vuelo desde los arcos que llegan a u (no se guardan).
+// Los nodos se procesan por niveles del árbol de eliminación; dentro de un
+// nivel, en paralelo.
+//
+// Cada métrica personalizada es inmutable y se publica reemplazando un
+// puntero compartido: las consultas en curso terminan con la anterior.
+class CustomizableHierarchy {
+public:
+    // Pesos de una personalización
+    struct Metric {
+        std::vector<double> edgeWeight;  // Por id de arista del grafo
+        std::vector<double> upWeight;    // Por arco ascendente (infinito = sin camino)
+        std::vector<int> upMiddle;       // Nodo del mejor triángulo, -1 = arista original
+        int version;
+    };
+
+private:
+    const Graph* graph;
+
+    // Nodos renumerados por rango: order[r] = nodo del grafo, rank[v] = r
+    std::vector<int> order;
+    std::vector<int> rank;
+
+    // Grafo ascendente (rangos) en CSR, destinos ordenados por rango
+    std::vector<int> upFirst;
+    std::vector<int> upTarget;
+    std::vector<int> upSource;
+    std::vector<int> inputArc;  // Arco de cada arista del grafo (-1 = lazo)
+
+    // Arcos que llegan a cada rango desde abajo, en CSR
+    std::vector<int> downFirst;
+    std::vector<int> downArc;
+    long long triangleCount;
+
+    // Nodos agrupados por nivel del árbol de eliminación
+    std::vector<int> levelFirst;
+    std::vector<int> levelNodes;
+
+    std::shared_ptr<const Metric> current;
+    int metricVersion;
+    int threadCount;
+
+    void computeOrder(const Graph& g);
+    int findArc(int low, int high) const;
+    void unpackArc(const Metric& m, int from, int to, std::vector<int>& out) const;
+
+public:
+    CustomizableHierarchy();
+
+    // Fase independiente de los pesos (el grafo debe seguir vivo)
+    void prepare(const Graph& g);
+    void clear();
+    bool isPrepared() const { return graph != nullptr; }
+    bool isReady() const { return getMetric() != nullptr; }
+
+    // Personaliza con un peso por id de arista (ver Graph::getEdgeWeights) y
+    // publica el resultado. Un tramo cerrado se marca con peso infinito
+    // (std::numeric_limits<double>::infinity(); también valen DBL_MAX y NaN):
+    // ninguna ruta lo recorre, aunque sí puede empezar o terminar en sus
+    // nodos. Devuelve false si el vector no corresponde
+    bool customize(const std::vector<double>& weights);
+
+    // Métrica vigente (la que usan las consultas que empiezan ahora)
+    std::shared_ptr<const Metric> getMetric() const;
+
+    // Ruta con la métrica vigente; totalDistance queda en sus unidades
+    Route findPath(const Point& start, const Point& end) const;
+
+    void setThreadCount(int n) { threadCount = n; }
+    int getUpArcCount() const { return (int)upTarget.size(); }
+    long long getTriangleCount() const { return triangleCount; }
+    int getLevelCount() const { return levelFirst.empty() ? 0 : (int)levelFirst.size() - 1; }
+};
+
+#endif // CUSTOMIZABLEHIERARCHY_H
@@ -0,0 +1,18 @@
+#ifndef DEFLATE_H
+#define DEFLATE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Compresor DEFLATE (RFC 1951) con envoltura zlib (RFC 1950), la pareja de
+// Inflate.h. LZ77 con cadenas hash sobre la ventana de 32 KB y códigos
+// Huffman fijos: no llega a la razón de zlib, pero las imágenes del mapa
+// (fondo liso, filas parecidas) se reducen varias veces sin depender de zlib.
+// Si los datos no se comprimen, se guardan sin comprimir (a lo sumo 5 bytes
+// más cada 64 KB).
+
+// Comprime data a un stream zlib (cabecera + DEFLATE + Adler-32); reemplaza out
+void deflateZlib(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+#endif // DEFLATE_H
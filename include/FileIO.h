@@ -0,0 +1,71 @@
+#ifndef FILEIO_H
+#define FILEIO_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Archivo de sólo lectura con lecturas posicionadas (pread en POSIX,
+// ReadFile con OVERLAPPED en Windows). No mantiene un cursor compartido,
+// así que varias lecturas pueden hacerse desde distintos hilos.
+class RandomAccessFile {
+private:
+#ifdef _WIN32
+    void* handle;
+#else
+    int fd;
+#endif
+    uint64_t fileSize;
+
+public:
+    RandomAccessFile();
+    ~RandomAccessFile();
+
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const;
+
+    // Lee exactamente size bytes desde offset
+    bool readAt(uint64_t offset, void* buffer, size_t size) const;
+
+    uint64_t size() const { return fileSize; }
+
+private:
+    RandomAccessFile(const RandomAccessFile&);
+    RandomAccessFile& operator=(const RandomAccessFile&);
+};
+
+// Archivo completo mapeado en memoria (mmap en POSIX, MapViewOfFile en
+// Windows). Las páginas se leen del disco recién cuando se tocan, así que
+// abrirlo no cuesta según su tamaño. El mapeo es privado: escribir en él
+// copia la página en lugar de modificar el archivo.
+class MappedFile {
+private:
+#ifdef _WIN32
+    void* handle;
+    void* mapping;
+#endif
+    uint8_t* base;
+    uint64_t fileSize;
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    uint8_t* data() const { return base; }
+    uint64_t size() const { return fileSize; }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+// Crea el directorio y los que falten en la ruta (separador / o \).
+// Devuelve true si al final existe
+bool createDirectories(const std::string& path);
+
+#endif // FILEIO_H
@@ -0,0 +1,40 @@
+#ifndef GDIBACKEND_H
+#define GDIBACKEND_H
+
+#include "RenderBackend.h"
+#include <windows.h>
+
+// Backend WinAPI GDI: dibuja en un bitmap en memoria (doble buffer) que
+// present() copia a la ventana. GDI no suaviza bordes: las coordenadas se
+// redondean al píxel.
+class GdiBackend : public RenderBackend {
+private:
+    int width, height;
+    HDC memDC;
+    HBITMAP memBitmap;
+    HGDIOBJ previousBitmap;
+
+    HPEN createPen(const Pen& pen) const;
+
+    GdiBackend(const GdiBackend&);
+    GdiBackend& operator=(const GdiBackend&);
+
+public:
+    GdiBackend(HWND window, int w, int h);
+    ~GdiBackend();
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    void clear(const Color& background);
+    void drawPolyline(const Point* points, int count, const Pen& pen);
+    void drawPolygon(const Point* points, const int* ringSizes, int ringCount,
+                     const Color& fill, const Pen& outline);
+    void drawCircle(const Point& center, double radius, const Color& fill, const Pen& outline);
+    void drawText(const Point& topLeft, const std::string& text, double size, const Color& color);
+
+    // Copia el cuadro dibujado al DC de la ventana
+    void present(HDC hdc);
+};
+
+#endif // GDIBACKEND_H
@@ -0,0 +1,65 @@
+#ifndef GEOCONTAINER_H
+#define GEOCONTAINER_H
+
+#include "Geometry.h"
+#include "PackedRTree.h"
+#include "FileIO.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Contenedor binario de geometrías con índice espacial (al estilo FlatGeobuf).
+//
+// Formato (little-endian):
+//   cabecera de 64 bytes | índice PackedRTree | features en orden de Hilbert
+//
+// El índice se carga completo al abrir; las features se leen bajo demanda
+// con lecturas posicionadas, así que cargar una zona sólo toca los bytes de
+// las geometrías que la intersectan.
+
+const char GEOCONTAINER_MAGIC[6] = {'R', 'T', 'G', 'E', 'O', 0};
+const uint8_t GEOCONTAINER_VERSION = 1;
+const size_t GEOCONTAINER_HEADER_SIZE = 64;
+
+class GeoContainerWriter {
+public:
+    static bool write(const std::string& filename, const std::vector<Geometry>& geometries,
+                      uint16_t nodeSize = 16);
+
+    // Convierte un GeoJSON (el formato de entrada actual) a contenedor
+    static bool convertGeoJSON(const std::string& geojsonFile, const std::string& containerFile);
+};
+
+class GeoContainerReader {
+private:
+    RandomAccessFile file;
+    PackedRTree index;
+    uint64_t dataOffset;
+    uint32_t featureCount;
+    Rect bounds;
+    uint64_t bytesRead;
+
+    uint64_t featureEnd(size_t leaf) const;
+    bool readFeatures(std::vector<size_t>& leaves, std::vector<Geometry>& out);
+
+public:
+    GeoContainerReader();
+
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+
+    // Carga todas las geometrías (en orden de Hilbert)
+    bool loadAll(std::vector<Geometry>& out);
+
+    // Carga sólo las geometrías cuyo MBR intersecta el rango
+    bool loadInRect(const Rect& range, std::vector<Geometry>& out);
+
+    int getFeatureCount() const { return (int)featureCount; }
+    Rect getBounds() const { return bounds; }
+
+    // Bytes de features leídos en la última carga
+    uint64_t getLastBytesRead() const { return bytesRead; }
+};
+
+#endif // GEOCONTAINER_H
@@ -13,11 +13,20 @@ private:
 
     void parseCoordinates(const std::string& coords, std::vector<Point>& points);
     void parsePolygonCoordinates(const std::string& coords, std::vector<Point>& points);
+    void parseProperties(const std::string& json, size_t start,
+                         std::vector<std::pair<std::string, std::string>>& properties);
 
 public:
     bool loadFromFile(const std::string& filename);
     const std::vector<Geometry>& getGeometries() const { return geometries; }
 
+    // Entrega las geometrías cargadas (el lector queda vacío)
+    std::vector<Geometry> takeGeometries() {
+        std::vector<Geometry> out;
+        out.swap(geometries);
+        return out;
+    }
+
     Rect getBounds() const;
 
     int getPointCount() const;
@@ -2,6 +2,8 @@
 #define GEOMETRY_H
 
 #include <vector>
+#include <string>
+#include <utility>
 #include <cmath>
 #include <limits>
 #include <algorithm>
@@ -72,7 +74,14 @@ struct Rect {
     }
 
     Point center() const {
-        return Point((minX + maxX) / 2.0, (minY + minY) / 2.0);
+        return Point((minX + maxX) / 2.0, (minY + maxY) / 2.0);
+    }
+
+    // Distancia mínima desde un punto (0 si está dentro)
+    double distanceTo(const Point& p) const {
+        double dx = std::max(0.0, std::max(minX - p.x, p.x - maxX));
+        double dy = std::max(0.0, std::max(minY - p.y, p.y - maxY));
+        return std::sqrt(dx * dx + dy * dy);
     }
 
     // Calcular incremento de área al expandir con otro rectángulo
@@ -96,6 +105,8 @@ public:
     std::vector<Point> points;
     Rect mbr; // Minimum Bounding Rectangle
     int id;
+    std::vector<long long> nodeIds; // IDs OSM de cada vértice (vacío si la fuente no los trae)
+    std::vector<std::pair<std::string, std::string>> properties; // Atributos (clave, valor)
 
     Geometry() : type(GEOM_POINT), id(-1) {}
 
@@ -2,73 +2,361 @@
 #define GRAPH_H
 
 #include "Geometry.h"
+#include "Projection.h"
+#include "PackedRTree.h"
+#include "MappedArray.h"
 #include <vector>
+#include <string>
 #include <map>
+#include <deque>
 #include <queue>
-#include <set>
 #include <limits>
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 
-// Estructura para representar un nodo en el grafo (intersección)
+// Vista de un nodo (intersección) con sus vecinos. El grafo no la guarda:
+// getNode/getNodes la arman a partir de los arreglos CSR
 struct GraphNode {
     int id;
     Point position;
+    Point metric;  // Posición proyectada (metros) para pesos y heurística
     std::vector<int> neighbors;  // IDs de nodos vecinos
     std::vector<double> weights;  // Pesos (distancias) a vecinos
-    
+
     GraphNode() : id(-1) {}
-    GraphNode(int _id, const Point& pos) : id(_id), position(pos) {}
+    GraphNode(int _id, const Point& pos) : id(_id), position(pos), metric(pos) {}
 };
 
 // Estructura para el resultado de búsqueda de ruta
 struct Route {
     std::vector<int> nodeIds;  // Secuencia de nodos
     std::vector<Point> path;   // Secuencia de puntos
-    double totalDistance;
+    double totalDistance;  // En metros si el grafo tiene proyección métrica
     bool found;
-    
-    Route() : totalDistance(0), found(false) {}
+    int settledNodes;      // Nodos asentados por la búsqueda (costo de la consulta)
+
+    Route() : totalDistance(0), found(false), settledNodes(0) {}
+};
+
+// Punto de la red más cercano a una ubicación: arista y posición sobre ella
+struct EdgeSnap {
+    int edge;         // Arista CSR from -> to (en el sentido en que se cargó)
+    int from, to;
+    double t;         // Fracción recorrida desde from (0..1)
+    Point point;      // Punto proyectado sobre la arista (coordenadas geográficas)
+    double distance;  // Distancia desde la ubicación consultada
+
+    EdgeSnap() : edge(-1), from(-1), to(-1), t(0), distance(0) {}
+};
+
+// Matriz densa de distancias de red (fila = origen, columna = destino)
+struct DistanceMatrix {
+    int rows, cols;
+    std::vector<double> values;  // rows * cols, por filas; infinito = sin ruta
+
+    DistanceMatrix() : rows(0), cols(0) {}
+    DistanceMatrix(int r, int c)
+        : rows(r), cols(c), values((size_t)r * c, std::numeric_limits<double>::infinity()) {}
+
+    double at(int row, int col) const { return values[(size_t)row * cols + col]; }
+    bool reachable(int row, int col) const { return std::isfinite(at(row, col)); }
+};
+
+// Área alcanzable desde un punto con un presupuesto de distancia
+struct Isochrone {
+    double budget;                          // Unidades del grafo (metros si es métrico)
+    std::vector<std::vector<Point>> rings;  // Bordes cerrados (lon/lat): exteriores
+                                            // antihorarios, huecos horarios
+    double area;                            // Unidades del grafo al cuadrado
+    int reachedNodes;                       // Nodos dentro del presupuesto
+
+    Isochrone() : budget(0), area(0), reachedNodes(0) {}
+};
+
+// Unidades más cercanas a un punto por distancia de red (ver UnitIndex)
+struct UnitRanking {
+    std::vector<int> units;         // Índice de cada unidad, de la más cercana a la más lejana
+    std::vector<double> distances;  // Distancia de red (unidades del grafo)
+    int settledNodes;               // Nodos asentados en total (costo de la consulta)
+    int verifiedUnits;              // Candidatas verificadas con el router (IER)
+
+    UnitRanking() : settledNodes(0), verifiedUnits(0) {}
 };
 
-// Clase principal del grafo
+class Landmarks;
+class SearchWorkspace;
+class UnitIndex;
+
+// Clase principal del grafo.
+//
+// Representación CSR (Compressed Sparse Row): los nodos tienen ids densos
+// 0..n-1 y las aristas salientes del nodo u ocupan el rango
+// [firstEdge[u], firstEdge[u+1]) de los arreglos edgeTarget/edgeWeight.
+// Las coordenadas se guardan como estructura de arreglos (SoA), así que
+// Dijkstra y A* recorren memoria contigua sin búsquedas en árboles.
+//
+// Además mantiene dos índices espaciales estáticos (nodos y segmentos) en
+// coordenadas proyectadas, para ubicar los extremos de una ruta sobre la
+// calle más cercana en tiempo logarítmico.
+//
+// Por defecto las cadenas de nodos de grado 2 (vértices intermedios de una
+// calle) se contraen: sólo quedan cruces y puntas como nodos, y cada cadena
+// es una arista cuyo peso es el largo total y que guarda sus vértices
+// intermedios para dibujarla, ubicar puntos sobre ella y armar la ruta.
+//
+// Los ids de nodo siguen la curva de Hilbert (no el orden de carga): nodos
+// cercanos en el mapa quedan cerca en memoria, y las búsquedas tocan menos
+// líneas de caché. Como las consultas públicas reciben coordenadas, el
+// renumerado es invisible para quien usa el grafo.
+//
+// El grafo ya construido se puede guardar como instantánea binaria y
+// reabrir mapeando el archivo: los arreglos se usan en el lugar, sin
+// reconstruir ni copiar nada (ver openSnapshot).
 class Graph {
 private:
-    std::map<int, GraphNode> nodes;
-    int nextNodeId;
+    // Coordenadas geográficas (dibujo) y proyectadas (pesos y heurística)
+    MappedArray<double> nodeX, nodeY;
+    MappedArray<double> metricX, metricY;
+
+    // Adyacencia CSR
+    MappedArray<int> firstEdge;    // n + 1 entradas
+    MappedArray<int> edgeTarget;
+    MappedArray<double> edgeWeight;
+    MappedArray<int> edgeRef;      // (id de arista << 1) | 1 si va al revés de la carga
+
+    // Vértices intermedios de la arista id (cadenas contraídas):
+    // [shapeFirst[id], shapeFirst[id+1]) en el sentido de carga
+    MappedArray<int> shapeFirst;
+    MappedArray<double> shapeX, shapeY;
+    MappedArray<double> shapeMetricX, shapeMetricY;
+
+    // Índices espaciales (coordenadas proyectadas)
+    PackedRTree nodeIndex;  // Hoja -> id de nodo
+    PackedRTree edgeIndex;  // Hoja -> arista CSR en su sentido de carga
+
+    // Aristas pendientes durante la construcción (se vuelcan a CSR al final)
+    std::vector<int> pendingFrom, pendingTo;
+    std::vector<double> pendingWeight;
+
+    std::map<long long, int> osmNodeIndex;  // ID OSM -> ID de nodo del grafo
     double snapThreshold;  // Umbral para considerar puntos como el mismo nodo
-    
+    Projection projection;  // Proyección métrica aplicada al construir
+    int threadCount;        // 0 = hilos del equipo
+    int buildPartitions;    // Franjas usadas en la última construcción
+    bool simplifyChains;    // Contraer cadenas de grado 2 al construir
+    bool spatialOrder;      // Renumerar nodos en orden de Hilbert al construir
+
+    // Rejilla hash para el snapping (definida en Graph.cpp)
+    struct SnapGrid;
+
     // Funciones auxiliares
-    int findOrCreateNode(const Point& p);
-    double heuristic(const Point& a, const Point& b) const;
-    
+    int addNode(const Point& p);
+    int findOrCreateNode(const Point& p, SnapGrid* grid);
+    int findOrCreateOsmNode(long long osmId, const Point& p);
+    void build(const std::vector<const Geometry*>& geometries);
+    uint64_t checksumOf(const std::vector<const Geometry*>& geometries) const;
+    void snapSequential(const std::vector<const Geometry*>& lines,
+                        std::vector<std::vector<int>>& lineNodes);
+    void snapPartitioned(const std::vector<const Geometry*>& lines, int threads,
+                         std::vector<std::vector<int>>& lineNodes);
+    void contractChains();
+    void reorderNodes();
+    void buildAdjacency();
+    void buildSpatialIndex();
+    int edgeSource(int edge) const;
+    Rect metricRange(const Rect& range) const;  // Caja métrica de un rango lon/lat
+
+    // Vértices de la arista en su sentido: 0 = from, count - 1 = destino
+    int edgeVertexCount(int edge) const;
+    Point edgeVertex(int edge, int from, int k, bool metric) const;
+
+    // Distancia de q (proyectado) a la polilínea de la arista; opcionalmente
+    // la fracción t del largo hasta el punto más cercano y ese punto (lon/lat)
+    double projectOnEdge(int edge, int from, const Point& q, double* t, Point* point) const;
+
+    // Punto a la fracción t del largo de la arista, y vértices intermedios
+    // estrictamente entre t0 y t1 en el orden del recorrido
+    Point edgePoint(int edge, int from, double t, bool metric) const;
+    void edgeSection(int edge, int from, double t0, double t1, bool metric,
+                     std::vector<Point>& out) const;
+    Route routeBetween(const Point& start, const Point& end, bool useHeuristic,
+                       const Landmarks* landmarks) const;
+    std::vector<Isochrone> isochroneWith(const Point& origin, const std::vector<double>& budgets,
+                                         double cellSize, SearchWorkspace& ws) const;
+    void distanceRow(const EdgeSnap& source, const std::vector<EdgeSnap>& targets,
+                     const std::vector<char>& isEndpoint, int endpointCount,
+                     SearchWorkspace& ws, double* row) const;
+    double heuristic(int node, const Point& goalMetric) const;
+
 public:
     Graph(double threshold = 0.0001);
-    
+
     // Construcción del grafo
     void buildFromGeometries(const std::vector<Geometry>& geometries);
+    void buildFromGeometries(const std::deque<Geometry>& geometries);
     void clear();
-    
-    // Búsqueda de rutas
+
+    // Hilos para el snapping por franjas y las filas de distanceMatrix
+    // (0 = todos los del equipo)
+    void setThreadCount(int n) { threadCount = n; }
+    int getBuildPartitions() const { return buildPartitions; }
+
+    // Contracción de cadenas de grado 2 (se aplica en la próxima construcción)
+    void setSimplifyChains(bool enabled) { simplifyChains = enabled; }
+    bool getSimplifyChains() const { return simplifyChains; }
+
+    // Renumerado espacial de los nodos (se aplica en la próxima construcción)
+    void setSpatialOrder(bool enabled) { spatialOrder = enabled; }
+    bool getSpatialOrder() const { return spatialOrder; }
+
+    // Proyección usada para los pesos (se aplica en la próxima construcción)
+    void setProjection(const Projection& proj) { projection = proj; }
+    const Projection& getProjection() const { return projection; }
+    bool isMetric() const { return projection.isMetric(); }
+
+    // Búsqueda de rutas. Los extremos se ubican sobre la arista más cercana
+    // y la búsqueda parte de ambos nodos de esa arista con el costo parcial
     Route findShortestPath(const Point& start, const Point& end);
     Route findAStarPath(const Point& start, const Point& end);
-    
+
+    // Búsqueda bidireccional sin preproceso: Dijkstra, o A* con el potencial
+    // promediado (pf = (h_destino - h_origen) / 2) que es consistente en
+    // ambos sentidos. Útil cuando CH/ALT todavía no están al día con el grafo
+    Route findBidirectionalPath(const Point& start, const Point& end,
+                                bool useHeuristic = true) const;
+
+    // Distancias de red de cada origen a cada destino (ubicados sobre la
+    // arista más cercana). Cada fila es un único Dijkstra que se detiene al
+    // asentar todos los destinos; las filas se reparten entre hilos, cada uno
+    // con su propio espacio de búsqueda
+    DistanceMatrix distanceMatrix(const std::vector<Point>& sources,
+                                  const std::vector<Point>& targets) const;
+
+    // Isócronas: un solo Dijkstra acotado por el mayor presupuesto asienta
+    // los nodos alcanzables; las aristas alcanzadas (también las parciales)
+    // se rasterizan en una rejilla de lado cellSize (0 = automático) y sus
+    // bordes se convierten en polígonos. Un resultado por presupuesto
+    std::vector<Isochrone> isochrone(const Point& origin, const std::vector<double>& budgets,
+                                     double cellSize = 0) const;
+
+    // Cobertura de varias bases (una fila por origen), repartida entre hilos
+    std::vector<std::vector<Isochrone>> isochrones(const std::vector<Point>& origins,
+                                                   const std::vector<double>& budgets,
+                                                   double cellSize = 0) const;
+
+    // A* con la cota de landmarks (ALT), combinada con la euclidiana
+    Route findALTPath(const Point& start, const Point& end, const Landmarks& landmarks) const;
+
+    // Las k unidades más cercanas por la red (INE, expansión incremental):
+    // un solo Dijkstra desde el punto en el que cada unidad es un nodo
+    // virtual que se alcanza al asentar un extremo de su arista. Termina al
+    // asentar k unidades, así el área explorada depende de la densidad de
+    // la flota y no de su tamaño
+    UnitRanking nearestByNetwork(const Point& p, int k, const UnitIndex& units) const;
+
+    // Misma consulta por restricción euclidiana (IER): recorre las unidades
+    // por distancia en línea recta con el R-Tree, calcula la de red con A*
+    // y se detiene cuando la siguiente en línea recta ya está más lejos que
+    // la k-ésima por la red (la euclidiana es cota inferior)
+    UnitRanking nearestByNetworkIER(const Point& p, int k, const UnitIndex& units) const;
+
     // Consultas
     int findNearestNode(const Point& p) const;
-    const GraphNode* getNode(int id) const;
-    int getNodeCount() const { return nodes.size(); }
-    int getEdgeCount() const;
-    
-    // Acceso a los nodos
-    const std::map<int, GraphNode>& getNodes() const { return nodes; }
-    
+    bool snapToEdge(const Point& p, EdgeSnap& snap) const;
+
+    // Todas las aristas a menos de radius del punto (a lo sumo maxCount, las
+    // más cercanas primero), cada una con su punto ubicado. Devuelve cuántas
+    int snapCandidates(const Point& p, double radius, int maxCount,
+                       std::vector<EdgeSnap>& out) const;
+    // Aristas (sentido de carga, una por arista bidireccional) y nodos cuya
+    // caja toca el rango en lon/lat, con los índices espaciales del grafo.
+    // Se agregan a 'out'; sirve para dibujar sólo lo que está en pantalla
+    void edgesInRange(const Rect& range, std::vector<int>& out) const;
+    void nodesInRange(const Rect& range, std::vector<int>& out) const;
+
+    Point getSnapPosition(const EdgeSnap& snap, bool metric) const {
+        return edgePoint(snap.edge, snap.from, snap.t, metric);
+    }
+    int getNodeCount() const { return (int)nodeX.size(); }
+    int getEdgeCount() const { return (int)edgeTarget.size() / 2; }  // Aristas bidireccionales
+
+    // Acceso a nodos y aristas
+    Point getNodePosition(int id) const { return Point(nodeX[id], nodeY[id]); }
+    Point getMetricPosition(int id) const { return Point(metricX[id], metricY[id]); }
+    int getEdgeBegin(int id) const { return firstEdge[id]; }
+    int getEdgeEnd(int id) const { return firstEdge[id + 1]; }
+    int getEdgeTarget(int edge) const { return edgeTarget[edge]; }
+    double getEdgeWeight(int edge) const { return edgeWeight[edge]; }
+
+    // Acceso anterior a CSR, por compatibilidad: copias armadas en el momento.
+    // getNode devuelve un nodo con id -1 si el id no existe; getNodes recorre
+    // todo el grafo (O(n + m)), para código nuevo conviene el acceso directo
+    GraphNode getNode(int id) const;
+    std::map<int, GraphNode> getNodes() const;
+
+    // Cada arista bidireccional una sola vez: la del sentido de carga
+    bool isForwardEdge(int edge) const { return (edgeRef[edge] & 1) == 0; }
+
+    // Id de la arista bidireccional (0..getEdgeCount()-1, igual en ambos
+    // sentidos) y peso de cada id: base para métricas personalizadas
+    int getEdgeId(int edge) const { return edgeRef[edge] >> 1; }
+    std::vector<double> getEdgeWeights() const;
+
+    // Polilínea completa de la arista (lon/lat), de su origen a su destino
+    void getEdgeGeometry(int edge, std::vector<Point>& points) const;
+    int getShapePointCount() const { return (int)shapeX.size(); }
+
+    // Arma route.path a partir de route.nodeIds siguiendo la forma de las
+    // aristas, incluidos los tramos parciales de origen y destino. Entre
+    // aristas paralelas toma la de menor peso: idWeights (por id de arista,
+    // la métrica con que se buscó la ruta) o, si es nulo, la distancia
+    void buildRoutePath(const EdgeSnap& source, const EdgeSnap& target, Route& route,
+                        const std::vector<double>* idWeights = nullptr) const;
+
+    // Huella de la topología y los pesos (valida archivos de preproceso)
+    uint64_t fingerprint() const;
+
+    // Suma de control de los datos de origen con la configuración actual
+    // (umbral, contracción, orden y proyección): identifica el grafo que
+    // saldría de buildFromGeometries sin construirlo
+    uint64_t sourceChecksum(const std::vector<Geometry>& geometries) const;
+    uint64_t sourceChecksum(const std::deque<Geometry>& geometries) const;
+
+    // Instantánea binaria versionada del grafo construido (nodos, CSR,
+    // formas, proyección e índices espaciales). openSnapshot rechaza el
+    // archivo si no corresponde a sourceChecksum o si algún índice guardado
+    // cae fuera de rango; si lo acepta, mapea el archivo y deja el grafo
+    // listo sin reservar memoria por nodo
+    bool saveSnapshot(const std::string& filename, uint64_t sourceChecksum) const;
+    bool openSnapshot(const std::string& filename, uint64_t sourceChecksum);
+    bool isMapped() const { return firstEdge.isMapped(); }
+
     // Estadísticas
     void printStats() const;
 };
 
 // Implementación inline de algunas funciones cortas
-inline double Graph::heuristic(const Point& a, const Point& b) const {
-    return a.distanceTo(b);
+inline double Graph::heuristic(int node, const Point& goalMetric) const {
+    double dx = metricX[node] - goalMetric.x;
+    double dy = metricY[node] - goalMetric.y;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+inline int Graph::edgeVertexCount(int edge) const {
+    int id = edgeRef[edge] >> 1;
+    return shapeFirst[id + 1] - shapeFirst[id] + 2;
+}
+
+inline Point Graph::edgeVertex(int edge, int from, int k, bool metric) const {
+    int id = edgeRef[edge] >> 1;
+    int inner = shapeFirst[id + 1] - shapeFirst[id];
+    if (k == 0 || k == inner + 1) {
+        int node = k == 0 ? from : edgeTarget[edge];
+        return metric ? Point(metricX[node], metricY[node]) : Point(nodeX[node], nodeY[node]);
+    }
+    int i = (edgeRef[edge] & 1) ? shapeFirst[id + 1] - k : shapeFirst[id] + k - 1;
+    return metric ? Point(shapeMetricX[i], shapeMetricY[i]) : Point(shapeX[i], shapeY[i]);
 }
 
-#endif // GRAPH_H
\ No newline at end of file
+#endif // GRAPH_H
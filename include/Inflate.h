@@ -0,0 +1,19 @@
+#ifndef INFLATE_H
+#define INFLATE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Descompresor DEFLATE (RFC 1951) con envoltura zlib (RFC 1950).
+// Implementación local para no depender de zlib al compilar con MinGW.
+
+// Descomprime un stream DEFLATE crudo. Devuelve false si los datos son inválidos.
+bool inflateRaw(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+// Descomprime un stream zlib (cabecera de 2 bytes + DEFLATE + Adler-32).
+// expectedSize es opcional y sólo se usa para reservar memoria.
+bool inflateZlib(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+                 size_t expectedSize = 0);
+
+#endif // INFLATE_H
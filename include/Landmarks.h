@@ -0,0 +1,75 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include "Graph.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Criterio para elegir los landmarks
+enum LandmarkSelection {
+    LANDMARK_FARTHEST,  // Cada uno el nodo más lejano de los ya elegidos
+    LANDMARK_AVOID      // Goldberg-Werneck: cubre las zonas donde la cota es peor
+};
+
+// Heurística ALT (A*, Landmarks, desigualdad triangular) para el grafo.
+//
+// Se guardan las distancias de red desde cada landmark L a todos los nodos.
+// Como el grafo es no dirigido, d(v, L) = d(L, v) y una sola tabla sirve
+// para ambos sentidos: d(v, t) >= |d(L, t) - d(L, v)|. Cerca de un lago o
+// de un río con pocos cruces esta cota es mucho mejor que la euclidiana.
+//
+// Las distancias se guardan en punto fijo de 32 bits (escala elegida para
+// la distancia máxima del grafo), ordenadas por nodo: los landmarks de un
+// nodo quedan contiguos en memoria.
+class Landmarks {
+public:
+    // Landmarks que se usan en cada consulta (los de mejor cota en el origen)
+    static const int ACTIVE_LANDMARKS = 4;
+
+    // Datos de una consulta: landmarks activos y su distancia al destino
+    struct Target {
+        int active[ACTIVE_LANDMARKS];
+        double distance[ACTIVE_LANDMARKS];
+        int activeCount;
+
+        Target() : activeCount(0) {}
+    };
+
+private:
+    const Graph* graph;
+    uint64_t graphFingerprint;
+    LandmarkSelection selection;
+
+    std::vector<int> landmarkNodes;
+    std::vector<uint32_t> table;  // table[v * count + i] = d(L_i, v) / scale
+    double scale;                 // Unidades del grafo por paso del punto fijo
+
+    double distance(int landmark, int node) const;
+    double targetDistance(int landmark, const EdgeSnap& target) const;
+
+public:
+    Landmarks();
+
+    // Elige 'count' landmarks y calcula sus tablas (el grafo debe seguir vivo)
+    void build(const Graph& g, int count, LandmarkSelection sel = LANDMARK_AVOID);
+    void clear();
+    bool isReady() const { return graph != nullptr; }
+
+    // Prepara una consulta hacia el punto 'target' desde el punto 'source'
+    void prepare(const EdgeSnap& source, const EdgeSnap& target, Target& out) const;
+
+    // Cota inferior de la distancia de red del nodo al destino preparado
+    double lowerBound(int node, const Target& target) const;
+
+    // Persistencia: sólo se acepta un archivo construido sobre el mismo grafo
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename, const Graph& g);
+
+    int getCount() const { return (int)landmarkNodes.size(); }
+    int getLandmark(int i) const { return landmarkNodes[i]; }
+    LandmarkSelection getSelection() const { return selection; }
+    size_t getTableBytes() const { return table.size() * sizeof(uint32_t); }
+};
+
+#endif // LANDMARKS_H
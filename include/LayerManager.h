@@ -0,0 +1,67 @@
+#ifndef LAYERMANAGER_H
+#define LAYERMANAGER_H
+
+#include "Geometry.h"
+#include "RTree.h"
+#include "LevelOfDetail.h"
+#include <deque>
+#include <vector>
+#include <string>
+#include <memory>
+
+// Capa de datos con su propio índice espacial.
+// Las geometrías viven en un deque: agregar al final no mueve las
+// existentes, así que los punteros guardados en el R-Tree siguen válidos.
+// Las versiones simplificadas (lod) se rehacen cada vez que cambia la capa.
+struct Layer {
+    std::string name;
+    std::deque<Geometry> geometries;
+    RTree index;
+    LevelOfDetail lod;
+    bool visible;
+
+    Layer(const std::string& n) : name(n), visible(true) {}
+};
+
+// Conjunto de capas con nombre (calles, POIs, hidrantes, unidades...).
+// Cada capa se agrega, reemplaza o elimina sin tocar el índice de las demás.
+class LayerManager {
+private:
+    std::vector<std::unique_ptr<Layer>> layers;  // En orden de dibujo
+
+    void collectTargets(const std::vector<std::string>& names, std::vector<Layer*>& out);
+
+public:
+    // Agrega geometrías a la capa (la crea si no existe) con inserción incremental
+    Layer& append(const std::string& name, std::vector<Geometry> geoms);
+
+    // Sustituye el contenido de la capa y reconstruye sólo su índice
+    Layer& replace(const std::string& name, std::vector<Geometry> geoms);
+
+    bool drop(const std::string& name);
+    void clear();
+
+    Layer* getLayer(const std::string& name);
+    const Layer* getLayer(const std::string& name) const;
+    size_t getLayerCount() const { return layers.size(); }
+    Layer& getLayerAt(size_t i) { return *layers[i]; }
+    const Layer& getLayerAt(size_t i) const { return *layers[i]; }
+
+    // Consultas sobre una o varias capas (lista vacía = todas las visibles)
+    std::vector<Geometry*> rangeSearch(const Rect& range,
+                                       const std::vector<std::string>& names = std::vector<std::string>());
+    std::vector<Geometry*> kNNSearch(const Point& queryPoint, int k,
+                                     const std::vector<std::string>& names = std::vector<std::string>());
+
+    // Copia de todas las geometrías visibles (para exportar)
+    std::vector<Geometry> collectGeometries() const;
+
+    // Estadísticas agregadas
+    Rect getBounds() const;
+    int getGeometryCount() const;
+    int getTreeHeight() const;
+    int getNodeCount() const;
+    bool empty() const { return getGeometryCount() == 0; }
+};
+
+#endif // LAYERMANAGER_H
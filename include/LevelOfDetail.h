@@ -0,0 +1,68 @@
+#ifndef LEVELOFDETAIL_H
+#define LEVELOFDETAIL_H
+
+#include "Geometry.h"
+#include "PackedRTree.h"
+#include <vector>
+#include <deque>
+
+// Versiones simplificadas de las geometrías de una capa para dibujar con
+// poco zoom. Cada nivel aplica Douglas-Peucker sobre el anterior con una
+// tolerancia 4 veces mayor (la primera es 1/16384 del lado mayor de la
+// capa) y descarta las líneas y polígonos que caben en un píxel del zoom al
+// que se usa. Los puntos pasan a todos los niveles tal cual.
+//
+// Cada nivel guarda sus vértices seguidos en float, relativos a la esquina
+// de la capa ([first[i], first[i+1]) por objeto), y un R-Tree empaquetado
+// propio: la consulta por la vista sólo devuelve lo que el nivel conserva.
+class LevelOfDetail {
+public:
+    static const int LEVELS = 4;  // Sin contar el 0 (geometría original)
+
+private:
+    struct Level {
+        double tolerance;
+        std::vector<float> x, y;
+        std::vector<uint32_t> first;            // count + 1 entradas
+        std::vector<const Geometry*> source;    // Tipo y atributos de cada objeto
+        PackedRTree index;                      // Hoja -> objeto del nivel
+    };
+
+    Point origin;
+    std::vector<Level> levels;  // levels[k - 1] = nivel k
+
+public:
+    LevelOfDetail() {}
+
+    // Las geometrías deben seguir vivas (y en su lugar) mientras se use
+    void build(const std::deque<Geometry>& geometries);
+    void clear();
+
+    int getLevelCount() const { return (int)levels.size(); }
+    double getTolerance(int level) const { return levels[level - 1].tolerance; }
+
+    // Nivel más simple cuyo error no pasa de medio píxel (pixelSize en
+    // unidades del mapa); 0 = usar la geometría original
+    int levelFor(double pixelSize) const;
+
+    // Objetos del nivel (>= 1) cuya caja toca el rango; se agregan a 'out'
+    void search(int level, const Rect& range, std::vector<size_t>& out) const;
+
+    const Geometry& getSource(int level, size_t item) const { return *levels[level - 1].source[item]; }
+    int getVertexCount(int level, size_t item) const {
+        const Level& l = levels[level - 1];
+        return (int)(l.first[item + 1] - l.first[item]);
+    }
+    Point getVertex(int level, size_t item, int k) const {
+        const Level& l = levels[level - 1];
+        size_t v = l.first[item] + k;
+        return Point(origin.x + l.x[v], origin.y + l.y[v]);
+    }
+
+    // Estadísticas de un nivel
+    size_t getObjectCount(int level) const { return levels[level - 1].source.size(); }
+    size_t getVertexTotal(int level) const { return levels[level - 1].x.size(); }
+    size_t getMemoryBytes() const;
+};
+
+#endif // LEVELOFDETAIL_H
@@ -0,0 +1,142 @@
+#ifndef MAPMATCHER_H
+#define MAPMATCHER_H
+
+#include "Graph.h"
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+
+// Punto GPS ajustado a la red
+struct MatchedPoint {
+    int index;       // Número del punto en la traza (orden de llegada)
+    bool matched;    // false = no había calles dentro del radio de búsqueda
+    EdgeSnap snap;   // Arista y posición sobre ella
+    Point position;  // Punto sobre la calle (lon/lat); el original si no se ajustó
+
+    MatchedPoint() : index(-1), matched(false) {}
+};
+
+// Traza GPS sintética sobre una ruta de la red
+struct SyntheticTrace {
+    std::vector<Point> observed;  // Puntos con ruido (lon/lat)
+    std::vector<Point> truth;     // Posición real sobre la red (lon/lat)
+};
+
+// Ajuste de trazas GPS a la red (map matching) con un modelo oculto de
+// Markov resuelto por Viterbi, a medida que llegan los puntos.
+//
+// Los estados de cada punto son las aristas a menos de searchRadius (con
+// el punto ubicado sobre cada una). La emisión penaliza la distancia al GPS
+// (gaussiana de desvío gpsSigma) y la transición la diferencia entre la
+// distancia de ruta y la distancia en línea recta entre puntos consecutivos
+// (exponencial de escala transitionBeta). Rutas más largas que la recta más
+// maxDetour se descartan, lo que acota cada búsqueda. Los puntos a menos de
+// 2 * gpsSigma del último paso no agregan uno nuevo (su distancia en línea
+// recta sería casi todo ruido): se ubican después sobre la calle elegida.
+//
+// Las distancias de ruta salen de árboles de Dijkstra acotados desde los
+// extremos de las aristas candidatas, guardados en un caché: un vehículo
+// que sigue por las mismas calles reutiliza los árboles de los pasos
+// anteriores en lugar de repetir las búsquedas.
+//
+// Un punto queda decidido cuando todos los caminos de Viterbi vigentes
+// pasan por el mismo candidato en ese punto; con eso la salida fluye sin
+// esperar el final de la traza (y a lo sumo maxLag puntos de retraso).
+class MapMatcher {
+private:
+    struct Candidate {
+        EdgeSnap snap;
+        double score;   // Log-probabilidad del mejor camino que termina aquí
+        int previous;   // Candidato elegido en el punto anterior (-1 = inicio)
+    };
+
+    // Punto demasiado cerca del anterior para aportar información: no es un
+    // paso del HMM y se ubica al final sobre la calle elegida
+    struct Follower {
+        int index;
+        Point observed;
+        std::vector<EdgeSnap> candidates;
+    };
+
+    struct Step {
+        int index;
+        Point observed;   // Punto GPS (lon/lat)
+        Point metric;     // Punto GPS proyectado
+        std::vector<Candidate> candidates;
+        std::vector<Follower> followers;
+    };
+
+    // Distancias desde un nodo hasta 'bound', ordenadas por nodo
+    struct Tree {
+        double bound;
+        std::vector<std::pair<int, double>> reached;
+        uint64_t lastUse;
+    };
+
+    const Graph* graph;
+    double gpsSigma;
+    double transitionBeta;
+    double searchRadius;
+    double maxDetour;
+    int maxCandidates;
+    int maxLag;
+
+    std::deque<Step> pending;          // Puntos todavía no decididos
+    std::vector<MatchedPoint> output;  // Puntos decididos sin entregar
+    int nextIndex;
+
+    std::unordered_map<int, Tree> trees;
+    size_t treeCapacity;
+    uint64_t useClock;
+    long long cacheHits, cacheMisses;
+
+    std::vector<EdgeSnap> found;  // Candidatas del último punto (reutilizado)
+
+    const Tree& treeFrom(int node, double bound);
+    double routeDistance(const EdgeSnap& a, const EdgeSnap& b, double bound);
+    // Entrega los primeros stepCount puntos por el camino que termina en
+    // 'candidate' del último de ellos; nextCandidate es el elegido en el punto
+    // que sigue y queda pendiente (-1 = ninguno)
+    void decide(size_t stepCount, int candidate, int nextCandidate = -1);
+    void decideConverged();
+    void flush();
+
+public:
+    explicit MapMatcher(const Graph& g);
+
+    // Parámetros del modelo, en unidades del grafo (metros si es métrico)
+    void setGpsSigma(double sigma) { gpsSigma = sigma; }
+    void setTransitionBeta(double beta) { transitionBeta = beta; }
+    void setSearchRadius(double radius) { searchRadius = radius; }
+    void setMaxDetour(double detour) { maxDetour = detour; }
+    void setMaxCandidates(int count) { maxCandidates = count; }
+    void setMaxLag(int points) { maxLag = points; }
+
+    // Agrega el siguiente punto de la traza; los que queden decididos pasan
+    // a la salida (ver takeMatched)
+    void push(const Point& gps);
+
+    // Fin de la traza: decide los puntos pendientes
+    void finish();
+
+    // Entrega los puntos decididos hasta ahora, en orden
+    std::vector<MatchedPoint> takeMatched();
+    int getPendingCount() const { return (int)pending.size(); }
+
+    // Nueva traza (el caché de árboles se conserva: depende sólo del grafo)
+    void reset();
+
+    // Traza completa de una vez
+    std::vector<MatchedPoint> match(const std::vector<Point>& trace);
+
+    long long getCacheHits() const { return cacheHits; }
+    long long getCacheMisses() const { return cacheMisses; }
+
+    // Traza de prueba: recorre la ruta entre start y end con una muestra
+    // cada 'spacing' y les suma ruido gaussiano de desvío 'noise' por eje
+    static SyntheticTrace synthesize(const Graph& g, const Point& start, const Point& end,
+                                     double spacing, double noise, unsigned seed);
+};
+
+#endif // MAPMATCHER_H
@@ -0,0 +1,128 @@
+#ifndef MAPPEDARRAY_H
+#define MAPPEDARRAY_H
+
+#include "FileIO.h"
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// Arreglo contiguo que vive en un std::vector propio o directamente dentro
+// de un archivo mapeado (MappedFile). Leerlo cuesta lo mismo en ambos casos;
+// sólo cambia de dónde vienen los datos.
+//
+// Las operaciones que cambian el tamaño (push_back, resize, assign...)
+// copian primero los datos mapeados a memoria propia, así el código de
+// construcción no necesita saber si el arreglo venía de un archivo.
+template <typename T>
+class MappedArray {
+private:
+    std::vector<T> owned;
+    T* values;
+    size_t count;
+    std::shared_ptr<MappedFile> file;  // Mantiene vivo el mapeo (nullptr = propio)
+
+    void sync() {
+        values = owned.data();
+        count = owned.size();
+    }
+
+    void own() {
+        if (!file) return;
+        owned.assign(values, values + count);
+        file.reset();
+        sync();
+    }
+
+public:
+    typedef T value_type;
+
+    MappedArray() : values(nullptr), count(0) {}
+
+    MappedArray(const MappedArray& other) : owned(other.owned), file(other.file) {
+        if (file) {
+            values = other.values;
+            count = other.count;
+        } else {
+            sync();
+        }
+    }
+
+    MappedArray& operator=(const MappedArray& other) {
+        if (this != &other) {
+            owned = other.owned;
+            file = other.file;
+            if (file) {
+                values = other.values;
+                count = other.count;
+            } else {
+                sync();
+            }
+        }
+        return *this;
+    }
+
+    // Vista sobre n elementos de un archivo mapeado (data debe estar alineado)
+    void attach(const std::shared_ptr<MappedFile>& mapped, T* data, size_t n) {
+        std::vector<T>().swap(owned);
+        file = mapped;
+        values = data;
+        count = n;
+    }
+    bool isMapped() const { return file != nullptr; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T* data() { return values; }
+    const T* data() const { return values; }
+
+    T& operator[](size_t i) { return values[i]; }
+    const T& operator[](size_t i) const { return values[i]; }
+    T& front() { return values[0]; }
+    const T& front() const { return values[0]; }
+    T& back() { return values[count - 1]; }
+    const T& back() const { return values[count - 1]; }
+
+    T* begin() { return values; }
+    T* end() { return values + count; }
+    const T* begin() const { return values; }
+    const T* end() const { return values + count; }
+
+    void clear() {
+        file.reset();
+        owned.clear();
+        sync();
+    }
+
+    void reserve(size_t n) {
+        own();
+        owned.reserve(n);
+        sync();
+    }
+
+    void resize(size_t n) {
+        own();
+        owned.resize(n);
+        sync();
+    }
+
+    void assign(size_t n, const T& value) {
+        file.reset();
+        owned.assign(n, value);
+        sync();
+    }
+
+    void push_back(const T& value) {
+        own();
+        owned.push_back(value);
+        sync();
+    }
+
+    // Intercambia con un vector: el arreglo queda con esos datos en memoria propia
+    void swap(std::vector<T>& other) {
+        own();
+        owned.swap(other);
+        sync();
+    }
+};
+
+#endif // MAPPEDARRAY_H
@@ -0,0 +1,145 @@
+#ifndef MOVINGOBJECTINDEX_H
+#define MOVINGOBJECTINDEX_H
+
+#include "Geometry.h"
+#include <vector>
+
+// Índice de objetos en movimiento (vehículos de una flota) pensado para
+// muchas actualizaciones de posición por segundo.
+//
+// Es una rejilla uniforme de celdas sobre una extensión fija (los objetos
+// que salen de ella quedan en las celdas del borde). Cada objeto sabe en
+// qué celda y en qué posición de su lista está, así moverlo es O(1): se
+// sobrescribe si no cambió de celda o se pasa de una lista a otra. Las
+// celdas guardan la posición junto al id, así una consulta recorre memoria
+// contigua. El k-NN recorre anillos de celdas alrededor del punto.
+//
+// Con horizonte de predicción (estilo TPR) cada objeto lleva además su
+// velocidad y el momento del reporte, y las consultas "At" responden dónde
+// estarán los objetos en un instante t sin reconstruir nada. Para eso hay
+// una segunda rejilla por clase de velocidad: agrupar sólo por posición
+// mezcla vehículos que van en sentidos opuestos y a los pocos minutos la
+// caja de la celda cubre media ciudad. Las celdas de esa rejilla (y sus
+// bloques de BLOCK_SIZE x BLOCK_SIZE) guardan una caja cinemática: caja de
+// posiciones en un instante de referencia más caja de velocidades. Las
+// cajas sólo crecen al actualizar (quien se va deja la caja como estaba,
+// que sigue siendo válida) y se recalculan cuando una consulta las necesita
+// y cambiaron más veces que objetos tienen: el costo queda amortizado.
+class MovingObjectIndex {
+public:
+    static const int BLOCK_SIZE = 8;
+
+private:
+    // Caja cinemática: en el instante t los objetos están dentro de
+    // box + velocity * (t - time)
+    struct MotionBound {
+        Rect box;
+        Rect velocity;
+        double time;
+        bool empty;
+
+        MotionBound() : time(0), empty(true) {}
+        void expand(const Point& p, const Point& v, double t);
+        void merge(const MotionBound& other);
+        Rect at(double t) const;
+    };
+
+    struct Item {
+        Point position;
+        int id;
+    };
+
+    struct MotionCell {
+        std::vector<int> items;
+        MotionBound bound;
+        int changes;   // Altas, bajas y movimientos desde el último recálculo
+
+        MotionCell() : changes(0) {}
+    };
+
+    struct MotionBlock {
+        MotionBound bound;
+        int count;
+        int changes;
+
+        MotionBlock() : count(0), changes(0) {}
+    };
+
+    Rect extent;
+    double cellSize;
+    int cols, rows;
+    std::vector<std::vector<Item>> cells;
+
+    // Rejilla por clase de velocidad (vacía sin horizonte)
+    double horizon;
+    double motionCellSize, velocityStep, maxSpeed;
+    int motionCols, motionRows, velocityClasses;
+    int blockCols, blockRows;
+    std::vector<MotionCell> motionCells;
+    std::vector<MotionBlock> motionBlocks;
+
+    // Por objeto (id denso; los ids liberados se reutilizan)
+    std::vector<Point> velocities;
+    std::vector<double> times;
+    std::vector<int> cellOf;     // -1 = id libre
+    std::vector<int> slotOf;     // Posición dentro de la lista de la celda
+    std::vector<int> motionOf;
+    std::vector<int> motionSlotOf;
+    std::vector<int> freeIds;
+    int objectCount;
+    double latestTime;
+
+    int cellIndex(const Point& p) const;
+    int motionCellIndex(const Point& p, const Point& v) const;
+    int motionBlockOf(int motionCell) const;
+    void place(int id, const Point& position);
+    void unplace(int id);
+    void placeMotion(int id, const Point& position);
+    void unplaceMotion(int id);
+    void touchMotion(int motionCell, const Point& position, int id);
+    void refreshCell(int motionCell);
+    void refreshBlock(int block);
+    void blockCells(int block, std::vector<int>& out) const;
+
+public:
+    // Rejilla de celdas de lado cellSize sobre la extensión (coordenadas
+    // métricas, p. ej. Graph::getMetricPosition). Con horizon > 0 se arma
+    // también la rejilla predictiva, ajustada a consultas a 'horizon'
+    // segundos de velocidades de hasta maxSpeed (más rápidos también
+    // entran, en las clases extremas)
+    MovingObjectIndex(const Rect& extent, double cellSize, double horizon = 0,
+                      double maxSpeed = 40);
+
+    // Lado de celda para ~perCell objetos por celda si se reparten parejo
+    static double cellSizeFor(const Rect& extent, int expectedCount, int perCell = 8);
+
+    // Alta de un objeto; devuelve su id
+    int insert(const Point& position, double time = 0, const Point& velocity = Point());
+
+    // Nuevo reporte de posición (y velocidad, si hay horizonte)
+    void update(int id, const Point& position, double time = 0);
+    void update(int id, const Point& position, const Point& velocity, double time);
+    void remove(int id);
+    void clear();
+
+    int size() const { return objectCount; }
+    bool contains(int id) const { return id >= 0 && id < (int)cellOf.size() && cellOf[id] != -1; }
+    bool isPredictive() const { return horizon > 0; }
+    Point getPosition(int id) const { return cells[cellOf[id]][slotOf[id]].position; }
+
+    // Posición estimada en el instante t según el último reporte
+    Point getPositionAt(int id, double t) const;
+
+    // Objetos cuya última posición cae en el rango / los k más cercanos
+    // (ordenados por distancia)
+    void rangeSearch(const Rect& range, std::vector<int>& results) const;
+    std::vector<int> kNNSearch(const Point& p, int k) const;
+
+    // Lo mismo en el instante t con posiciones estimadas; sin horizonte
+    // equivale a las consultas sobre la posición actual. No son const: de
+    // paso recalculan las cajas que quedaron flojas
+    void rangeSearchAt(const Rect& range, double t, std::vector<int>& results);
+    std::vector<int> kNNSearchAt(const Point& p, int k, double t);
+};
+
+#endif // MOVINGOBJECTINDEX_H
@@ -0,0 +1,69 @@
+#ifndef PBFREADER_H
+#define PBFREADER_H
+
+#include "Geometry.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Almacén compacto de ubicaciones de nodos OSM: ids ordenados y coordenadas
+// en punto fijo de 1e-7 grados (16 bytes por nodo, sin punteros).
+class NodeLocationStore {
+private:
+    std::vector<long long> ids;
+    std::vector<int32_t> lons;
+    std::vector<int32_t> lats;
+    bool sorted;
+
+public:
+    NodeLocationStore() : sorted(true) {}
+
+    void reserve(size_t n);
+    void add(long long id, int32_t lon, int32_t lat);
+    void finalize();  // Ordena por id si la entrada no venía ordenada
+    void clear();
+
+    bool find(long long id, Point& p) const;
+    size_t size() const { return ids.size(); }
+};
+
+// Lector de archivos OpenStreetMap PBF (.osm.pbf).
+// Descomprime los bloques en paralelo y resuelve las vías a coordenadas
+// mediante NodeLocationStore. Cada geometría conserva los ids OSM de sus
+// vértices en Geometry::nodeIds para que Graph use la topología real, y las
+// etiquetas de la vía en Geometry::properties (como las de GeoJSON).
+class PBFReader {
+private:
+    std::vector<Geometry> geometries;
+    NodeLocationStore nodeStore;
+    int threadCount;
+    bool highwaysOnly;
+    int blockCount;
+    int missingNodes;
+
+public:
+    PBFReader();
+
+    bool loadFromFile(const std::string& filename);
+    const std::vector<Geometry>& getGeometries() const { return geometries; }
+
+    // Entrega las geometrías cargadas (el lector queda vacío)
+    std::vector<Geometry> takeGeometries() {
+        std::vector<Geometry> out;
+        out.swap(geometries);
+        return out;
+    }
+
+    Rect getBounds() const;
+
+    // Configuración
+    void setThreadCount(int n) { threadCount = n; }
+    void setHighwaysOnly(bool only) { highwaysOnly = only; }
+
+    // Estadísticas de la última carga
+    int getBlockCount() const { return blockCount; }
+    int getNodeCount() const { return (int)nodeStore.size(); }
+    int getMissingNodeCount() const { return missingNodes; }
+};
+
+#endif // PBFREADER_H
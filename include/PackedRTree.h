@@ -0,0 +1,76 @@
+#ifndef PACKEDRTREE_H
+#define PACKEDRTREE_H
+
+#include "Geometry.h"
+#include "MappedArray.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+// Elemento del árbol empaquetado: caja y desplazamiento.
+// En hojas, offset es un valor del usuario (p.ej. posición en archivo);
+// en nodos internos, es el índice del primer hijo dentro del arreglo.
+struct PackedRTreeItem {
+    Rect box;
+    uint64_t offset;
+};
+
+// R-Tree estático empaquetado (estilo FlatGeobuf): las hojas se entregan ya
+// ordenadas (normalmente por curva de Hilbert) y los niveles se guardan de
+// arriba hacia abajo en un único arreglo contiguo, sin punteros.
+class PackedRTree {
+private:
+    MappedArray<PackedRTreeItem> nodes;
+    std::vector<std::pair<size_t, size_t>> levelBounds;  // [inicio, fin) por nivel; 0 = hojas
+    size_t numItems;
+    uint16_t nodeSize;
+
+    void computeLevelBounds();
+
+    // Los enlaces de los nodos internos apuntan al primer hijo que les
+    // corresponde: un archivo dañado no puede desviar la búsqueda
+    bool hasValidLinks() const;
+
+public:
+    PackedRTree() : numItems(0), nodeSize(16) {}
+
+    // Construye el árbol a partir de hojas ya ordenadas
+    void build(const std::vector<PackedRTreeItem>& leaves, uint16_t nodeSize = 16);
+
+    // Índices de las hojas (en orden de construcción) que intersectan el rango
+    void search(const Rect& range, std::vector<size_t>& results) const;
+
+    // Hoja más cercana al punto con búsqueda best-first. exactDistance(hoja)
+    // da la distancia real al elemento y nunca debe ser menor que la
+    // distancia a su caja. Devuelve NOT_FOUND si el árbol está vacío.
+    static const size_t NOT_FOUND = (size_t)-1;
+    size_t nearest(const Point& p, const std::function<double(size_t)>& exactDistance,
+                   double* distance = nullptr) const;
+
+    // Recorre las hojas de la más cercana a la más lejana (distancia a su
+    // caja) hasta que visit(hoja, distancia) devuelva false
+    void nearestFirst(const Point& p, const std::function<bool(size_t, double)>& visit) const;
+
+    const PackedRTreeItem& getLeaf(size_t i) const { return nodes[nodes.size() - numItems + i]; }
+    size_t size() const { return numItems; }
+    uint16_t getNodeSize() const { return nodeSize; }
+    Rect getBounds() const { return nodes.empty() ? Rect() : nodes[0].box; }
+
+    // Serialización binaria del arreglo de nodos
+    static size_t serializedSize(size_t numItems, uint16_t nodeSize);
+    void serialize(std::vector<uint8_t>& out) const;
+    bool deserialize(const uint8_t* data, size_t size, size_t numItems, uint16_t nodeSize);
+
+    // Igual que deserialize, pero usa los nodos en el lugar dentro de un
+    // archivo mapeado (sin copiarlos) cuando la memoria coincide con el formato
+    bool attach(const std::shared_ptr<MappedFile>& file, uint8_t* data, size_t size,
+                size_t numItems, uint16_t nodeSize);
+
+    void clear();
+
+    // Índice de Hilbert (orden 16) de un punto dentro de una extensión
+    static uint32_t hilbertIndex(const Point& p, const Rect& extent);
+};
+
+#endif // PACKEDRTREE_H
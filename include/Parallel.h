@@ -0,0 +1,44 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <functional>
+
+// Cantidad de hilos a usar: el valor pedido o, si es 0, los del equipo
+inline int resolveThreadCount(int requested) {
+    int threads = requested > 0 ? requested : (int)std::thread::hardware_concurrency();
+    return threads < 1 ? 1 : threads;
+}
+
+// Ejecuta job(hilo) para hilo en [0, threads) y espera a que terminen todos.
+// El 0 es el que llama; los demás salen de un grupo de hilos persistente que
+// crece según se pida y vive hasta el fin del programa, así lo que cada hilo
+// guarda en thread_local (SearchWorkspace::forThread) se reserva una sola vez.
+// Una llamada anidada o simultánea con otra usa hilos temporales. Si algún
+// hilo lanza una excepción se espera al resto y se relanza en el que llama.
+void runOnWorkers(int threads, const std::function<void(int)>& job);
+
+// Ejecuta fn(i) para i en [0, count) repartiendo el trabajo entre hilos
+template <typename Fn>
+void parallelFor(int count, int threads, Fn fn) {
+    std::atomic<int> next(0);
+    runOnWorkers(threads < count ? threads : count, [&](int) {
+        int i;
+        while ((i = next++) < count) fn(i);
+    });
+}
+
+// Igual que parallelFor, pero fn(i, hilo) recibe además el número de hilo
+// (0..threads-1) para usar espacios de trabajo propios sin sincronizar
+template <typename Fn>
+void parallelForThreads(int count, int threads, Fn fn) {
+    std::atomic<int> next(0);
+    runOnWorkers(threads < count ? threads : count, [&](int thread) {
+        int i;
+        while ((i = next++) < count) fn(i, thread);
+    });
+}
+
+#endif // PARALLEL_H
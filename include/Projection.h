@@ -0,0 +1,50 @@
+#ifndef PROJECTION_H
+#define PROJECTION_H
+
+#include "Geometry.h"
+#include <string>
+
+// Tipo de proyección a un sistema métrico local
+enum ProjectionType {
+    PROJ_NONE,            // Coordenadas tal cual (grados o unidades del archivo)
+    PROJ_EQUIRECTANGULAR, // Equirectangular centrada en la zona de trabajo
+    PROJ_UTM              // Transversa de Mercator, zona UTM del centro (WGS84)
+};
+
+// Proyección de lon/lat (grados) a metros, elegida una sola vez al cargar.
+// Con las coordenadas ya en metros, las distancias del grafo son una resta
+// y una raíz cuadrada en lugar de un haversine por arista.
+class Projection {
+private:
+    ProjectionType type;
+    double lon0, lat0;      // Origen (grados)
+    double cosLat0;         // Equirectangular
+    int zone;               // UTM
+    bool south;
+
+public:
+    Projection();
+
+    // Elige la proyección para una extensión en grados. Si la extensión no
+    // parece geográfica devuelve PROJ_NONE. La equirectangular es la más
+    // barata y, a escala de ciudad, la más cercana a haversine; UTM conviene
+    // cuando el mapa abarca varios grados de latitud.
+    static Projection forExtent(const Rect& extent, ProjectionType type = PROJ_EQUIRECTANGULAR);
+
+    // lon/lat (grados) -> x/y (metros) y viceversa
+    Point forward(const Point& lonLat) const;
+    Point inverse(const Point& xy) const;
+
+    ProjectionType getType() const { return type; }
+    bool isMetric() const { return type != PROJ_NONE; }
+    int getZone() const { return zone; }
+    std::string getName() const;
+
+    // Distancia geodésica de referencia (esfera de radio medio), en metros
+    static double haversine(const Point& lonLatA, const Point& lonLatB);
+
+    // true si la extensión cabe en el rango de lon/lat
+    static bool isGeographic(const Rect& extent);
+};
+
+#endif // PROJECTION_H
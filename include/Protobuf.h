@@ -0,0 +1,166 @@
+#ifndef PROTOBUF_H
+#define PROTOBUF_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Lector y escritor mínimos del formato de cable de Protocol Buffers.
+// No requieren esquemas generados: se recorre o se escribe campo a campo (tag, tipo).
+
+enum WireType {
+    WIRE_VARINT = 0,
+    WIRE_FIXED64 = 1,
+    WIRE_LENGTH = 2,
+    WIRE_FIXED32 = 5
+};
+
+class ProtobufReader {
+private:
+    const uint8_t* cur;
+    const uint8_t* end;
+    uint32_t currentTag;
+    int currentType;
+    bool error;
+
+public:
+    ProtobufReader(const uint8_t* data, size_t size)
+        : cur(data), end(data + size), currentTag(0), currentType(0), error(false) {}
+
+    // Avanza al siguiente campo. Devuelve false al terminar el mensaje o ante error.
+    bool next() {
+        if (cur >= end || error) return false;
+        uint64_t key = varint();
+        currentTag = (uint32_t)(key >> 3);
+        currentType = (int)(key & 7);
+        return !error;
+    }
+
+    uint32_t tag() const { return currentTag; }
+    int type() const { return currentType; }
+    bool hasError() const { return error; }
+
+    uint64_t varint() {
+        uint64_t result = 0;
+        int shift = 0;
+        while (cur < end && shift < 64) {
+            uint8_t b = *cur++;
+            result |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return result;
+            shift += 7;
+        }
+        error = true;
+        return 0;
+    }
+
+    int64_t svarint() {
+        uint64_t v = varint();
+        return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+    }
+
+    uint32_t fixed32() {
+        if (end - cur < 4) { error = true; return 0; }
+        uint32_t v = (uint32_t)cur[0] | ((uint32_t)cur[1] << 8) |
+                     ((uint32_t)cur[2] << 16) | ((uint32_t)cur[3] << 24);
+        cur += 4;
+        return v;
+    }
+
+    uint64_t fixed64() {
+        uint64_t lo = fixed32();
+        uint64_t hi = fixed32();
+        return lo | (hi << 32);
+    }
+
+    // Sub-mensaje o bytes: devuelve un lector sobre la región delimitada
+    ProtobufReader message() {
+        size_t len = (size_t)varint();
+        if (error || (size_t)(end - cur) < len) {
+            error = true;
+            return ProtobufReader(end, 0);
+        }
+        ProtobufReader sub(cur, len);
+        cur += len;
+        return sub;
+    }
+
+    std::string string() {
+        ProtobufReader sub = message();
+        return std::string((const char*)sub.cur, sub.end - sub.cur);
+    }
+
+    const uint8_t* data() const { return cur; }
+    size_t remaining() const { return end - cur; }
+    bool atEnd() const { return cur >= end; }
+
+    // Salta el valor del campo actual según su tipo de cable
+    void skip() {
+        switch (currentType) {
+            case WIRE_VARINT: varint(); break;
+            case WIRE_FIXED64: fixed64(); break;
+            case WIRE_LENGTH: message(); break;
+            case WIRE_FIXED32: fixed32(); break;
+            default: error = true; break;
+        }
+    }
+};
+
+// Escritor: agrega campos al final de un buffer. Los sub-mensajes se arman
+// en otro buffer y se agregan con bytes(), que antepone su largo.
+class ProtobufWriter {
+private:
+    std::vector<uint8_t>& out;
+
+public:
+    explicit ProtobufWriter(std::vector<uint8_t>& buffer) : out(buffer) {}
+
+    void varint(uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back((uint8_t)v);
+    }
+
+    static uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+
+    static size_t varintSize(uint64_t v) {
+        size_t n = 1;
+        for (v >>= 7; v; v >>= 7) n++;
+        return n;
+    }
+
+    void key(uint32_t tag, int type) { varint(((uint64_t)tag << 3) | (uint64_t)type); }
+
+    void field(uint32_t tag, uint64_t v) {
+        key(tag, WIRE_VARINT);
+        varint(v);
+    }
+
+    void bytes(uint32_t tag, const void* data, size_t size) {
+        key(tag, WIRE_LENGTH);
+        varint(size);
+        out.insert(out.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+    }
+
+    void bytes(uint32_t tag, const std::vector<uint8_t>& message) {
+        bytes(tag, message.data(), message.size());
+    }
+
+    void string(uint32_t tag, const std::string& s) { bytes(tag, s.data(), s.size()); }
+
+    // Enteros empaquetados (repeated ... [packed = true])
+    void packed(uint32_t tag, const std::vector<uint32_t>& values) {
+        if (values.empty()) return;
+        size_t length = 0;
+        for (uint32_t v : values) length += varintSize(v);
+        key(tag, WIRE_LENGTH);
+        varint(length);
+        for (uint32_t v : values) varint(v);
+    }
+
+    size_t size() const { return out.size(); }
+};
+
+#endif // PROTOBUF_H
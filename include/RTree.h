@@ -59,7 +59,7 @@ private:
     void adjustTree(RTreeNode* node, RTreeNode* splitNode);
 
     void rangeSearchRecursive(RTreeNode* node, const Rect& range,
-                             std::vector<Geometry*>& results);
+                             std::vector<Geometry*>& results) const;
 
 public:
     RTree();
@@ -67,6 +67,9 @@ public:
 
     void insert(Geometry* geom);
     std::vector<Geometry*> rangeSearch(const Rect& range);
+
+    // Igual, agregando a 'results' (se puede reutilizar entre llamadas)
+    void rangeSearch(const Rect& range, std::vector<Geometry*>& results) const;
     std::vector<Geometry*> kNNSearch(const Point& queryPoint, int k);
 
     RTreeNode* getRoot() const { return root; }
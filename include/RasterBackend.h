@@ -0,0 +1,70 @@
+#ifndef RASTERBACKEND_H
+#define RASTERBACKEND_H
+
+#include "RenderBackend.h"
+#include <vector>
+
+// Rasterizador por software sobre un framebuffer RGBA en memoria: no
+// depende de ninguna API gráfica, así el mapa se puede dibujar (y medir)
+// en un servidor sin pantalla.
+//
+// Todo se reduce a rellenar polígonos: una línea gruesa es la unión de un
+// rectángulo por segmento y un disco por vértice, rellenada de una vez con
+// regla no-cero (las partes que se superponen no se pintan dos veces). El
+// relleno es por líneas de barrido con SUBSAMPLES sublíneas por fila y
+// cobertura horizontal exacta, lo que da bordes suavizados.
+class RasterBackend : public RenderBackend {
+public:
+    static const int SUBSAMPLES = 4;
+
+private:
+    struct Edge {
+        double x0, y0, x1, y1;  // y0 < y1
+        int winding;
+    };
+
+    int width, height;
+    std::vector<uint8_t> pixels;  // RGBA, fila por fila
+
+    // Espacio de trabajo reutilizado entre llamadas
+    std::vector<Point> path;
+    std::vector<int> rings;
+    std::vector<Edge> edges;
+    std::vector<const Edge*> active;
+    std::vector<std::pair<double, int>> crossings;
+    std::vector<float> coverage;
+
+    void fillPath(const Point* points, const int* ringSizes, int ringCount,
+                  const Color& color, bool evenOdd);
+    void addStroke(const Point* points, int count, double width);
+    void addDisc(const Point& center, double radius);
+    void strokePath(const Point* points, int count, const Pen& pen);
+    void blendRow(int y, int x0, int x1, const Color& color);
+
+public:
+    RasterBackend(int w, int h);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    void clear(const Color& background);
+    void drawPolyline(const Point* points, int count, const Pen& pen);
+    void drawPolygon(const Point* points, const int* ringSizes, int ringCount,
+                     const Color& fill, const Pen& outline);
+    void drawCircle(const Point& center, double radius, const Color& fill, const Pen& outline);
+
+    // Fuente de mapa de bits de 5x7 (dígitos, punto y mayúsculas; las minúsculas
+    // se dibujan como mayúsculas y lo demás queda en blanco)
+    void drawText(const Point& topLeft, const std::string& text, double size, const Color& color);
+
+    const uint8_t* getPixels() const { return pixels.data(); }
+    Color getPixel(int x, int y) const;
+
+    // PNG RGBA (filtros por fila + Deflate.h) en memoria o a archivo, y PPM
+    // binario (RGB)
+    void encodePNG(std::vector<uint8_t>& out) const;
+    bool writePNG(const std::string& filename) const;
+    bool writePPM(const std::string& filename) const;
+};
+
+#endif // RASTERBACKEND_H
@@ -0,0 +1,59 @@
+#ifndef RENDERBACKEND_H
+#define RENDERBACKEND_H
+
+#include "Geometry.h"
+#include <string>
+#include <cstdint>
+
+// Color RGBA de 8 bits por canal; alfa 0 = no se dibuja
+struct Color {
+    uint8_t r, g, b, a;
+
+    Color() : r(0), g(0), b(0), a(0) {}
+    Color(uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha = 255)
+        : r(red), g(green), b(blue), a(alpha) {}
+
+    bool isVisible() const { return a > 0; }
+};
+
+// Trazo de líneas y bordes (ancho en píxeles; color invisible = sin trazo)
+struct Pen {
+    Color color;
+    double width;
+    bool dashed;
+
+    Pen() : width(0), dashed(false) {}
+    Pen(const Color& c, double w, bool dash = false) : color(c), width(w), dashed(dash) {}
+
+    bool isVisible() const { return color.isVisible() && width > 0; }
+};
+
+// Destino de dibujo del Renderer. Todas las coordenadas son de pantalla
+// (píxeles, y hacia abajo) y en double: cada backend decide si redondea
+// (GDI) o usa la parte fraccionaria para el antialiasing (RasterBackend).
+class RenderBackend {
+public:
+    virtual ~RenderBackend() {}
+
+    virtual int getWidth() const = 0;
+    virtual int getHeight() const = 0;
+
+    virtual void clear(const Color& background) = 0;
+
+    // Polilínea abierta (cerrada si el último punto repite el primero)
+    virtual void drawPolyline(const Point* points, int count, const Pen& pen) = 0;
+
+    // Polígono de uno o más anillos seguidos en 'points' (ringSizes[i]
+    // puntos cada uno) con regla par-impar: los huecos quedan sin pintar
+    virtual void drawPolygon(const Point* points, const int* ringSizes, int ringCount,
+                             const Color& fill, const Pen& outline) = 0;
+
+    virtual void drawCircle(const Point& center, double radius, const Color& fill,
+                            const Pen& outline) = 0;
+
+    // Texto con la esquina superior izquierda en 'topLeft'; size = alto en píxeles
+    virtual void drawText(const Point& topLeft, const std::string& text, double size,
+                          const Color& color) = 0;
+};
+
+#endif // RENDERBACKEND_H
@@ -4,39 +4,65 @@
 #include "Geometry.h"
 #include "RTree.h"
 #include "Graph.h"
-#include <windows.h>
+#include "LayerManager.h"
+#include "RenderBackend.h"
 #include <vector>
+#include <chrono>
 
+// Dibuja el mapa, el grafo y las consultas sobre un RenderBackend (GDI en
+// la ventana, RasterBackend sin pantalla). Sólo conoce la vista (zoom y
+// desplazamiento) y los estilos; cómo se pinta cada primitiva es del backend.
+// Las capas y el grafo se dibujan consultando sus índices con el área
+// visible, así el costo de un cuadro depende de lo que hay en pantalla.
+// Con poco zoom las capas se dibujan con el nivel de detalle (Layer::lod)
+// que corresponde al tamaño del píxel.
 class Renderer {
 private:
-    HWND hwnd;
+    RenderBackend* backend;
     int width, height;
     Rect viewBounds;
     double zoom;
     Point panOffset;
-
-    // Buffer de doble renderizado
-    HDC memDC;
-    HBITMAP memBitmap;
+    bool useLevelOfDetail;
 
     // Colores
-    COLORREF colorBackground;
-    COLORREF colorStreet;
-    COLORREF colorHighlight;
-    COLORREF colorMBR;
-    COLORREF colorSearchArea;
-    COLORREF colorRoute;
-    COLORREF colorStartPoint;
-    COLORREF colorEndPoint;
-    COLORREF colorGraphNode;
+    Color colorBackground;
+    Color colorStreet;
+    Color colorHighlight;
+    Color colorMBR;
+    Color colorSearchArea;
+    Color colorRoute;
+    Color colorStartPoint;
+    Color colorEndPoint;
+    Color colorGraphNode;
+
+    // Puntos de pantalla y resultados de consultas reutilizados entre cuadros
+    std::vector<Point> screenPoints;
+    std::vector<Geometry*> visibleGeometries;
+    std::vector<int> visibleIds;
+    std::vector<size_t> visibleItems;
+
+    // Contadores del cuadro actual (los reinicia render)
+    std::chrono::steady_clock::time_point frameStart;
+    int drawnCount;
 
     // Conversión de coordenadas geográficas a pantalla
-    POINT geoToScreen(const Point& p);
-    Point screenToGeo(int x, int y);
+    Point geoToScreen(const Point& p) const;
+    Point screenToGeo(int x, int y) const;
+
+    // Área geográfica en pantalla, ampliada 'margin' píxeles por lado para
+    // no recortar trazos y círculos que asoman desde afuera
+    Rect visibleArea(double margin) const;
+    void drawRect(const Rect& area, const Pen& pen);
+
+    // Dibuja screenPoints con el estilo del tipo de geometría
+    void drawShape(GeometryType type, bool highlight);
 
 public:
-    Renderer(HWND window, int w, int h);
-    ~Renderer();
+    // El backend debe seguir vivo mientras se use el Renderer
+    explicit Renderer(RenderBackend& target);
+
+    RenderBackend& getBackend() { return *backend; }
 
     // Configurar vista
     void setViewBounds(const Rect& bounds);
@@ -45,23 +71,36 @@ public:
     void zoomIn(int centerX, int centerY);
     void zoomOut(int centerX, int centerY);
 
-    // Renderizado
-    void render(HDC hdc, const std::vector<Geometry>& geometries);
-    void renderRTreeNodes(HDC hdc, RTreeNode* node, int level);
-    void renderGeometry(HDC hdc, const Geometry& geom, bool highlight = false);
-    void renderSearchArea(HDC hdc, const Rect& area);
-    void renderSearchResults(HDC hdc, const std::vector<Geometry*>& results);
+    // Niveles de detalle por zoom (activos por defecto)
+    void setLevelOfDetail(bool enabled) { useLevelOfDetail = enabled; }
+    bool getLevelOfDetail() const { return useLevelOfDetail; }
+
+    // Renderizado (render limpia el cuadro; el resto dibuja encima)
+    void render(const LayerManager& layers);
+    void renderRTreeNodes(RTreeNode* node, int level);
+    void renderGeometry(const Geometry& geom, bool highlight = false);
+    void renderSearchArea(const Rect& area);
+    void renderSearchResults(const std::vector<Geometry*>& results);
 
     // Nuevo: Renderizado de grafo y rutas
-    void renderGraph(HDC hdc, const Graph& graph);
-    void renderRoute(HDC hdc, const Route& route);
-    void renderRoutePoint(HDC hdc, const Point& p, bool isStart);
+    void renderGraph(const Graph& graph);
+    void renderRoute(const Route& route);
+    void renderRoutePoint(const Point& p, bool isStart);
+    void renderIsochrones(const std::vector<Isochrone>& isochrones);
 
     // Obtener punto en coordenadas geográficas desde pantalla
     Point getGeoPoint(int screenX, int screenY);
 
+    // Tiempo desde que empezó el cuadro (render) y objetos dibujados en él
+    // (en render, sólo los que ocupan más de un píxel);
+    // renderFrameStats los escribe en la esquina superior izquierda
+    double getFrameTime() const;
+    int getDrawnCount() const { return drawnCount; }
+    void renderFrameStats();
+
     // Información
     Rect getViewBounds() const { return viewBounds; }
+    Rect getVisibleBounds() const { return visibleArea(0); }
     double getZoom() const { return zoom; }
 };
 
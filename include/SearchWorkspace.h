@@ -0,0 +1,106 @@
+#ifndef SEARCHWORKSPACE_H
+#define SEARCHWORKSPACE_H
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+
+// Estado reutilizable de una búsqueda (Dijkstra / A*) sobre nodos densos.
+//
+// Cada nodo lleva la marca de la búsqueda que lo tocó por última vez: si la
+// marca no coincide con la actual, el nodo vale "sin visitar". Así empezar
+// una búsqueda nueva es O(1) y el costo de una consulta depende del área
+// explorada, no del tamaño del grafo.
+//
+// La cola es un heap 4-ario indexado con decrease-key: cada nodo aparece a
+// lo sumo una vez, sin entradas obsoletas que haya que descartar.
+class SearchWorkspace {
+public:
+    static const double INF;
+
+private:
+    struct NodeState {
+        double dist;
+        double key;    // Prioridad en la cola (dist + heurística)
+        int pred;
+        int heapPos;   // -1 = fuera de la cola
+        uint32_t stamp;
+        bool settled;
+    };
+
+    std::vector<NodeState> nodes;
+    std::vector<int> heap;
+    uint32_t epoch;
+
+    NodeState& touch(int v);
+    void siftUp(int pos);
+    void siftDown(int pos);
+
+public:
+    SearchWorkspace();
+
+    // Inicia una búsqueda sobre nodeCount nodos (sólo reserva si crece)
+    void prepare(int nodeCount);
+
+    double distance(int v) const;
+    int predecessor(int v) const;
+    bool isSettled(int v) const;
+    bool isReached(int v) const { return nodes[v].stamp == epoch; }
+
+    // Inserta v o mejora su distancia (decrease-key). Devuelve true si mejoró
+    bool relax(int v, double dist, double key, int pred);
+
+    // Extrae el nodo de menor prioridad y lo marca como asentado
+    int pop();
+    bool empty() const { return heap.empty(); }
+    double topKey() const { return nodes[heap[0]].key; }
+
+    // Espacio propio del hilo que llama; 'slot' separa búsquedas simultáneas
+    // del mismo hilo (p. ej. los dos lados de una búsqueda bidireccional).
+    // Vive lo que vive el hilo: el arreglo por nodo se reserva una vez por
+    // hilo, por eso las búsquedas en paralelo van sobre los hilos
+    // persistentes de Parallel.h y no sobre hilos creados por llamada
+    static SearchWorkspace& forThread(int slot = 0);
+};
+
+// Implementación inline de las operaciones por nodo
+inline SearchWorkspace::NodeState& SearchWorkspace::touch(int v) {
+    NodeState& s = nodes[v];
+    if (s.stamp != epoch) {
+        s.dist = INF;
+        s.key = INF;
+        s.pred = -1;
+        s.heapPos = -1;
+        s.stamp = epoch;
+        s.settled = false;
+    }
+    return s;
+}
+
+inline double SearchWorkspace::distance(int v) const {
+    return nodes[v].stamp == epoch ? nodes[v].dist : INF;
+}
+
+inline int SearchWorkspace::predecessor(int v) const {
+    return nodes[v].stamp == epoch ? nodes[v].pred : -1;
+}
+
+inline bool SearchWorkspace::isSettled(int v) const {
+    return nodes[v].stamp == epoch && nodes[v].settled;
+}
+
+inline bool SearchWorkspace::relax(int v, double dist, double key, int pred) {
+    NodeState& s = touch(v);
+    if (s.settled || dist >= s.dist) return false;
+    s.dist = dist;
+    s.key = key;
+    s.pred = pred;
+    if (s.heapPos == -1) {
+        s.heapPos = (int)heap.size();
+        heap.push_back(v);
+    }
+    siftUp(s.heapPos);
+    return true;
+}
+
+#endif // SEARCHWORKSPACE_H
@@ -0,0 +1,150 @@
+#ifndef TILEGENERATOR_H
+#define TILEGENERATOR_H
+
+#include "LayerManager.h"
+#include "RasterBackend.h"
+#include "VectorTile.h"
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <cstdint>
+
+// Tesela XYZ del esquema de OSM/Leaflet: Web Mercator, 2^z x 2^z teselas,
+// y = 0 arriba
+struct TileKey {
+    int z, x, y;
+
+    TileKey() : z(0), x(0), y(0) {}
+    TileKey(int zoom, int tx, int ty) : z(zoom), x(tx), y(ty) {}
+
+    // Clave única para el caché (z < 32)
+    uint64_t pack() const { return ((uint64_t)z << 58) | ((uint64_t)x << 29) | (uint64_t)y; }
+};
+
+// Caché LRU de teselas ya codificadas, limitado en bytes. Se usa desde
+// varios hilos a la vez, así que cada operación toma el mutex.
+class TileCache {
+private:
+    typedef std::list<std::pair<uint64_t, std::vector<uint8_t>>> EntryList;
+
+    size_t capacity;
+    size_t used;
+    EntryList entries;  // La más reciente primero
+    std::unordered_map<uint64_t, EntryList::iterator> lookup;
+    size_t hits, misses;
+    mutable std::mutex mutex;
+
+public:
+    explicit TileCache(size_t capacityBytes);
+
+    bool get(const TileKey& key, std::vector<uint8_t>& out);
+    void put(const TileKey& key, const std::vector<uint8_t>& data);
+    bool erase(const TileKey& key);
+    void clear();
+    void setCapacity(size_t capacityBytes);
+
+    size_t size() const;
+    size_t getBytes() const;
+    size_t getHits() const;
+    size_t getMisses() const;
+};
+
+enum TileFormat {
+    TILE_PNG,  // Imagen (Leaflet: L.tileLayer)
+    TILE_MVT   // Mapbox Vector Tile (MapLibre, Leaflet.VectorGrid)
+};
+
+// Genera la pirámide de teselas del mapa (capas visibles) para clientes web
+// y móviles (Leaflet: L.tileLayer("tiles/{z}/{x}/{y}.png")).
+//
+// Cada tesela consulta el R-Tree (o el nivel de detalle que corresponde a
+// su zoom) de cada capa con su caja más un margen, recorta las geometrías a
+// ese margen y las dibuja con RasterBackend o las codifica como MVT con
+// VectorTileEncoder. Las teselas se reparten entre hilos, cada uno con su
+// propio espacio de trabajo, y quedan en un caché LRU en memoria y, si se
+// indicó un directorio, en disco como z/x/y.png (o .mvt). update() rehace
+// sólo las teselas cuyas cajas tocan geometrías cambiadas.
+class TileGenerator {
+public:
+    static const int TILE_SIZE = 256;
+
+private:
+    // Espacio de trabajo de un hilo
+    struct Workspace {
+        RasterBackend canvas;
+        VectorTileEncoder encoder;
+        std::vector<Geometry*> geometries;
+        std::vector<size_t> items;
+        std::vector<Point> points, clipped, scratch;
+        std::vector<int> counts;
+        std::vector<uint8_t> data;  // Tesela codificada
+
+        Workspace() : canvas(TILE_SIZE, TILE_SIZE) {}
+    };
+
+    const LayerManager* layers;
+    TileFormat format;
+    TileCache cache;
+    std::string directory;  // Vacío = sólo en memoria
+    int threadCount;
+    int minZoom, maxZoom;   // Rango de la última pirámide (-1 = ninguna)
+    std::atomic<size_t> rendered;
+
+    void drawFeature(GeometryType type, Workspace& ws) const;
+    void renderTile(const TileKey& key, Workspace& ws) const;
+    bool saveTile(const TileKey& key, const std::vector<uint8_t>& data) const;
+    int renderAll(const std::vector<TileKey>& keys);
+
+    TileGenerator(const TileGenerator&);
+    TileGenerator& operator=(const TileGenerator&);
+
+public:
+    // Las capas deben seguir vivas mientras se use el generador
+    explicit TileGenerator(const LayerManager& source, TileFormat tileFormat = TILE_PNG,
+                           size_t cacheBytes = 64u << 20);
+
+    TileFormat getFormat() const { return format; }
+
+    // Hilos para generar (0 = todos los del equipo)
+    void setThreadCount(int n) { threadCount = n; }
+
+    // Directorio raíz para escribir z/x/y.png o .mvt (vacío = no escribir)
+    void setDirectory(const std::string& dir) { directory = dir; }
+    const std::string& getDirectory() const { return directory; }
+
+    // Tesela codificada (PNG o MVT): del caché o generada en el momento
+    bool getTile(const TileKey& key, std::vector<uint8_t>& data);
+
+    // Todas las teselas que cubren las capas entre minZoom y maxZoom (en
+    // paralelo). Devuelve cuántas se generaron (0 si el mapa no está en lon/lat)
+    int generate(int minZoom, int maxZoom);
+
+    // Regenera, en los zooms de la última pirámide, las teselas que tocan
+    // alguna de las cajas (lon/lat) de geometrías agregadas, cambiadas o
+    // eliminadas. Devuelve cuántas se rehicieron
+    int update(const std::vector<Rect>& changed);
+
+    bool hasPyramid() const { return maxZoom >= 0; }
+    int getMinZoom() const { return minZoom; }
+    int getMaxZoom() const { return maxZoom; }
+    size_t getRenderedCount() const { return rendered; }
+    TileCache& getCache() { return cache; }
+
+    // Geometría de las teselas
+    static Rect tileBounds(const TileKey& key);  // lon/lat
+    static Point toPixel(const Point& lonLat, int z);  // Píxel global del zoom z
+    static void tileRange(const Rect& area, int z, int& x0, int& y0, int& x1, int& y1);
+
+    // Recorte a una caja: la línea se parte en los tramos que quedan dentro
+    // (se agregan a out y su largo a counts); el anillo (sin repetir el
+    // primer vértice) se recorta con Sutherland-Hodgman y reemplaza out
+    static void clipLine(const Point* pts, int count, const Rect& box, std::vector<Point>& out,
+                         std::vector<int>& counts);
+    static void clipPolygon(const Point* ring, int count, const Rect& box, std::vector<Point>& out,
+                            std::vector<Point>& scratch);
+};
+
+#endif // TILEGENERATOR_H
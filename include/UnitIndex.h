@@ -0,0 +1,52 @@
+#ifndef UNITINDEX_H
+#define UNITINDEX_H
+
+#include "Graph.h"
+#include "PackedRTree.h"
+#include <vector>
+#include <deque>
+
+// Unidades (ambulancias, patrulleros, bomberos...) ubicadas sobre la red
+// para buscar las más cercanas por distancia de ruta (Graph::nearestByNetwork).
+//
+// Cada unidad se ubica sobre la arista más cercana y queda registrada en la
+// lista de esa arista (por id de arista, en CSR), así la expansión de red
+// encuentra las unidades de una arista al asentar sus extremos. Además se
+// indexa el punto ubicado en un R-Tree empaquetado (coordenadas proyectadas)
+// para recorrer las unidades por distancia euclidiana (variante IER).
+class UnitIndex {
+private:
+    const Graph* graph;
+    std::vector<Point> positions;   // Ubicación dada (lon/lat)
+    std::vector<EdgeSnap> snaps;    // Punto de la red de cada unidad
+
+    // Unidades por id de arista: [edgeFirst[id], edgeFirst[id+1]) en edgeUnits
+    std::vector<int> edgeFirst;
+    std::vector<int> edgeUnits;
+
+    PackedRTree euclidean;  // Hoja -> unidad, caja = punto ubicado (métrico)
+
+public:
+    UnitIndex();
+
+    // Ubica las unidades sobre el grafo (que debe seguir vivo). Con
+    // geometrías, cada unidad es el centro de la caja de una geometría y su
+    // índice coincide con la posición en el contenedor
+    bool build(const Graph& g, const std::vector<Point>& unitPositions);
+    bool build(const Graph& g, const std::deque<Geometry>& geometries);
+    void clear();
+
+    const Graph* getGraph() const { return graph; }
+    int size() const { return (int)positions.size(); }
+    Point getPosition(int unit) const { return positions[unit]; }
+    const EdgeSnap& getSnap(int unit) const { return snaps[unit]; }
+
+    // Unidades sobre la arista bidireccional id (ver Graph::getEdgeId)
+    int getEdgeUnitsBegin(int edgeId) const { return edgeFirst[edgeId]; }
+    int getEdgeUnitsEnd(int edgeId) const { return edgeFirst[edgeId + 1]; }
+    int getEdgeUnit(int i) const { return edgeUnits[i]; }
+
+    const PackedRTree& getEuclideanIndex() const { return euclidean; }
+};
+
+#endif // UNITINDEX_H
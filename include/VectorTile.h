@@ -0,0 +1,58 @@
+#ifndef VECTORTILE_H
+#define VECTORTILE_H
+
+#include "Geometry.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+struct TileKey;
+class LayerManager;
+
+// Codificador de teselas vectoriales Mapbox Vector Tile (versión 2).
+//
+// Cada capa visible del mapa es una capa de la tesela. Las geometrías salen
+// de una consulta al R-Tree (o al nivel de detalle del zoom, la misma
+// simplificación que el dibujo) con la caja de la tesela más el borde; se
+// recortan a ese borde, se cuantizan a la rejilla de EXTENT x EXTENT y se
+// descartan vértices repetidos y figuras que quedan degeneradas. Los
+// atributos (properties) van como claves y valores de texto compartidos por
+// la capa. El resultado es el protobuf sin comprimir (.mvt / .pbf).
+//
+// Guarda buffers de trabajo: un codificador por hilo.
+class VectorTileEncoder {
+public:
+    static const int EXTENT = 4096;
+    static const int BUFFER = 64;  // Borde alrededor de la tesela, en unidades de EXTENT
+
+private:
+    std::vector<Geometry*> geometries;
+    std::vector<size_t> items;
+    std::vector<Point> points, clipped, scratch;
+    std::vector<int> counts;
+    std::vector<int32_t> grid;  // x, y intercalados ya cuantizados
+    std::vector<uint32_t> commands, tags;
+    std::vector<uint8_t> feature, layer;
+    std::unordered_map<std::string, uint32_t> keyIndex, valueIndex;
+    std::vector<const std::string*> keys, values;
+    size_t featureCount, taggedCount;
+
+    // Cuantiza points (en unidades de EXTENT) y arma los comandos de una
+    // parte: MoveTo + LineTo (+ ClosePath en anillos). false si degenera
+    bool encodePart(const Point* pts, int count, GeometryType type, int32_t& cursorX, int32_t& cursorY);
+    void addFeature(const Geometry& source, GeometryType type);
+    void addLayer(const std::string& name, std::vector<uint8_t>& out);
+
+public:
+    VectorTileEncoder() : featureCount(0), taggedCount(0) {}
+
+    // Codifica la tesela con las capas visibles; reemplaza out
+    void encode(const LayerManager& layers, const TileKey& key, std::vector<uint8_t>& out);
+
+    // Entidades escritas en la última tesela, y cuántas llevan atributos
+    size_t getFeatureCount() const { return featureCount; }
+    size_t getTaggedFeatureCount() const { return taggedCount; }
+};
+
+#endif // VECTORTILE_H
@@ -3,18 +3,44 @@
 #include <string>
 #include <sstream>
 #include <chrono>
+#include <cstdio>
 #include "../include/Geometry.h"
 #include "../include/RTree.h"
 #include "../include/GeoJSONParser.h"
+#include "../include/PBFReader.h"
+#include "../include/GeoContainer.h"
+#include "../include/Benchmark.h"
+#include "../include/Projection.h"
+#include "../include/LayerManager.h"
 #include "../include/Renderer.h"
+#include "../include/GdiBackend.h"
 #include "../include/Graph.h"
+#include "../include/ContractionHierarchy.h"
+#include "../include/Landmarks.h"
+#include "../include/CustomizableHierarchy.h"
+#include "../include/TileGenerator.h"
+#include <random>
 
 // Variables globales
 HINSTANCE hInst;
 HWND hwndMain, hwndStatus, hwndToolbar;
 GeoJSONParser parser;
-RTree rtree;
+PBFReader pbfReader;
+LayerManager layers;
+const char* STREET_LAYER = "calles";  // Capa base: de ella se construye el grafo
 Graph roadGraph;
+const char* GRAPH_CACHE = "ruteo.rtgraph";  // Instantánea del grafo de la última capa de calles
+ContractionHierarchy hierarchy;  // Vacía hasta "Preparar CH"
+const char* HIERARCHY_CACHE = "ruteo.rtch";
+Landmarks landmarks;  // Cotas ALT, vacías hasta "Preparar ALT"
+const char* LANDMARK_CACHE = "ruteo.rtalt";
+const int LANDMARK_COUNT = 16;
+CustomizableHierarchy traffic;  // Tiempos con tráfico, vacía hasta "Trafico"
+TileGenerator tiles(layers);  // Teselas XYZ, vacías hasta "Teselas"
+TileGenerator vectorTiles(layers, TILE_MVT);
+const char* TILE_DIRECTORY = "tiles";
+const int TILE_MIN_ZOOM = 12, TILE_MAX_ZOOM = 16;
+GdiBackend* canvas = nullptr;  // Doble buffer de la ventana
 Renderer* renderer = nullptr;
 std::vector<Geometry*> searchResults;
 bool showRTreeNodes = false;
@@ -28,7 +54,8 @@ bool isDrawingSearchArea = false;
 enum RouteMode {
     ROUTE_NONE,
     ROUTE_SELECT_START,
-    ROUTE_SELECT_END
+    ROUTE_SELECT_END,
+    ROUTE_SELECT_ISOCHRONE  // Clic (y arrastre) ubica el origen de las isócronas
 };
 
 RouteMode routeMode = ROUTE_NONE;
@@ -36,6 +63,13 @@ Point routeStart, routeEnd;
 bool hasRouteStart = false, hasRouteEnd = false;
 Route currentRoute;
 
+// Isócronas de 4/8/12 minutos a velocidad urbana
+const double ISOCHRONE_MINUTES[] = {4, 8, 12};
+const double URBAN_SPEED_KMH = 30;
+std::vector<Isochrone> isochrones;
+Point isochroneOrigin;
+bool isDraggingIsochrone = false;
+
 // Estadísticas de rendimiento
 struct Stats {
     int totalGeometries;
@@ -48,6 +82,7 @@ struct Stats {
     int graphEdges;
     double routeDistance;
     double routeTime;
+    double isochroneTime;
 } stats;
 
 // Declaraciones de funciones
@@ -60,9 +95,24 @@ void UpdateStatusBar();
 void ShowStatistics(HWND hwnd);
 void CreateToolbar(HWND hwnd);
 void BuildGraph(HWND hwnd);
+uint64_t PrepareGraphSource(const Layer* streets);
+void PrepareHierarchy(HWND hwnd);
+void PrepareLandmarks(HWND hwnd);
+void UpdateTraffic(HWND hwnd);
 void StartRouteSelection(HWND hwnd);
+void StartIsochroneSelection(HWND hwnd);
+void CalculateIsochrones();
 void CalculateRoute(HWND hwnd);
 void ClearRoute();
+void ExportContainer(HWND hwnd);
+void RunBenchmark(HWND hwnd);
+bool HasExtension(const std::string& filename, const std::string& ext);
+bool LoadDataFile(const std::string& filename, std::vector<Geometry>& out);
+std::string LayerNameFromFile(const std::string& filename);
+void DropLastLayer(HWND hwnd);
+void GenerateTiles(HWND hwnd);
+void CollectLayerBounds(const std::string& name, std::vector<Rect>& out);
+const char* DistanceUnit();
 
 // Entrada principal
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
@@ -140,10 +190,12 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             int statusHeight = rcStatus.bottom - rcStatus.top;
 
             if (renderer) delete renderer;
-            renderer = new Renderer(hwnd, width, height - toolbarHeight - statusHeight);
+            if (canvas) delete canvas;
+            canvas = new GdiBackend(hwnd, width, height - toolbarHeight - statusHeight);
+            renderer = new Renderer(*canvas);
 
-            if (!parser.getGeometries().empty()) {
-                renderer->setViewBounds(parser.getBounds());
+            if (!layers.empty()) {
+                renderer->setViewBounds(layers.getBounds());
             }
 
             InvalidateRect(hwnd, NULL, TRUE);
@@ -155,34 +207,48 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             HDC hdc = BeginPaint(hwnd, &ps);
 
             if (renderer) {
-                renderer->render(hdc, parser.getGeometries());
+                renderer->render(layers);
 
                 if (showGraph && roadGraph.getNodeCount() > 0) {
-                    renderer->renderGraph(hdc, roadGraph);
+                    renderer->renderGraph(roadGraph);
                 }
 
-                if (showRTreeNodes && rtree.getRoot()) {
-                    renderer->renderRTreeNodes(hdc, rtree.getRoot(), 0);
+                if (showRTreeNodes) {
+                    for (size_t i = 0; i < layers.getLayerCount(); i++) {
+                        const Layer& layer = layers.getLayerAt(i);
+                        if (layer.visible) {
+                            renderer->renderRTreeNodes(layer.index.getRoot(), 0);
+                        }
+                    }
                 }
 
                 if (!searchResults.empty()) {
-                    renderer->renderSearchResults(hdc, searchResults);
+                    renderer->renderSearchResults(searchResults);
                 }
 
                 if (isDrawingSearchArea) {
-                    renderer->renderSearchArea(hdc, searchArea);
+                    renderer->renderSearchArea(searchArea);
+                }
+
+                if (!isochrones.empty()) {
+                    renderer->renderIsochrones(isochrones);
+                    renderer->renderRoutePoint(isochroneOrigin, true);
                 }
 
                 // Renderizar ruta y puntos
                 if (currentRoute.found) {
-                    renderer->renderRoute(hdc, currentRoute);
+                    renderer->renderRoute(currentRoute);
                 }
                 if (hasRouteStart) {
-                    renderer->renderRoutePoint(hdc, routeStart, true);
+                    renderer->renderRoutePoint(routeStart, true);
                 }
                 if (hasRouteEnd) {
-                    renderer->renderRoutePoint(hdc, routeEnd, false);
+                    renderer->renderRoutePoint(routeEnd, false);
                 }
+
+                // Tiempo de dibujo del cuadro y objetos que pasaron el recorte
+                renderer->renderFrameStats();
+                canvas->present(hdc);
             }
 
             EndPaint(hwnd, &ps);
@@ -205,6 +271,13 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                 routeMode = ROUTE_NONE;
                 CalculateRoute(hwnd);
                 InvalidateRect(hwnd, NULL, TRUE);
+            } else if (routeMode == ROUTE_SELECT_ISOCHRONE) {
+                // Mientras se mantenga el botón, el origen sigue al mouse
+                isochroneOrigin = renderer->getGeoPoint(x, y);
+                isDraggingIsochrone = true;
+                SetCapture(hwnd);
+                CalculateIsochrones();
+                InvalidateRect(hwnd, NULL, TRUE);
             } else {
                 isDragging = true;
                 lastMousePos.x = x;
@@ -215,6 +288,11 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         }
 
         case WM_LBUTTONUP: {
+            if (isDraggingIsochrone) {
+                isDraggingIsochrone = false;
+                routeMode = ROUTE_NONE;
+                UpdateStatusBar();
+            }
             isDragging = false;
             ReleaseCapture();
             break;
@@ -260,6 +338,12 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             int x = LOWORD(lParam);
             int y = HIWORD(lParam);
 
+            if (isDraggingIsochrone && renderer) {
+                isochroneOrigin = renderer->getGeoPoint(x, y);
+                CalculateIsochrones();
+                InvalidateRect(hwnd, NULL, TRUE);
+            }
+
             if (isDragging && renderer) {
                 int dx = x - lastMousePos.x;
                 int dy = y - lastMousePos.y;
@@ -306,9 +390,9 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                     InvalidateRect(hwnd, NULL, TRUE);
                     break;
                 case 3: // Resetear vista
-                    if (renderer && !parser.getGeometries().empty()) {
+                    if (renderer && !layers.empty()) {
                         renderer->resetView();
-                        renderer->setViewBounds(parser.getBounds());
+                        renderer->setViewBounds(layers.getBounds());
                         InvalidateRect(hwnd, NULL, TRUE);
                     }
                     break;
@@ -316,8 +400,8 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                     ShowStatistics(hwnd);
                     break;
                 case 5: // Búsqueda K-NN
-                    if (!parser.getGeometries().empty()) {
-                        Point center = parser.getBounds().center();
+                    if (!layers.empty()) {
+                        Point center = layers.getBounds().center();
                         PerformKNNSearch(hwnd, center, 5);
                     }
                     break;
@@ -335,12 +419,37 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                     ClearRoute();
                     InvalidateRect(hwnd, NULL, TRUE);
                     break;
+                case 10: // Exportar contenedor binario
+                    ExportContainer(hwnd);
+                    break;
+                case 11: // Benchmark
+                    RunBenchmark(hwnd);
+                    break;
+                case 12: // Quitar la última capa adicional
+                    DropLastLayer(hwnd);
+                    break;
+                case 13: // Preprocesar el grafo para rutas rápidas
+                    PrepareHierarchy(hwnd);
+                    break;
+                case 14: // Landmarks para A* (ALT)
+                    PrepareLandmarks(hwnd);
+                    break;
+                case 15: // Isócronas desde un punto
+                    StartIsochroneSelection(hwnd);
+                    break;
+                case 16: // Actualización de velocidades (tráfico)
+                    UpdateTraffic(hwnd);
+                    break;
+                case 17: // Pirámide de teselas para clientes web
+                    GenerateTiles(hwnd);
+                    break;
             }
             break;
         }
 
         case WM_DESTROY:
             if (renderer) delete renderer;
+            if (canvas) delete canvas;
             PostQuitMessage(0);
             break;
 
@@ -370,6 +479,7 @@ void InitializeApplication(HWND hwnd) {
     stats.graphEdges = 0;
     stats.routeDistance = 0;
     stats.routeTime = 0;
+    stats.isochroneTime = 0;
 
     UpdateStatusBar();
 }
@@ -394,10 +504,19 @@ void CreateToolbar(HWND hwnd) {
         {0, 6, TBSTATE_ENABLED, TBSTYLE_BUTTON, {0}, 0, (INT_PTR)"Construir Grafo"},
         {0, 7, TBSTATE_ENABLED, TBSTYLE_CHECK, {0}, 0, (INT_PTR)"Ver Grafo"},
         {0, 8, TBSTATE_ENABLED, TBSTYLE_BUTTON, {0}, 0, (INT_PTR)"Calcular Ruta"},
-        {0, 9, TBSTATE_ENABLED, TBSTYLE_BUTTON, {0}, 0, (INT_PTR)"Limpiar Ruta"}
+        {0, 9, TBSTATE_ENABLED, TBSTYLE_BUTTON, {0}, 0, (INT_PTR)"Limpiar Ruta"},
+        {0, 0, TBSTATE_ENABLED, TBSTYLE_SEP, {0}, 0, 0},
+        {0, 10, TBSTATE_ENABLED, TBSTYLE_BUTTON, {0}, 0, (INT_PTR)"Exportar .rtgeo"},
+        {0, 11, TBSTATE_ENABLED, TBSTYLE_BUTTON, {0}, 0, (INT_PTR)"Benchmark"},
+        {0, 12, TBSTATE_ENABLED, TBSTYLE_BUTTON, {0}, 0, (INT_PTR)"Quitar Capa"},
+        {0, 13, TBSTATE_ENABLED, TBSTYLE_BUTTON, {0}, 0, (INT_PTR)"Preparar CH"},
+        {0, 14, TBSTATE_ENABLED, TBSTYLE_BUTTON, {0}, 0, (INT_PTR)"Preparar ALT"},
+        {0, 15, TBSTATE_ENABLED, TBSTYLE_BUTTON, {0}, 0, (INT_PTR)"Isocronas"},
+        {0, 16, TBSTATE_ENABLED, TBSTYLE_BUTTON, {0}, 0, (INT_PTR)"Trafico"},
+        {0, 17, TBSTATE_ENABLED, TBSTYLE_BUTTON, {0}, 0, (INT_PTR)"Teselas"}
     };
 
-    SendMessage(hwndToolbar, TB_ADDBUTTONS, 10, (LPARAM)buttons);
+    SendMessage(hwndToolbar, TB_ADDBUTTONS, sizeof(buttons) / sizeof(buttons[0]), (LPARAM)buttons);
     SendMessage(hwndToolbar, TB_AUTOSIZE, 0, 0);
 }
 
@@ -409,58 +528,306 @@ void LoadGeoJSONFile(HWND hwnd) {
     ofn.hwndOwner = hwnd;
     ofn.lpstrFile = szFile;
     ofn.nMaxFile = sizeof(szFile);
-    ofn.lpstrFilter = "GeoJSON Files\0*.geojson;*.json\0All Files\0*.*\0";
+    ofn.lpstrFilter = "GeoJSON Files\0*.geojson;*.json\0OSM PBF\0*.pbf\0"
+                      "Contenedor R-Tree\0*.rtgeo\0All Files\0*.*\0";
     ofn.nFilterIndex = 1;
     ofn.Flags = OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST;
 
     if (GetOpenFileName(&ofn)) {
+        std::string filename = szFile;
+
+        // Con un mapa ya cargado, el archivo puede ir a su propia capa
+        std::string layerName = STREET_LAYER;
+        if (!layers.empty()) {
+            std::string name = LayerNameFromFile(filename);
+            std::string question = "Cargar como capa '" + name + "'?\n\n"
+                                   "Si: agrega o reemplaza esa capa sin tocar las calles\n"
+                                   "No: reemplaza el mapa base de calles";
+            int answer = MessageBox(hwnd, question.c_str(), "Capas",
+                                    MB_YESNOCANCEL | MB_ICONQUESTION);
+            if (answer == IDCANCEL) return;
+            if (answer == IDYES) layerName = name;
+        }
+
         auto start = std::chrono::high_resolution_clock::now();
 
-        if (parser.loadFromFile(szFile)) {
-            rtree.clear();
+        std::vector<Geometry> loadedGeoms;
+        if (LoadDataFile(filename, loadedGeoms)) {
+            bool isBaseLayer = layerName == STREET_LAYER;
+            bool firstLoad = layers.empty();
+
+            // Los resultados pueden apuntar a la capa que se reemplaza
             searchResults.clear();
-            roadGraph.clear();
-            ClearRoute();
+            if (isBaseLayer) {
+                hierarchy.clear();
+                landmarks.clear();
+                traffic.clear();
+                roadGraph.clear();
+                ClearRoute();
+                stats.graphNodes = 0;
+                stats.graphEdges = 0;
+            }
+
+            // Las teselas ya generadas cambian donde estaba la capa anterior
+            // y donde queda la nueva
+            bool hasTiles = tiles.hasPyramid() || vectorTiles.hasPyramid();
+            std::vector<Rect> changed;
+            if (hasTiles) CollectLayerBounds(layerName, changed);
 
-            const std::vector<Geometry>& geoms = parser.getGeometries();
-            for (size_t i = 0; i < geoms.size(); i++) {
-                rtree.insert(const_cast<Geometry*>(&geoms[i]));
+            layers.replace(layerName, std::move(loadedGeoms));
+
+            if (hasTiles) {
+                CollectLayerBounds(layerName, changed);
+                tiles.update(changed);
+                vectorTiles.update(changed);
             }
 
             auto end = std::chrono::high_resolution_clock::now();
             stats.loadTime = std::chrono::duration<double>(end - start).count();
-            stats.totalGeometries = geoms.size();
-            stats.treeHeight = rtree.getHeight();
-            stats.nodeCount = rtree.getNodeCount();
 
-            if (renderer) {
-                renderer->setViewBounds(parser.getBounds());
+            // Si ya se construyó el grafo de estas calles, se abre sin reconstruir
+            bool graphReady = false;
+            if (isBaseLayer) {
+                graphReady = roadGraph.openSnapshot(GRAPH_CACHE,
+                                                    PrepareGraphSource(layers.getLayer(STREET_LAYER)));
+                if (graphReady) {
+                    stats.graphNodes = roadGraph.getNodeCount();
+                    stats.graphEdges = roadGraph.getEdgeCount();
+                }
+            }
+            stats.totalGeometries = layers.getGeometryCount();
+            stats.treeHeight = layers.getTreeHeight();
+            stats.nodeCount = layers.getNodeCount();
+
+            if (renderer && (isBaseLayer || firstLoad)) {
+                renderer->setViewBounds(layers.getBounds());
             }
 
             UpdateStatusBar();
             InvalidateRect(hwnd, NULL, TRUE);
 
             std::stringstream ss;
-            ss << "Cargadas " << stats.totalGeometries
-               << " geometrias en " << stats.loadTime << " segundos\n"
-               << "Use 'Construir Grafo' para habilitar rutas";
+            ss << "Capa '" << layerName << "': "
+               << layers.getLayer(layerName)->geometries.size()
+               << " geometrias en " << stats.loadTime << " segundos\n";
+            if (graphReady) {
+                ss << "Grafo de rutas abierto de " << GRAPH_CACHE << " ("
+                   << stats.graphNodes << " nodos): ya puede calcular rutas";
+            } else if (isBaseLayer) {
+                ss << "Use 'Construir Grafo' para habilitar rutas";
+            }
 
             MessageBox(hwnd, ss.str().c_str(), "Exito", MB_OK | MB_ICONINFORMATION);
         } else {
-            MessageBox(hwnd, "Error al cargar el archivo GeoJSON", "Error", MB_OK | MB_ICONERROR);
+            MessageBox(hwnd, "Error al cargar el archivo de datos", "Error", MB_OK | MB_ICONERROR);
         }
     }
 }
 
+bool LoadDataFile(const std::string& filename, std::vector<Geometry>& out) {
+    if (HasExtension(filename, ".pbf")) {
+        if (!pbfReader.loadFromFile(filename)) return false;
+        out = pbfReader.takeGeometries();
+    } else if (HasExtension(filename, ".rtgeo")) {
+        GeoContainerReader reader;
+        if (!reader.open(filename) || !reader.loadAll(out)) return false;
+    } else {
+        if (!parser.loadFromFile(filename)) return false;
+        out = parser.takeGeometries();
+    }
+    return !out.empty();
+}
+
+std::string LayerNameFromFile(const std::string& filename) {
+    size_t slash = filename.find_last_of("\\/");
+    std::string name = slash == std::string::npos ? filename : filename.substr(slash + 1);
+    size_t dot = name.find('.');
+    return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+void DropLastLayer(HWND hwnd) {
+    // El mapa base no se quita: se reemplaza cargando otro archivo
+    for (size_t i = layers.getLayerCount(); i-- > 0;) {
+        std::string name = layers.getLayerAt(i).name;
+        if (name == STREET_LAYER) continue;
+
+        searchResults.clear();
+        std::vector<Rect> changed;
+        if (tiles.hasPyramid() || vectorTiles.hasPyramid()) CollectLayerBounds(name, changed);
+        layers.drop(name);
+        tiles.update(changed);
+        vectorTiles.update(changed);
+
+        stats.totalGeometries = layers.getGeometryCount();
+        stats.treeHeight = layers.getTreeHeight();
+        stats.nodeCount = layers.getNodeCount();
+        UpdateStatusBar();
+        InvalidateRect(hwnd, NULL, TRUE);
+        return;
+    }
+
+    MessageBox(hwnd, "No hay capas adicionales cargadas", "Aviso", MB_OK | MB_ICONWARNING);
+}
+
+void CollectLayerBounds(const std::string& name, std::vector<Rect>& out) {
+    const Layer* layer = layers.getLayer(name);
+    if (!layer) return;
+    for (const auto& geom : layer->geometries) {
+        if (!geom.points.empty()) out.push_back(geom.mbr);
+    }
+}
+
+void GenerateTiles(HWND hwnd) {
+    if (layers.empty()) {
+        MessageBox(hwnd, "Primero cargue un archivo de datos", "Aviso", MB_OK | MB_ICONWARNING);
+        return;
+    }
+
+    int answer = MessageBox(hwnd, "Si: teselas vectoriales (.mvt) con atributos\n"
+                                  "No: imagenes (.png)", "Teselas",
+                            MB_YESNOCANCEL | MB_ICONQUESTION);
+    if (answer == IDCANCEL) return;
+    TileGenerator& generator = answer == IDYES ? vectorTiles : tiles;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    generator.setDirectory(TILE_DIRECTORY);
+    int count = generator.generate(TILE_MIN_ZOOM, TILE_MAX_ZOOM);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    if (count == 0) {
+        MessageBox(hwnd, "Las teselas XYZ requieren un mapa en coordenadas lon/lat",
+                   "Aviso", MB_OK | MB_ICONWARNING);
+        return;
+    }
+
+    const char* extension = generator.getFormat() == TILE_MVT ? "mvt" : "png";
+    std::stringstream ss;
+    ss << count << " teselas (zoom " << TILE_MIN_ZOOM << "-" << TILE_MAX_ZOOM << ") en "
+       << seconds << " segundos\n"
+       << "Carpeta: " << TILE_DIRECTORY << "\\{z}\\{x}\\{y}." << extension << "\n\n";
+    if (generator.getFormat() == TILE_MVT) {
+        ss << "MapLibre: fuente 'vector' con tiles '" << TILE_DIRECTORY << "/{z}/{x}/{y}.mvt'\n";
+    } else {
+        ss << "Leaflet: L.tileLayer('" << TILE_DIRECTORY << "/{z}/{x}/{y}.png')\n";
+    }
+    ss << "Al cargar o quitar capas se regeneran solo las teselas afectadas";
+    MessageBox(hwnd, ss.str().c_str(), "Teselas", MB_OK | MB_ICONINFORMATION);
+}
+
+void ExportContainer(HWND hwnd) {
+    if (layers.empty()) {
+        MessageBox(hwnd, "Primero cargue un archivo de datos", "Aviso", MB_OK | MB_ICONWARNING);
+        return;
+    }
+
+    OPENFILENAME ofn = {0};
+    char szFile[260] = "mapa.rtgeo";
+
+    ofn.lStructSize = sizeof(ofn);
+    ofn.hwndOwner = hwnd;
+    ofn.lpstrFile = szFile;
+    ofn.nMaxFile = sizeof(szFile);
+    ofn.lpstrFilter = "Contenedor R-Tree\0*.rtgeo\0";
+    ofn.lpstrDefExt = "rtgeo";
+    ofn.Flags = OFN_PATHMUSTEXIST | OFN_OVERWRITEPROMPT;
+
+    if (GetSaveFileName(&ofn)) {
+        if (GeoContainerWriter::write(szFile, layers.collectGeometries())) {
+            MessageBox(hwnd, "Contenedor exportado correctamente", "Exito", MB_OK | MB_ICONINFORMATION);
+        } else {
+            MessageBox(hwnd, "Error al escribir el contenedor", "Error", MB_OK | MB_ICONERROR);
+        }
+    }
+}
+
+void RunBenchmark(HWND hwnd) {
+    if (layers.empty()) {
+        MessageBox(hwnd, "Primero cargue un archivo de datos", "Aviso", MB_OK | MB_ICONWARNING);
+        return;
+    }
+
+    std::stringstream ss;
+    ss << "=== Benchmark ===" << "\n\n";
+
+    // Carga parcial: la cuarta parte central del mapa (aprox. un distrito)
+    Rect bounds = layers.getBounds();
+    Point c = bounds.center();
+    double w = (bounds.maxX - bounds.minX) / 4;
+    double h = (bounds.maxY - bounds.minY) / 4;
+    Rect window(c.x - w, c.y - h, c.x + w, c.y + h);
+
+    const char* containerFile = "benchmark.rtgeo";
+    if (GeoContainerWriter::write(containerFile, layers.collectGeometries())) {
+        ss << Benchmark::containerOpen(containerFile, window);
+        remove(containerFile);
+    }
+
+    ss << "\n" << Benchmark::projectionAccuracy(bounds);
+    ss << "\n" << Benchmark::movingObjects();
+
+    const Layer* streets = layers.getLayer(STREET_LAYER);
+    if (streets) {
+        ss << "\n" << Benchmark::graphBuild(streets->geometries);
+        if (!streets->geometries.empty()) {
+            Projection proj = Projection::forExtent(streets->index.getRoot()->mbr);
+            ss << "\n" << Benchmark::chainContraction(streets->geometries, proj);
+            ss << "\n" << Benchmark::nodeOrdering(streets->geometries, proj);
+            ss << "\n" << Benchmark::graphSnapshot(streets->geometries, proj);
+        }
+    }
+
+    if (roadGraph.getNodeCount() > 0) {
+        ss << "\n" << Benchmark::routing(roadGraph);
+        ss << "\n" << Benchmark::distanceMatrix(roadGraph);
+        ss << "\n" << Benchmark::nearestUnits(roadGraph);
+        ss << "\n" << Benchmark::mapMatching(roadGraph);
+        ss << "\n" << Benchmark::isochrones(roadGraph);
+        ss << "\n" << Benchmark::contractionHierarchy(roadGraph);
+        ss << "\n" << Benchmark::customizableHierarchy(roadGraph);
+        ss << "\n" << Benchmark::landmarks(roadGraph, LANDMARK_COUNT);
+    }
+
+    ss << "\n" << Benchmark::rendering(layers, roadGraph);
+    ss << "\n" << Benchmark::tiles(layers);
+    ss << "\n" << Benchmark::vectorTiles(layers);
+
+    MessageBox(hwnd, ss.str().c_str(), "Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+const char* DistanceUnit() {
+    return roadGraph.isMetric() ? "m" : "unidades";
+}
+
+bool HasExtension(const std::string& filename, const std::string& ext) {
+    return filename.size() > ext.size() &&
+           filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0;
+}
+
 void BuildGraph(HWND hwnd) {
-    if (parser.getGeometries().empty()) {
+    const Layer* streets = layers.getLayer(STREET_LAYER);
+    if (!streets || streets->geometries.empty()) {
         MessageBox(hwnd, "Primero cargue un archivo GeoJSON", "Aviso", MB_OK | MB_ICONWARNING);
         return;
     }
 
     auto start = std::chrono::high_resolution_clock::now();
 
-    roadGraph.buildFromGeometries(parser.getGeometries());
+    // La jerarquía y los landmarks apuntan al grafo anterior
+    hierarchy.clear();
+    landmarks.clear();
+    traffic.clear();
+
+    // La instantánea sólo se acepta si salió de estas mismas calles
+    uint64_t source = PrepareGraphSource(streets);
+    bool fromSnapshot = roadGraph.openSnapshot(GRAPH_CACHE, source);
+    if (!fromSnapshot) {
+        SetWindowText(hwndStatus, "Construyendo el grafo de rutas...");
+        roadGraph.buildFromGeometries(streets->geometries);
+        roadGraph.saveSnapshot(GRAPH_CACHE, source);
+    }
 
     auto end = std::chrono::high_resolution_clock::now();
     double buildTime = std::chrono::duration<double>(end - start).count();
@@ -472,15 +839,160 @@ void BuildGraph(HWND hwnd) {
     InvalidateRect(hwnd, NULL, TRUE);
 
     std::stringstream ss;
-    ss << "Grafo construido exitosamente:\n"
+    ss << (fromSnapshot ? "Grafo abierto de " : "Grafo construido y guardado en ")
+       << GRAPH_CACHE << ":\n"
        << "Nodos: " << stats.graphNodes << "\n"
        << "Aristas: " << stats.graphEdges << "\n"
-       << "Tiempo: " << buildTime << " segundos\n\n"
+       << "Tiempo: " << buildTime << " segundos\n"
+       << "Proyeccion: " << roadGraph.getProjection().getName() << "\n\n"
        << "Ahora puede calcular rutas";
 
     MessageBox(hwnd, ss.str().c_str(), "Grafo Construido", MB_OK | MB_ICONINFORMATION);
 }
 
+// Pesos en metros: proyección local centrada en el mapa. Devuelve la suma
+// de control que identifica el grafo de estas calles
+uint64_t PrepareGraphSource(const Layer* streets) {
+    roadGraph.setProjection(Projection::forExtent(streets->index.getRoot()->mbr));
+    return roadGraph.sourceChecksum(streets->geometries);
+}
+
+void PrepareHierarchy(HWND hwnd) {
+    if (roadGraph.getNodeCount() == 0) {
+        MessageBox(hwnd, "Primero construya el grafo de rutas", "Aviso", MB_OK | MB_ICONWARNING);
+        return;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // El archivo guardado sólo se acepta si corresponde a este mismo grafo
+    bool fromCache = hierarchy.load(HIERARCHY_CACHE, roadGraph);
+    if (!fromCache) {
+        SetWindowText(hwndStatus, "Preprocesando el grafo (Contraction Hierarchies)...");
+        hierarchy.build(roadGraph);
+        hierarchy.save(HIERARCHY_CACHE);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    double elapsed = std::chrono::duration<double>(end - start).count();
+
+    UpdateStatusBar();
+
+    std::stringstream ss;
+    ss << (fromCache ? "Jerarquia cargada de " : "Jerarquia construida y guardada en ")
+       << HIERARCHY_CACHE << "\n"
+       << "Atajos: " << hierarchy.getShortcutCount() << "\n"
+       << "Tiempo: " << elapsed << " segundos\n\n"
+       << "Las rutas usaran CH";
+
+    MessageBox(hwnd, ss.str().c_str(), "Contraction Hierarchies", MB_OK | MB_ICONINFORMATION);
+}
+
+void PrepareLandmarks(HWND hwnd) {
+    if (roadGraph.getNodeCount() == 0) {
+        MessageBox(hwnd, "Primero construya el grafo de rutas", "Aviso", MB_OK | MB_ICONWARNING);
+        return;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    bool fromCache = landmarks.load(LANDMARK_CACHE, roadGraph);
+    if (!fromCache) {
+        SetWindowText(hwndStatus, "Calculando landmarks (ALT)...");
+        landmarks.build(roadGraph, LANDMARK_COUNT, LANDMARK_AVOID);
+        landmarks.save(LANDMARK_CACHE);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    double elapsed = std::chrono::duration<double>(end - start).count();
+
+    UpdateStatusBar();
+
+    std::stringstream ss;
+    ss << (fromCache ? "Landmarks cargados de " : "Landmarks calculados y guardados en ")
+       << LANDMARK_CACHE << "\n"
+       << "Landmarks: " << landmarks.getCount() << "\n"
+       << "Tabla: " << landmarks.getTableBytes() / 1024 << " KB\n"
+       << "Tiempo: " << elapsed << " segundos\n\n"
+       << "A* usara la cota de landmarks";
+
+    MessageBox(hwnd, ss.str().c_str(), "ALT", MB_OK | MB_ICONINFORMATION);
+}
+
+void UpdateTraffic(HWND hwnd) {
+    if (roadGraph.getNodeCount() == 0) {
+        MessageBox(hwnd, "Primero construya el grafo de rutas", "Aviso", MB_OK | MB_ICONWARNING);
+        return;
+    }
+    if (!roadGraph.isMetric()) {
+        MessageBox(hwnd, "El trafico requiere coordenadas geograficas (distancias en metros)",
+                   "Aviso", MB_OK | MB_ICONWARNING);
+        return;
+    }
+
+    // La preparación no depende de los pesos: se hace una vez por grafo
+    double prepareTime = 0;
+    if (!traffic.isPrepared()) {
+        SetWindowText(hwndStatus, "Preparando la jerarquia personalizable (CCH)...");
+        auto start = std::chrono::high_resolution_clock::now();
+        traffic.prepare(roadGraph);
+        auto end = std::chrono::high_resolution_clock::now();
+        prepareTime = std::chrono::duration<double>(end - start).count();
+    }
+
+    // Velocidades simuladas por tramo (entre 25% y 100% de la urbana); cada
+    // actualización reemplaza la métrica sin rehacer la preparación
+    static std::mt19937 rng(20240611);
+    std::uniform_real_distribution<double> congestion(0.25, 1.0);
+    std::vector<double> seconds = roadGraph.getEdgeWeights();
+    for (double& w : seconds) w /= URBAN_SPEED_KMH / 3.6 * congestion(rng);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    traffic.customize(seconds);
+    auto end = std::chrono::high_resolution_clock::now();
+    double customizeTime = std::chrono::duration<double>(end - start).count() * 1000;
+
+    std::stringstream ss;
+    ss << "Velocidades actualizadas (metrica " << traffic.getMetric()->version << ")\n"
+       << "Arcos: " << traffic.getUpArcCount() << "\n";
+    if (prepareTime > 0) ss << "Preparacion: " << prepareTime << " segundos\n";
+    ss << "Personalizacion: " << customizeTime << " ms\n\n"
+       << "Las rutas usaran los tiempos con trafico";
+
+    MessageBox(hwnd, ss.str().c_str(), "Trafico", MB_OK | MB_ICONINFORMATION);
+}
+
+void StartIsochroneSelection(HWND hwnd) {
+    if (roadGraph.getNodeCount() == 0) {
+        MessageBox(hwnd, "Primero construya el grafo de rutas", "Aviso", MB_OK | MB_ICONWARNING);
+        return;
+    }
+    if (!roadGraph.isMetric()) {
+        MessageBox(hwnd, "Las isocronas requieren coordenadas geograficas (distancias en metros)",
+                   "Aviso", MB_OK | MB_ICONWARNING);
+        return;
+    }
+
+    ClearRoute();
+    routeMode = ROUTE_SELECT_ISOCHRONE;
+    SetWindowText(hwndStatus, "Clic (y arrastre) para ubicar el origen de las isocronas");
+}
+
+void CalculateIsochrones() {
+    // Minutos -> metros recorridos a la velocidad urbana
+    std::vector<double> budgets;
+    for (double minutes : ISOCHRONE_MINUTES) {
+        budgets.push_back(minutes * URBAN_SPEED_KMH * 1000 / 60);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    isochrones = roadGraph.isochrone(isochroneOrigin, budgets);
+    auto end = std::chrono::high_resolution_clock::now();
+    stats.isochroneTime = std::chrono::duration<double>(end - start).count() * 1000;
+
+    UpdateStatusBar();
+}
+
 void StartRouteSelection(HWND hwnd) {
     if (roadGraph.getNodeCount() == 0) {
         MessageBox(hwnd, "Primero construya el grafo de rutas", "Aviso", MB_OK | MB_ICONWARNING);
@@ -495,8 +1007,18 @@ void StartRouteSelection(HWND hwnd) {
 void CalculateRoute(HWND hwnd) {
     auto start = std::chrono::high_resolution_clock::now();
 
-    // Usar A* para encontrar la ruta
-    currentRoute = roadGraph.findAStarPath(routeStart, routeEnd);
+    // Con tráfico, el menor tiempo (CCH); si no, CH si el grafo está
+    // preprocesado, o A* (con landmarks si los hay)
+    bool withTraffic = traffic.isReady();
+    if (withTraffic) {
+        currentRoute = traffic.findPath(routeStart, routeEnd);
+    } else if (hierarchy.isReady()) {
+        currentRoute = hierarchy.findPath(routeStart, routeEnd);
+    } else if (landmarks.isReady()) {
+        currentRoute = roadGraph.findALTPath(routeStart, routeEnd, landmarks);
+    } else {
+        currentRoute = roadGraph.findAStarPath(routeStart, routeEnd);
+    }
 
     auto end = std::chrono::high_resolution_clock::now();
     stats.routeTime = std::chrono::duration<double>(end - start).count() * 1000;
@@ -505,9 +1027,20 @@ void CalculateRoute(HWND hwnd) {
         stats.routeDistance = currentRoute.totalDistance;
 
         std::stringstream ss;
-        ss << "Ruta encontrada:\n"
-           << "Distancia: " << stats.routeDistance << " unidades\n"
+        ss << "Ruta encontrada:\n";
+        if (withTraffic) {
+            // La métrica está en segundos: el largo sale del trazado
+            const Projection& proj = roadGraph.getProjection();
+            stats.routeDistance = 0;
+            for (size_t i = 1; i < currentRoute.path.size(); i++) {
+                stats.routeDistance += proj.forward(currentRoute.path[i - 1])
+                                           .distanceTo(proj.forward(currentRoute.path[i]));
+            }
+            ss << "Tiempo con trafico: " << currentRoute.totalDistance / 60 << " min\n";
+        }
+        ss << "Distancia: " << stats.routeDistance << " " << DistanceUnit() << "\n"
            << "Nodos visitados: " << currentRoute.path.size() << "\n"
+           << "Nodos asentados: " << currentRoute.settledNodes << "\n"
            << "Tiempo de calculo: " << stats.routeTime << " ms";
 
         MessageBox(hwnd, ss.str().c_str(), "Ruta Calculada", MB_OK | MB_ICONINFORMATION);
@@ -526,13 +1059,16 @@ void ClearRoute() {
     currentRoute = Route();
     stats.routeDistance = 0;
     stats.routeTime = 0;
+    isochrones.clear();
+    isDraggingIsochrone = false;
+    stats.isochroneTime = 0;
 }
 
 void PerformRangeSearch(HWND hwnd, const Rect& range) {
     auto start = std::chrono::high_resolution_clock::now();
 
     searchResults.clear();
-    searchResults = rtree.rangeSearch(range);
+    searchResults = layers.rangeSearch(range);
 
     auto end = std::chrono::high_resolution_clock::now();
     stats.lastSearchTime = std::chrono::duration<double>(end - start).count() * 1000;
@@ -544,7 +1080,7 @@ void PerformRangeSearch(HWND hwnd, const Rect& range) {
 void PerformKNNSearch(HWND hwnd, const Point& p, int k) {
     auto start = std::chrono::high_resolution_clock::now();
 
-    searchResults = rtree.kNNSearch(p, k);
+    searchResults = layers.kNNSearch(p, k);
 
     auto end = std::chrono::high_resolution_clock::now();
     stats.lastSearchTime = std::chrono::duration<double>(end - start).count() * 1000;
@@ -571,10 +1107,14 @@ void UpdateStatusBar() {
     }
 
     if (currentRoute.found) {
-        ss << " | Ruta: " << stats.routeDistance << " unidades ("
+        ss << " | Ruta: " << stats.routeDistance << " " << DistanceUnit() << " ("
            << stats.routeTime << " ms)";
     }
 
+    if (!isochrones.empty()) {
+        ss << " | Isocronas: " << isochrones.size() << " (" << stats.isochroneTime << " ms)";
+    }
+
     SetWindowText(hwndStatus, ss.str().c_str());
 }
 
@@ -586,6 +1126,15 @@ void ShowStatistics(HWND hwnd) {
        << "Altura del arbol: " << stats.treeHeight << "\n"
        << "Numero de nodos: " << stats.nodeCount << "\n"
        << "Tiempo de carga: " << stats.loadTime << " segundos\n\n"
+       << "--- Capas ---" << "\n";
+
+    for (size_t i = 0; i < layers.getLayerCount(); i++) {
+        const Layer& layer = layers.getLayerAt(i);
+        ss << layer.name << ": " << layer.geometries.size() << " geometrias, altura "
+           << layer.index.getHeight() << "\n";
+    }
+
+    ss << "\n"
        << "--- Grafo de Rutas ---" << "\n"
        << "Nodos del grafo: " << stats.graphNodes << "\n"
        << "Aristas: " << stats.graphEdges << "\n\n"
@@ -595,7 +1144,7 @@ void ShowStatistics(HWND hwnd) {
        << "--- Ruta Actual ---" << "\n";
 
     if (currentRoute.found) {
-        ss << "Distancia: " << stats.routeDistance << " unidades\n"
+        ss << "Distancia: " << stats.routeDistance << " " << DistanceUnit() << "\n"
            << "Nodos en ruta: " << currentRoute.path.size() << "\n"
            << "Tiempo de calculo: " << stats.routeTime << " ms\n";
     } else {
@@ -0,0 +1,1326 @@
+#include "../include/Benchmark.h"
+#include "../include/GeoContainer.h"
+#include "../include/Projection.h"
+#include "../include/Graph.h"
+#include "../include/ContractionHierarchy.h"
+#include "../include/Landmarks.h"
+#include "../include/CustomizableHierarchy.h"
+#include "../include/UnitIndex.h"
+#include "../include/MapMatcher.h"
+#include "../include/MovingObjectIndex.h"
+#include "../include/PackedRTree.h"
+#include "../include/LayerManager.h"
+#include "../include/Renderer.h"
+#include "../include/RasterBackend.h"
+#include "../include/TileGenerator.h"
+#include "../include/VectorTile.h"
+#include "../include/Parallel.h"
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <sstream>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+typedef std::chrono::high_resolution_clock Clock;
+
+const double PI = 3.14159265358979323846;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count() * 1000;
+}
+
+// Pares origen-destino tomados de los vértices del grafo. Semilla fija: cada
+// corrida (y cada benchmark) mide las mismas consultas
+std::vector<std::pair<Point, Point>> randomNodePairs(const Graph& graph, int count) {
+    std::mt19937 rng(4242);
+    std::uniform_int_distribution<int> pick(0, graph.getNodeCount() - 1);
+    std::vector<std::pair<Point, Point>> pairs(count);
+    for (auto& od : pairs) {
+        od.first = graph.getNodePosition(pick(rng));
+        od.second = graph.getNodePosition(pick(rng));
+    }
+    return pairs;
+}
+
+} // namespace
+
+std::string Benchmark::containerOpen(const std::string& containerFile, const Rect& window,
+                                     int repetitions) {
+    std::stringstream ss;
+    ss << "--- Contenedor binario ---\n";
+
+    double fullMs = 0, partialMs = 0;
+    size_t fullCount = 0, partialCount = 0;
+    uint64_t fullBytes = 0, partialBytes = 0;
+
+    for (int r = 0; r < repetitions; r++) {
+        GeoContainerReader reader;
+        std::vector<Geometry> geoms;
+
+        auto start = Clock::now();
+        if (!reader.open(containerFile) || !reader.loadAll(geoms)) {
+            ss << "Error al abrir " << containerFile << "\n";
+            return ss.str();
+        }
+        fullMs += elapsedMs(start);
+        fullCount = geoms.size();
+        fullBytes = reader.getLastBytesRead();
+
+        GeoContainerReader partialReader;
+        std::vector<Geometry> partial;
+
+        start = Clock::now();
+        if (!partialReader.open(containerFile) || !partialReader.loadInRect(window, partial)) {
+            ss << "Error en la carga parcial\n";
+            return ss.str();
+        }
+        partialMs += elapsedMs(start);
+        partialCount = partial.size();
+        partialBytes = partialReader.getLastBytesRead();
+    }
+
+    fullMs /= repetitions;
+    partialMs /= repetitions;
+
+    ss << "Apertura completa: " << fullMs << " ms (" << fullCount << " geometrias, "
+       << fullBytes / 1024 << " KB)\n"
+       << "Apertura parcial: " << partialMs << " ms (" << partialCount << " geometrias, "
+       << partialBytes / 1024 << " KB)\n";
+    if (partialMs > 0) {
+        ss << "Aceleracion: " << fullMs / partialMs << "x\n";
+    }
+    return ss.str();
+}
+
+std::string Benchmark::projectionAccuracy(const Rect& extent, int pairs) {
+    std::stringstream ss;
+    ss << "--- Proyeccion metrica ---\n";
+    if (!Projection::isGeographic(extent) || pairs <= 0) {
+        ss << "La extension no esta en lon/lat\n";
+        return ss.str();
+    }
+
+    // Pares cortos (del orden de una arista) y pares de extremo a extremo
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> ux(extent.minX, extent.maxX);
+    std::uniform_real_distribution<double> uy(extent.minY, extent.maxY);
+    std::uniform_real_distribution<double> near(-0.001, 0.001);
+
+    std::vector<Point> a(pairs), b(pairs);
+    for (int i = 0; i < pairs; i++) {
+        a[i] = Point(ux(rng), uy(rng));
+        b[i] = i % 2 == 0 ? Point(a[i].x + near(rng), a[i].y + near(rng))
+                          : Point(ux(rng), uy(rng));
+    }
+
+    // Referencia
+    std::vector<double> reference(pairs);
+    auto start = Clock::now();
+    for (int i = 0; i < pairs; i++) {
+        reference[i] = Projection::haversine(a[i], b[i]);
+    }
+    double haversineMs = elapsedMs(start);
+    ss << "Haversine: " << haversineMs * 1e6 / pairs << " ns/distancia\n";
+
+    const ProjectionType types[] = {PROJ_EQUIRECTANGULAR, PROJ_UTM};
+    for (ProjectionType type : types) {
+        Projection proj = Projection::forExtent(extent, type);
+
+        // La proyección se paga una vez por punto al cargar
+        std::vector<Point> pa(pairs), pb(pairs);
+        start = Clock::now();
+        for (int i = 0; i < pairs; i++) {
+            pa[i] = proj.forward(a[i]);
+            pb[i] = proj.forward(b[i]);
+        }
+        double projectMs = elapsedMs(start);
+
+        std::vector<double> dist(pairs);
+        start = Clock::now();
+        for (int i = 0; i < pairs; i++) {
+            dist[i] = pa[i].distanceTo(pb[i]);
+        }
+        double euclidMs = elapsedMs(start);
+
+        double sumErr = 0, maxErr = 0;
+        int counted = 0;
+        for (int i = 0; i < pairs; i++) {
+            if (reference[i] < 1.0) continue;
+            double err = std::fabs(dist[i] - reference[i]) / reference[i];
+            sumErr += err;
+            maxErr = std::max(maxErr, err);
+            counted++;
+        }
+
+        ss << proj.getName() << ": " << euclidMs * 1e6 / pairs << " ns/distancia, "
+           << "proyectar " << projectMs * 1e6 / (2.0 * pairs) << " ns/punto\n"
+           << "  error relativo medio " << (counted ? 100 * sumErr / counted : 0)
+           << " %, maximo " << 100 * maxErr << " %\n";
+    }
+    return ss.str();
+}
+
+std::string Benchmark::movingObjects(int rounds, int queries) {
+    std::stringstream ss;
+    ss << "--- Objetos en movimiento (" << rounds << " rondas, " << queries << " consultas) ---\n";
+    if (rounds <= 0 || queries <= 0) return ss.str();
+
+    // Ciudad sintética de 10 km x 10 km; vehículos de 5 a 20 m/s que
+    // reportan cada 5 s y doblan un poco en cada reporte
+    const Rect extent(0, 0, 10000, 10000);
+    const double REPORT = 5, HORIZON = 180, WINDOW = 250, MAX_SPEED = 20;
+    const int K = 10;
+    const int sizes[] = {10000, 100000, 1000000};
+
+    for (int n : sizes) {
+        std::mt19937 rng(4242);
+        std::uniform_real_distribution<double> coord(0, 10000);
+        std::uniform_real_distribution<double> speed(5, MAX_SPEED);
+        std::uniform_real_distribution<double> angle(0, 2 * PI);
+        std::normal_distribution<double> turn(0, 0.3);
+
+        std::vector<Point> position(n);
+        std::vector<double> heading(n), velocity(n);
+        for (int i = 0; i < n; i++) {
+            position[i] = Point(coord(rng), coord(rng));
+            heading[i] = angle(rng);
+            velocity[i] = speed(rng);
+        }
+
+        double cellSize = MovingObjectIndex::cellSizeFor(extent, n);
+        MovingObjectIndex grid(extent, cellSize);
+        MovingObjectIndex predictive(extent, cellSize, HORIZON, MAX_SPEED);
+        std::vector<int> gridId(n), predictiveId(n);
+        for (int i = 0; i < n; i++) {
+            Point v(velocity[i] * std::cos(heading[i]), velocity[i] * std::sin(heading[i]));
+            gridId[i] = grid.insert(position[i]);
+            predictiveId[i] = predictive.insert(position[i], 0, v);
+        }
+
+        double gridUpdateMs = 0, predictiveUpdateMs = 0, rebuildMs = 0;
+        double gridRangeMs = 0, packedRangeMs = 0, gridKnnMs = 0, futureRangeMs = 0, futureKnnMs = 0;
+        size_t found = 0, futureFound = 0;
+        int mismatches = 0;
+        std::vector<Point> speeds(n);
+        std::vector<int> results;
+        std::vector<size_t> packedResults;
+
+        for (int round = 1; round <= rounds; round++) {
+            double now = round * REPORT;
+            for (int i = 0; i < n; i++) {
+                heading[i] += turn(rng);
+                speeds[i] = Point(velocity[i] * std::cos(heading[i]), velocity[i] * std::sin(heading[i]));
+                position[i].x = std::min(10000.0, std::max(0.0, position[i].x + speeds[i].x * REPORT));
+                position[i].y = std::min(10000.0, std::max(0.0, position[i].y + speeds[i].y * REPORT));
+            }
+
+            auto start = Clock::now();
+            for (int i = 0; i < n; i++) grid.update(gridId[i], position[i], now);
+            gridUpdateMs += elapsedMs(start);
+
+            start = Clock::now();
+            for (int i = 0; i < n; i++) predictive.update(predictiveId[i], position[i], speeds[i], now);
+            predictiveUpdateMs += elapsedMs(start);
+
+            // Alternativa estática: rearmar el R-Tree empaquetado en cada ronda
+            start = Clock::now();
+            std::vector<std::pair<uint32_t, int>> order(n);
+            for (int i = 0; i < n; i++) order[i] = std::make_pair(PackedRTree::hilbertIndex(position[i], extent), i);
+            std::sort(order.begin(), order.end());
+            std::vector<PackedRTreeItem> leaves(n);
+            for (int i = 0; i < n; i++) {
+                leaves[i].box = Rect(position[order[i].second]);
+                leaves[i].offset = (uint64_t)order[i].second;
+            }
+            PackedRTree packed;
+            packed.build(leaves);
+            rebuildMs += elapsedMs(start);
+
+            std::vector<Point> centers(queries);
+            for (auto& c : centers) c = Point(coord(rng), coord(rng));
+
+            start = Clock::now();
+            for (const auto& c : centers) {
+                grid.rangeSearch(Rect(c.x - WINDOW, c.y - WINDOW, c.x + WINDOW, c.y + WINDOW), results);
+                found += results.size();
+            }
+            gridRangeMs += elapsedMs(start);
+
+            start = Clock::now();
+            size_t packedFound = 0;
+            for (const auto& c : centers) {
+                packedResults.clear();
+                packed.search(Rect(c.x - WINDOW, c.y - WINDOW, c.x + WINDOW, c.y + WINDOW), packedResults);
+                packedFound += packedResults.size();
+            }
+            packedRangeMs += elapsedMs(start);
+
+            // Mismos ids en ambos índices: los conteos deben coincidir
+            size_t gridFound = 0;
+            for (const auto& c : centers) {
+                grid.rangeSearch(Rect(c.x - WINDOW, c.y - WINDOW, c.x + WINDOW, c.y + WINDOW), results);
+                gridFound += results.size();
+            }
+            if (gridFound != packedFound) mismatches++;
+
+            start = Clock::now();
+            for (const auto& c : centers) grid.kNNSearch(c, K);
+            gridKnnMs += elapsedMs(start);
+
+            start = Clock::now();
+            for (const auto& c : centers) {
+                predictive.rangeSearchAt(Rect(c.x - WINDOW, c.y - WINDOW, c.x + WINDOW, c.y + WINDOW),
+                                         now + HORIZON, results);
+                futureFound += results.size();
+            }
+            futureRangeMs += elapsedMs(start);
+
+            start = Clock::now();
+            for (const auto& c : centers) predictive.kNNSearchAt(c, K, now + HORIZON);
+            futureKnnMs += elapsedMs(start);
+        }
+
+        double updates = (double)n * rounds;
+        double totalQueries = (double)queries * rounds;
+        ss << n << " objetos (celda " << cellSize << " m):\n"
+           << "  Actualizaciones: " << updates / (gridUpdateMs / 1000) << "/s rejilla, "
+           << updates / (predictiveUpdateMs / 1000) << "/s predictiva; rearmar R-Tree "
+           << rebuildMs / rounds << " ms por ronda\n"
+           << "  Rango " << 2 * WINDOW << " m: " << gridRangeMs * 1000 / totalQueries << " us rejilla, "
+           << packedRangeMs * 1000 / totalQueries << " us R-Tree (" << found / totalQueries
+           << " objetos)\n"
+           << "  k-NN (k=" << K << "): " << gridKnnMs * 1000 / totalQueries << " us\n"
+           << "  A " << HORIZON / 60 << " min: rango " << futureRangeMs * 1000 / totalQueries
+           << " us (" << futureFound / totalQueries << " objetos), k-NN "
+           << futureKnnMs * 1000 / totalQueries << " us\n";
+        if (mismatches > 0) ss << "  Rondas con resultados distintos al R-Tree: " << mismatches << "\n";
+    }
+    return ss.str();
+}
+
+std::string Benchmark::graphBuild(const std::deque<Geometry>& geometries,
+                                  double snapThreshold) {
+    std::stringstream ss;
+    ss << "--- Construccion del grafo ---\n";
+
+    const int threadOptions[] = {1, 0};
+    for (int threads : threadOptions) {
+        Graph graph(snapThreshold);
+        graph.setThreadCount(threads);
+
+        auto start = Clock::now();
+        graph.buildFromGeometries(geometries);
+        double ms = elapsedMs(start);
+
+        ss << (threads == 1 ? "Secuencial" : "Paralelo") << " ("
+           << graph.getBuildPartitions() << " franjas): " << ms << " ms, "
+           << graph.getNodeCount() << " nodos, " << graph.getEdgeCount() << " aristas\n";
+    }
+    return ss.str();
+}
+
+std::string Benchmark::chainContraction(const std::deque<Geometry>& geometries,
+                                        const Projection& projection,
+                                        double snapThreshold, int queries) {
+    std::stringstream ss;
+    ss << "--- Contraccion de cadenas de grado 2 ---\n";
+
+    // 0 = grafo con todos los vértices, 1 = sólo cruces y puntas
+    Graph complete(snapThreshold), simplified(snapThreshold);
+    Graph* graphs[2] = {&complete, &simplified};
+    double buildMs[2];
+    for (int k = 0; k < 2; k++) {
+        graphs[k]->setProjection(projection);
+        graphs[k]->setSimplifyChains(k == 1);
+        auto start = Clock::now();
+        graphs[k]->buildFromGeometries(geometries);
+        buildMs[k] = elapsedMs(start);
+    }
+    if (complete.getNodeCount() < 2 || queries <= 0) {
+        ss << "Grafo vacio\n";
+        return ss.str();
+    }
+
+    // Pares tomados de los vértices del grafo completo: caen en medio de
+    // las cadenas del simplificado
+    std::vector<std::pair<Point, Point>> pairs = randomNodePairs(complete, queries);
+
+    const char* labels[2] = {"Completo", "Simplificado"};
+    double totalMs[2] = {0, 0};
+    long long settled[2] = {0, 0};
+    int mismatches = 0;
+    for (const auto& od : pairs) {
+        Route routes[2];
+        for (int k = 0; k < 2; k++) {
+            auto start = Clock::now();
+            routes[k] = graphs[k]->findAStarPath(od.first, od.second);
+            totalMs[k] += elapsedMs(start);
+            settled[k] += routes[k].settledNodes;
+        }
+        if (routes[1].found != routes[0].found ||
+            std::fabs(routes[1].totalDistance - routes[0].totalDistance) >
+                1e-6 * (1 + routes[0].totalDistance)) {
+            mismatches++;
+        }
+    }
+
+    for (int k = 0; k < 2; k++) {
+        ss << labels[k] << ": " << graphs[k]->getNodeCount() << " nodos, "
+           << graphs[k]->getEdgeCount() << " aristas, "
+           << graphs[k]->getShapePointCount() << " vertices de forma, construccion "
+           << buildMs[k] << " ms\n"
+           << "  A*: " << totalMs[k] / queries << " ms/consulta, "
+           << settled[k] / queries << " nodos asentados\n";
+    }
+    if (totalMs[1] > 0) ss << "Aceleracion A*: " << totalMs[0] / totalMs[1] << "x\n";
+    if (mismatches > 0) ss << "(" << mismatches << " distancias distintas!)\n";
+    return ss.str();
+}
+
+std::string Benchmark::nodeOrdering(const std::deque<Geometry>& geometries,
+                                    const Projection& projection,
+                                    double snapThreshold, int queries) {
+    std::stringstream ss;
+    ss << "--- Orden de los nodos en memoria ---\n";
+
+    // 0 = orden de carga, 1 = curva de Hilbert
+    Graph input(snapThreshold), hilbert(snapThreshold);
+    Graph* graphs[2] = {&input, &hilbert};
+    for (int k = 0; k < 2; k++) {
+        graphs[k]->setProjection(projection);
+        graphs[k]->setSpatialOrder(k == 1);
+        graphs[k]->buildFromGeometries(geometries);
+    }
+    if (input.getNodeCount() < 2 || queries <= 0) {
+        ss << "Grafo vacio\n";
+        return ss.str();
+    }
+
+    std::vector<std::pair<Point, Point>> pairs = randomNodePairs(input, queries);
+
+    const char* labels[2] = {"Orden de carga", "Hilbert"};
+    for (int k = 0; k < 2; k++) {
+        const Graph& g = *graphs[k];
+
+        // Localidad: cuántas aristas unen ids que caen en la misma línea de
+        // caché (8 coordenadas double) o en la misma página de 4 KB
+        long long sameLine = 0, samePage = 0, arcs = 0;
+        double gap = 0;
+        for (int u = 0; u < g.getNodeCount(); u++) {
+            for (int e = g.getEdgeBegin(u); e < g.getEdgeEnd(u); e++) {
+                int v = g.getEdgeTarget(e);
+                if (u / 8 == v / 8) sameLine++;
+                if (u / 512 == v / 512) samePage++;
+                gap += std::abs(u - v);
+                arcs++;
+            }
+        }
+
+        double dijkstraMs = 0, astarMs = 0;
+        for (const auto& od : pairs) {
+            auto start = Clock::now();
+            graphs[k]->findShortestPath(od.first, od.second);
+            dijkstraMs += elapsedMs(start);
+            start = Clock::now();
+            graphs[k]->findAStarPath(od.first, od.second);
+            astarMs += elapsedMs(start);
+        }
+
+        ss << labels[k] << ": vecinos en la misma linea de cache "
+           << (arcs ? 100.0 * sameLine / arcs : 0) << " %, misma pagina "
+           << (arcs ? 100.0 * samePage / arcs : 0) << " %, salto medio de id "
+           << (arcs ? gap / arcs : 0) << "\n"
+           << "  Dijkstra: " << dijkstraMs / queries << " ms/consulta, A*: "
+           << astarMs / queries << " ms/consulta\n";
+    }
+    return ss.str();
+}
+
+std::string Benchmark::graphSnapshot(const std::deque<Geometry>& geometries,
+                                     const Projection& projection,
+                                     double snapThreshold, int queries) {
+    std::stringstream ss;
+    ss << "--- Instantanea del grafo ---\n";
+
+    Graph built(snapThreshold);
+    built.setProjection(projection);
+    auto start = Clock::now();
+    built.buildFromGeometries(geometries);
+    double buildMs = elapsedMs(start);
+    if (built.getNodeCount() < 2 || queries <= 0) {
+        ss << "Grafo vacio\n";
+        return ss.str();
+    }
+
+    start = Clock::now();
+    uint64_t checksum = built.sourceChecksum(geometries);
+    double checksumMs = elapsedMs(start);
+
+    const char* snapshotFile = "benchmark.rtgraph";
+    start = Clock::now();
+    bool saved = built.saveSnapshot(snapshotFile, checksum);
+    double saveMs = elapsedMs(start);
+
+    uint64_t fileBytes = 0;
+    if (FILE* f = fopen(snapshotFile, "rb")) {
+        fseek(f, 0, SEEK_END);
+        fileBytes = (uint64_t)ftell(f);
+        fclose(f);
+    }
+
+    Graph mapped(snapThreshold);
+    mapped.setProjection(projection);
+    start = Clock::now();
+    bool opened = saved && mapped.openSnapshot(snapshotFile, checksum);
+    double openMs = elapsedMs(start);
+
+    // Un archivo de otros datos (o de otra configuración) no se acepta
+    Graph stale(snapThreshold);
+    bool rejected = saved && !stale.openSnapshot(snapshotFile, checksum + 1);
+
+    if (!opened) {
+        remove(snapshotFile);
+        ss << "Error al guardar o abrir " << snapshotFile << "\n";
+        return ss.str();
+    }
+
+    std::vector<std::pair<Point, Point>> pairs = randomNodePairs(built, queries);
+
+    // La primera consulta sobre el mapeo incluye traer las páginas que toca
+    start = Clock::now();
+    mapped.findAStarPath(pairs[0].first, pairs[0].second);
+    double firstMs = elapsedMs(start);
+
+    double totalMs[2] = {0, 0};
+    int mismatches = 0;
+    for (const auto& od : pairs) {
+        start = Clock::now();
+        Route a = built.findAStarPath(od.first, od.second);
+        totalMs[0] += elapsedMs(start);
+        start = Clock::now();
+        Route b = mapped.findAStarPath(od.first, od.second);
+        totalMs[1] += elapsedMs(start);
+        if (a.found != b.found || a.totalDistance != b.totalDistance ||
+            a.path.size() != b.path.size()) {
+            mismatches++;
+        }
+    }
+    remove(snapshotFile);
+
+    ss << "Construccion desde geometrias: " << buildMs << " ms\n"
+       << "Suma de control de los datos: " << checksumMs << " ms\n"
+       << "Guardado: " << saveMs << " ms, " << fileBytes / 1024 << " KB\n"
+       << "Apertura mapeada: " << openMs << " ms ("
+       << (openMs > 0 ? buildMs / openMs : 0) << "x mas rapida)\n"
+       << "Primera consulta A* tras abrir: " << firstMs << " ms\n"
+       << "A* construido: " << totalMs[0] / queries << " ms/consulta, mapeado: "
+       << totalMs[1] / queries << " ms/consulta\n"
+       << "Archivo ajeno rechazado: " << (rejected ? "si" : "NO") << "\n";
+    if (mismatches > 0) ss << "(" << mismatches << " rutas distintas!)\n";
+    return ss.str();
+}
+
+std::string Benchmark::routing(Graph& graph, int queries) {
+    std::stringstream ss;
+    ss << "--- Rutas (" << graph.getNodeCount() << " nodos, "
+       << graph.getEdgeCount() << " aristas) ---\n";
+    if (graph.getNodeCount() < 2 || queries <= 0) {
+        ss << "Grafo vacio\n";
+        return ss.str();
+    }
+
+    std::vector<std::pair<Point, Point>> pairs = randomNodePairs(graph, queries);
+
+    // Ubicación de los extremos sobre la red (índice de segmentos)
+    auto start = Clock::now();
+    EdgeSnap snap;
+    for (const auto& od : pairs) {
+        graph.snapToEdge(od.first, snap);
+        graph.snapToEdge(od.second, snap);
+    }
+    double snapMs = elapsedMs(start);
+
+    // 0 = Dijkstra, 1 = A*, 2 = Dijkstra bidireccional, 3 = A* bidireccional
+    const int MODES = 4;
+    const char* labels[MODES] = {"Dijkstra", "A*", "Dijkstra bidireccional", "A* bidireccional"};
+    double totalMs[MODES] = {0, 0, 0, 0};
+    long long settled[MODES] = {0, 0, 0, 0};
+    int found = 0, mismatches = 0;
+    for (const auto& od : pairs) {
+        Route routes[MODES];
+        for (int k = 0; k < MODES; k++) {
+            start = Clock::now();
+            switch (k) {
+                case 0: routes[k] = graph.findShortestPath(od.first, od.second); break;
+                case 1: routes[k] = graph.findAStarPath(od.first, od.second); break;
+                case 2: routes[k] = graph.findBidirectionalPath(od.first, od.second, false); break;
+                case 3: routes[k] = graph.findBidirectionalPath(od.first, od.second, true); break;
+            }
+            totalMs[k] += elapsedMs(start);
+            settled[k] += routes[k].settledNodes;
+        }
+
+        if (routes[0].found) found++;
+        for (int k = 1; k < MODES; k++) {
+            if (routes[k].found != routes[0].found ||
+                std::fabs(routes[k].totalDistance - routes[0].totalDistance) >
+                    1e-6 * (1 + routes[0].totalDistance)) {
+                mismatches++;
+            }
+        }
+    }
+
+    ss << "Ubicar extremos en la red: " << snapMs * 1000 / queries << " us/consulta\n";
+    for (int k = 0; k < MODES; k++) {
+        ss << labels[k] << ": " << totalMs[k] / queries << " ms/consulta, "
+           << settled[k] / queries << " nodos asentados\n";
+    }
+    ss << "Rutas encontradas: " << found << "/" << queries;
+    if (mismatches > 0) ss << " (" << mismatches << " distancias distintas!)";
+    ss << "\n";
+
+    // Rutas cortas (nodo -> vecino): con el espacio de búsqueda reutilizable
+    // el costo depende de lo explorado, no del tamaño del grafo
+    std::mt19937 rng(4243);
+    std::uniform_int_distribution<int> pick(0, graph.getNodeCount() - 1);
+    double shortMs = 0;
+    int shortQueries = 0;
+    for (int q = 0; q < queries; q++) {
+        int u = pick(rng);
+        if (graph.getEdgeBegin(u) == graph.getEdgeEnd(u)) continue;
+        Point a = graph.getNodePosition(u);
+        Point b = graph.getNodePosition(graph.getEdgeTarget(graph.getEdgeBegin(u)));
+        start = Clock::now();
+        graph.findAStarPath(a, b);
+        shortMs += elapsedMs(start);
+        shortQueries++;
+    }
+    if (shortQueries > 0) {
+        ss << "A* entre vecinos: " << shortMs * 1000 / shortQueries << " us/consulta\n";
+    }
+    return ss.str();
+}
+
+std::string Benchmark::contractionHierarchy(Graph& graph, int queries) {
+    std::stringstream ss;
+    ss << "--- Contraction Hierarchies ---\n";
+    if (graph.getNodeCount() < 2 || queries <= 0) {
+        ss << "Grafo vacio\n";
+        return ss.str();
+    }
+
+    ContractionHierarchy ch;
+    auto start = Clock::now();
+    ch.build(graph);
+    double buildMs = elapsedMs(start);
+
+    const char* cacheFile = "benchmark.rtch";
+    start = Clock::now();
+    bool saved = ch.save(cacheFile);
+    double saveMs = elapsedMs(start);
+
+    ContractionHierarchy loaded;
+    start = Clock::now();
+    bool reloaded = saved && loaded.load(cacheFile, graph);
+    double loadMs = elapsedMs(start);
+    remove(cacheFile);
+
+    std::vector<std::pair<Point, Point>> pairs = randomNodePairs(graph, queries);
+
+    double astarMs = 0, chMs = 0;
+    long long astarSettled = 0, chSettled = 0;
+    int mismatches = 0;
+    const ContractionHierarchy& query = reloaded ? loaded : ch;
+    for (const auto& od : pairs) {
+        start = Clock::now();
+        Route a = graph.findAStarPath(od.first, od.second);
+        astarMs += elapsedMs(start);
+        astarSettled += a.settledNodes;
+
+        start = Clock::now();
+        Route c = query.findPath(od.first, od.second);
+        chMs += elapsedMs(start);
+        chSettled += c.settledNodes;
+
+        if (a.found != c.found ||
+            std::fabs(a.totalDistance - c.totalDistance) > 1e-6 * (1 + a.totalDistance)) {
+            mismatches++;
+        }
+    }
+
+    ss << "Preproceso: " << buildMs << " ms (" << ch.getShortcutCount() << " atajos, "
+       << ch.getUpEdgeCount() << " aristas ascendentes)\n";
+    if (graph.getEdgeCount() > 0) {
+        ss << "Atajos por arista original: " << (double)ch.getShortcutCount() / graph.getEdgeCount()
+           << "\n";
+    }
+    if (reloaded) {
+        ss << "Guardar: " << saveMs << " ms, cargar: " << loadMs << " ms\n";
+    } else {
+        ss << "No se pudo guardar/cargar " << cacheFile << "\n";
+    }
+    ss << "A*: " << astarMs / queries << " ms/consulta, " << astarSettled / queries
+       << " nodos asentados\n"
+       << "CH: " << chMs / queries << " ms/consulta, " << chSettled / queries << " nodos asentados";
+    if (chMs > 0) ss << " (x" << astarMs / chMs << " respecto de A*)";
+    ss << "\n";
+    if (mismatches > 0) ss << "Distancias distintas: " << mismatches << "!\n";
+    return ss.str();
+}
+
+std::string Benchmark::customizableHierarchy(Graph& graph, int queries) {
+    std::stringstream ss;
+    ss << "--- CCH (pesos personalizables) ---\n";
+    if (graph.getNodeCount() < 2 || queries <= 0) {
+        ss << "Grafo vacio\n";
+        return ss.str();
+    }
+
+    CustomizableHierarchy cch;
+    auto start = Clock::now();
+    cch.prepare(graph);
+    double prepareMs = elapsedMs(start);
+
+    // Personalización con las distancias: un hilo y todos los del equipo
+    std::vector<double> distances = graph.getEdgeWeights();
+    const int threadOptions[] = {1, 0};
+    double customizeMs[2];
+    for (int k = 0; k < 2; k++) {
+        cch.setThreadCount(threadOptions[k]);
+        start = Clock::now();
+        cch.customize(distances);
+        customizeMs[k] = elapsedMs(start);
+    }
+
+    std::vector<std::pair<Point, Point>> pairs = randomNodePairs(graph, queries);
+
+    double cchMs = 0;
+    long long settled = 0;
+    int mismatches = 0;
+    for (const auto& od : pairs) {
+        start = Clock::now();
+        Route c = cch.findPath(od.first, od.second);
+        cchMs += elapsedMs(start);
+        settled += c.settledNodes;
+
+        Route d = graph.findShortestPath(od.first, od.second);
+        if (d.found != c.found ||
+            std::fabs(d.totalDistance - c.totalDistance) > 1e-6 * (1 + d.totalDistance)) {
+            mismatches++;
+        }
+    }
+
+    // Tráfico: se personalizan métricas nuevas en otro hilo mientras se sigue
+    // consultando; cada consulta usa la métrica vigente al empezar
+    const int UPDATES = 5;
+    std::mt19937 rng(4243);
+    std::uniform_real_distribution<double> congestion(0.25, 1.0);
+    std::vector<std::vector<double>> updates(UPDATES, distances);
+    for (auto& weights : updates) {
+        for (double& w : weights) w /= congestion(rng);
+    }
+
+    std::atomic<bool> customizing(true);
+    start = Clock::now();
+    std::thread updater([&]() {
+        for (const auto& weights : updates) cch.customize(weights);
+        customizing = false;
+    });
+    int concurrentQueries = 0;
+    for (size_t q = 0; customizing; q = (q + 1) % pairs.size()) {
+        cch.findPath(pairs[q].first, pairs[q].second);
+        concurrentQueries++;
+    }
+    updater.join();
+    double updatesMs = elapsedMs(start);
+
+    ss << "Preparacion: " << prepareMs << " ms (" << cch.getUpArcCount() << " arcos, "
+       << cch.getTriangleCount() << " triangulos, " << cch.getLevelCount() << " niveles)\n"
+       << "Personalizacion: " << customizeMs[0] << " ms (1 hilo), "
+       << customizeMs[1] << " ms (" << resolveThreadCount(0) << " hilos)\n"
+       << "CCH: " << cchMs / queries << " ms/consulta, " << settled / queries
+       << " nodos asentados\n"
+       << UPDATES << " actualizaciones de trafico: " << updatesMs << " ms, "
+       << concurrentQueries << " consultas atendidas mientras tanto (metrica "
+       << cch.getMetric()->version << ")\n";
+    if (mismatches > 0) ss << "Distancias distintas: " << mismatches << "!\n";
+    return ss.str();
+}
+
+std::string Benchmark::landmarks(Graph& graph, int landmarkCount, int queries) {
+    std::stringstream ss;
+    ss << "--- ALT (" << landmarkCount << " landmarks) ---\n";
+    if (graph.getNodeCount() < 2 || queries <= 0) {
+        ss << "Grafo vacio\n";
+        return ss.str();
+    }
+
+    const char* names[2] = {"farthest", "avoid"};
+    Landmarks sets[2];
+    for (int s = 0; s < 2; s++) {
+        auto start = Clock::now();
+        sets[s].build(graph, landmarkCount, s == 0 ? LANDMARK_FARTHEST : LANDMARK_AVOID);
+        ss << "Seleccion " << names[s] << ": " << elapsedMs(start) << " ms\n";
+    }
+    ss << "Tabla: " << sets[1].getTableBytes() / 1024 << " KB (32 bits por distancia)\n";
+
+    const char* cacheFile = "benchmark.rtalt";
+    Landmarks loaded;
+    auto start = Clock::now();
+    bool reloaded = sets[1].save(cacheFile) && loaded.load(cacheFile, graph);
+    double reloadMs = elapsedMs(start);
+    remove(cacheFile);
+    if (reloaded) {
+        ss << "Guardar + cargar: " << reloadMs << " ms\n";
+    } else {
+        ss << "No se pudo guardar/cargar " << cacheFile << "\n";
+    }
+
+    std::vector<std::pair<Point, Point>> pairs = randomNodePairs(graph, queries);
+
+    // 0 = A* euclidiano, 1 = ALT farthest, 2 = ALT avoid
+    double totalMs[3] = {0, 0, 0};
+    long long settled[3] = {0, 0, 0};
+    int mismatches = 0;
+    for (const auto& od : pairs) {
+        Route routes[3];
+        for (int k = 0; k < 3; k++) {
+            start = Clock::now();
+            routes[k] = k == 0 ? graph.findAStarPath(od.first, od.second)
+                               : graph.findALTPath(od.first, od.second, sets[k - 1]);
+            totalMs[k] += elapsedMs(start);
+            settled[k] += routes[k].settledNodes;
+        }
+        for (int k = 1; k < 3; k++) {
+            if (routes[k].found != routes[0].found ||
+                std::fabs(routes[k].totalDistance - routes[0].totalDistance) >
+                    1e-6 * (1 + routes[0].totalDistance)) {
+                mismatches++;
+            }
+        }
+    }
+
+    const char* labels[3] = {"A* euclidiano", "ALT farthest", "ALT avoid"};
+    for (int k = 0; k < 3; k++) {
+        ss << labels[k] << ": " << settled[k] / queries << " nodos asentados, "
+           << totalMs[k] / queries << " ms/consulta\n";
+    }
+    if (mismatches > 0) ss << "Distancias distintas: " << mismatches << "!\n";
+    return ss.str();
+}
+
+std::string Benchmark::distanceMatrix(Graph& graph, int sources, int targets) {
+    std::stringstream ss;
+    ss << "--- Matriz de distancias (" << sources << " x " << targets << ") ---\n";
+    if (graph.getNodeCount() < 2 || sources <= 0 || targets <= 0) {
+        ss << "Grafo vacio\n";
+        return ss.str();
+    }
+
+    std::mt19937 rng(4242);
+    std::uniform_int_distribution<int> pick(0, graph.getNodeCount() - 1);
+    std::vector<Point> from(sources), to(targets);
+    for (auto& p : from) p = graph.getNodePosition(pick(rng));
+    for (auto& p : to) p = graph.getNodePosition(pick(rng));
+
+    auto start = Clock::now();
+    DistanceMatrix one = graph.distanceMatrix(std::vector<Point>(1, from[0]), to);
+    double oneMs = elapsedMs(start);
+
+    start = Clock::now();
+    DistanceMatrix matrix = graph.distanceMatrix(from, to);
+    double matrixMs = elapsedMs(start);
+
+    // Referencia: un A* por cada par origen-destino
+    int mismatches = 0;
+    start = Clock::now();
+    for (int i = 0; i < sources; i++) {
+        for (int j = 0; j < targets; j++) {
+            Route r = graph.findAStarPath(from[i], to[j]);
+            if (r.found != matrix.reachable(i, j) ||
+                (r.found && std::fabs(r.totalDistance - matrix.at(i, j)) > 1e-6 * (1 + r.totalDistance))) {
+                mismatches++;
+            }
+        }
+    }
+    double pairsMs = elapsedMs(start);
+
+    ss << "1 a " << targets << ": " << oneMs << " ms\n"
+       << sources << " a " << targets << ": " << matrixMs << " ms\n"
+       << "A* por par: " << pairsMs << " ms";
+    if (matrixMs > 0) ss << " (x" << pairsMs / matrixMs << ")";
+    ss << "\n";
+    if (mismatches > 0 || one.at(0, 0) != matrix.at(0, 0)) {
+        ss << "Distancias distintas: " << mismatches << "!\n";
+    }
+    return ss.str();
+}
+
+std::string Benchmark::nearestUnits(Graph& graph, int k, int queries) {
+    std::stringstream ss;
+    ss << "--- Unidades mas cercanas por la red (k = " << k << ") ---\n";
+    if (graph.getNodeCount() < 2 || k <= 0 || queries <= 0) {
+        ss << "Grafo vacio\n";
+        return ss.str();
+    }
+
+    // Unidades e incidentes al azar dentro de la extensión de la red
+    Rect extent(graph.getNodePosition(0));
+    for (int i = 1; i < graph.getNodeCount(); i++) extent.expand(graph.getNodePosition(i));
+    std::mt19937 rng(4242);
+    std::uniform_real_distribution<double> randX(extent.minX, extent.maxX);
+    std::uniform_real_distribution<double> randY(extent.minY, extent.maxY);
+    std::vector<Point> incidents(queries);
+    for (auto& p : incidents) p = Point(randX(rng), randY(rng));
+
+    // A* a cada unidad sólo con flotas chicas (con las grandes no termina)
+    const int BRUTE_FORCE_MAX = 100;
+    const int fleets[] = {10, 100, 1000, 10000};
+    for (int fleetSize : fleets) {
+        std::vector<Point> positions(fleetSize);
+        for (auto& p : positions) p = Point(randX(rng), randY(rng));
+
+        UnitIndex units;
+        auto start = Clock::now();
+        units.build(graph, positions);
+        double indexMs = elapsedMs(start);
+
+        double ineMs = 0, ierMs = 0, bruteMs = 0;
+        long long ineSettled = 0, ierSettled = 0, ierVerified = 0;
+        int mismatches = 0, euclideanMisses = 0;
+        for (const auto& p : incidents) {
+            start = Clock::now();
+            UnitRanking ine = graph.nearestByNetwork(p, k, units);
+            ineMs += elapsedMs(start);
+            ineSettled += ine.settledNodes;
+
+            start = Clock::now();
+            UnitRanking ier = graph.nearestByNetworkIER(p, k, units);
+            ierMs += elapsedMs(start);
+            ierSettled += ier.settledNodes;
+            ierVerified += ier.verifiedUnits;
+
+            // Se comparan distancias: con empates el orden puede variar
+            std::vector<double> expected = ine.distances;
+            if (fleetSize <= BRUTE_FORCE_MAX) {
+                start = Clock::now();
+                std::vector<double> all;
+                for (const auto& unit : positions) {
+                    Route r = graph.findAStarPath(p, unit);
+                    if (r.found) all.push_back(r.totalDistance);
+                }
+                bruteMs += elapsedMs(start);
+                std::sort(all.begin(), all.end());
+                if (all.size() > (size_t)k) all.resize(k);
+                expected = all;
+            }
+            const std::vector<double>* rankings[2] = {&ine.distances, &ier.distances};
+            for (const auto* distances : rankings) {
+                bool same = distances->size() == expected.size();
+                for (size_t i = 0; same && i < expected.size(); i++) {
+                    same = std::fabs((*distances)[i] - expected[i]) <= 1e-6 * (1 + expected[i]);
+                }
+                if (!same) mismatches++;
+            }
+
+            // La más cercana en línea recta, ¿es la más cercana por la red?
+            int straight = -1;
+            const PackedRTree& index = units.getEuclideanIndex();
+            index.nearestFirst(graph.getProjection().forward(p), [&](size_t leaf, double) {
+                straight = (int)index.getLeaf(leaf).offset;
+                return false;
+            });
+            if (straight >= 0 && !ine.units.empty() && straight != ine.units[0]) {
+                Route r = graph.findAStarPath(p, positions[straight]);
+                if (!r.found || r.totalDistance > ine.distances[0] * (1 + 1e-9) + 1e-9) {
+                    euclideanMisses++;
+                }
+            }
+        }
+
+        ss << "Flota de " << fleetSize << ": indice " << indexMs << " ms\n"
+           << "  INE: " << ineMs / queries << " ms/consulta, "
+           << ineSettled / queries << " nodos asentados\n"
+           << "  IER: " << ierMs / queries << " ms/consulta, "
+           << (double)ierVerified / queries << " unidades verificadas, "
+           << ierSettled / queries << " nodos asentados\n";
+        if (fleetSize <= BRUTE_FORCE_MAX) {
+            ss << "  A* a cada unidad: " << bruteMs / queries << " ms/consulta\n";
+        }
+        ss << "  La mas cercana en linea recta no es la mas cercana por ruta en "
+           << 100.0 * euclideanMisses / queries << " % de los casos\n";
+        if (mismatches > 0) ss << "  (" << mismatches << " rankings distintos!)\n";
+    }
+    return ss.str();
+}
+
+std::string Benchmark::mapMatching(Graph& graph, int traces) {
+    std::stringstream ss;
+    ss << "--- Map matching (" << traces << " trazas) ---\n";
+    if (graph.getNodeCount() < 2 || traces <= 0) {
+        ss << "Grafo vacio\n";
+        return ss.str();
+    }
+
+    const double SPACING = 10;  // Unidades del grafo entre muestras (~1 s a 36 km/h)
+    const double noises[] = {5, 15};
+
+    std::vector<std::pair<Point, Point>> pairs = randomNodePairs(graph, traces);
+
+    const Projection& proj = graph.getProjection();
+    for (double noise : noises) {
+        std::vector<SyntheticTrace> generated;
+        for (int i = 0; i < traces; i++) {
+            generated.push_back(MapMatcher::synthesize(graph, pairs[i].first, pairs[i].second,
+                                                       SPACING, noise, 100 + i));
+        }
+
+        MapMatcher matcher(graph);
+        matcher.setGpsSigma(noise);
+        long long points = 0, unmatched = 0;
+        double matchMs = 0, matchedError = 0, nearestError = 0;
+        int matchedEdge = 0, nearestEdge = 0, matchedGross = 0, nearestGross = 0;
+        for (const auto& trace : generated) {
+            auto start = Clock::now();
+            for (const auto& p : trace.observed) matcher.push(p);
+            matcher.finish();
+            std::vector<MatchedPoint> result = matcher.takeMatched();
+            matchMs += elapsedMs(start);
+            matcher.reset();
+
+            // Arista real (la posición verdadera está sobre la red) frente a
+            // la elegida por el HMM y a la calle más cercana al GPS
+            for (size_t i = 0; i < result.size(); i++) {
+                Point truth = proj.forward(trace.truth[i]);
+                EdgeSnap real, nearest;
+                graph.snapToEdge(trace.truth[i], real);
+                bool hasNearest = graph.snapToEdge(trace.observed[i], nearest);
+
+                if (!result[i].matched) {
+                    unmatched++;
+                } else if (graph.getEdgeId(result[i].snap.edge) == graph.getEdgeId(real.edge)) {
+                    matchedEdge++;
+                }
+                if (hasNearest && graph.getEdgeId(nearest.edge) == graph.getEdgeId(real.edge)) {
+                    nearestEdge++;
+                }
+                // Error grueso: más de dos desvíos del GPS (calle equivocada)
+                double matchedOff = proj.forward(result[i].position).distanceTo(truth);
+                double nearestOff = proj.forward(hasNearest ? nearest.point : trace.observed[i])
+                                        .distanceTo(truth);
+                matchedError += matchedOff;
+                nearestError += nearestOff;
+                if (matchedOff > 2 * noise) matchedGross++;
+                if (nearestOff > 2 * noise) nearestGross++;
+            }
+            points += (long long)result.size();
+        }
+
+        long long lookups = matcher.getCacheHits() + matcher.getCacheMisses();
+        ss << "Ruido " << noise << ": " << points << " puntos, "
+           << (matchMs > 0 ? points / (matchMs / 1000) : 0) << " puntos/s\n"
+           << "  HMM: arista correcta " << (points ? 100.0 * matchedEdge / points : 0)
+           << " %, error medio " << (points ? matchedError / points : 0)
+           << ", errores gruesos " << (points ? 100.0 * matchedGross / points : 0) << " %\n"
+           << "  Calle mas cercana: arista correcta " << (points ? 100.0 * nearestEdge / points : 0)
+           << " %, error medio " << (points ? nearestError / points : 0)
+           << ", errores gruesos " << (points ? 100.0 * nearestGross / points : 0) << " %\n"
+           << "  Arboles de ruta reutilizados: "
+           << (lookups ? 100.0 * matcher.getCacheHits() / lookups : 0) << " %";
+        if (unmatched > 0) ss << ", " << unmatched << " puntos sin calle cerca";
+        ss << "\n";
+    }
+    return ss.str();
+}
+
+std::string Benchmark::rendering(const LayerManager& layers, const Graph& graph,
+                                 int width, int height, int frames) {
+    std::stringstream ss;
+    ss << "--- Dibujo sin ventana (" << width << "x" << height << ", " << frames << " cuadros) ---\n";
+    if (layers.empty() || frames <= 0) {
+        ss << "Sin datos\n";
+        return ss.str();
+    }
+
+    RasterBackend canvas(width, height);
+    Renderer renderer(canvas);
+    renderer.setViewBounds(layers.getBounds());
+
+    auto start = Clock::now();
+    for (int i = 0; i < frames; i++) renderer.render(layers);
+    double mapMs = elapsedMs(start) / frames;
+    int total = layers.getGeometryCount();
+    ss << "Mapa completo: " << mapMs << " ms/cuadro ("
+       << (mapMs > 0 ? 1000 / mapMs : 0) << " cuadros/s, " << renderer.getDrawnCount()
+       << " objetos)\n";
+
+    if (graph.getNodeCount() > 0) {
+        start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            renderer.render(layers);
+            renderer.renderGraph(graph);
+        }
+        ss << "Mapa + grafo: " << elapsedMs(start) / frames << " ms/cuadro ("
+           << renderer.getDrawnCount() << " objetos)\n";
+    }
+
+    // Zoom al centro, dos veces 11 pasos de la rueda (el zoom se limita a
+    // x50): con el recorte por el índice el tiempo baja con los objetos en pantalla
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < 11; i++) renderer.zoomIn(width / 2, height / 2);
+        start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            renderer.render(layers);
+            if (graph.getNodeCount() > 0) renderer.renderGraph(graph);
+        }
+        ss << "Zoom x" << (int)std::lround(renderer.getZoom()) << " al centro: "
+           << elapsedMs(start) / frames << " ms/cuadro (" << renderer.getDrawnCount()
+           << " objetos de " << total + graph.getNodeCount() + graph.getEdgeCount() << ")\n";
+    }
+
+    // Barrido de la vista de ciudad (x0.2) a la de calle (x50) con y sin
+    // niveles de detalle: con ellos el tiempo por cuadro queda casi parejo
+    ss << "Barrido de zoom (ms/cuadro, con / sin niveles de detalle):\n";
+    const int wheelSteps[] = {-9, 0, 11, 22};
+    for (int steps : wheelSteps) {
+        renderer.resetView();
+        for (int i = 0; i < steps; i++) renderer.zoomIn(width / 2, height / 2);
+        for (int i = 0; i > steps; i--) renderer.zoomOut(width / 2, height / 2);
+
+        double ms[2];
+        int drawn = 0;
+        for (int lod = 1; lod >= 0; lod--) {
+            renderer.setLevelOfDetail(lod == 1);
+            start = Clock::now();
+            for (int i = 0; i < frames; i++) renderer.render(layers);
+            ms[1 - lod] = elapsedMs(start) / frames;
+            if (lod == 1) drawn = renderer.getDrawnCount();
+        }
+        renderer.setLevelOfDetail(true);
+        ss << "  x" << renderer.getZoom() << ": " << ms[0] << " / " << ms[1] << " (" << drawn
+           << " objetos con detalle reducido)\n";
+    }
+
+    for (size_t i = 0; i < layers.getLayerCount(); i++) {
+        const Layer& layer = layers.getLayerAt(i);
+        if (layer.lod.getLevelCount() == 0) continue;
+        ss << "Niveles de '" << layer.name << "' (objetos/vertices):";
+        for (int k = 1; k <= layer.lod.getLevelCount(); k++) {
+            ss << " " << layer.lod.getObjectCount(k) << "/" << layer.lod.getVertexTotal(k);
+        }
+        ss << ", " << layer.lod.getMemoryBytes() / 1024 << " KB\n";
+    }
+
+    renderer.resetView();
+    renderer.render(layers);
+    const char* pngFile = "benchmark.png";
+    const char* ppmFile = "benchmark.ppm";
+    start = Clock::now();
+    bool pngOk = canvas.writePNG(pngFile);
+    double pngMs = elapsedMs(start);
+    start = Clock::now();
+    bool ppmOk = canvas.writePPM(ppmFile);
+    double ppmMs = elapsedMs(start);
+    remove(pngFile);
+    remove(ppmFile);
+    if (pngOk && ppmOk) {
+        ss << "Escritura: PNG " << pngMs << " ms, PPM " << ppmMs << " ms\n";
+    } else {
+        ss << "Error al escribir el cuadro\n";
+    }
+    return ss.str();
+}
+
+std::string Benchmark::tiles(const LayerManager& layers, int minZoom, int maxZoom) {
+    std::stringstream ss;
+    ss << "--- Teselas XYZ (z" << minZoom << "-" << maxZoom << ") ---\n";
+    if (layers.empty() || !Projection::isGeographic(layers.getBounds())) {
+        ss << "El mapa no esta en lon/lat\n";
+        return ss.str();
+    }
+
+    TileGenerator sequential(layers);
+    sequential.setThreadCount(1);
+    auto start = Clock::now();
+    int count = sequential.generate(minZoom, maxZoom);
+    double singleMs = elapsedMs(start);
+
+    TileGenerator generator(layers);
+    start = Clock::now();
+    generator.generate(minZoom, maxZoom);
+    double parallelMs = elapsedMs(start);
+
+    TileCache& cache = generator.getCache();
+    ss << "Piramide: " << count << " teselas, " << cache.getBytes() / 1024 << " KB ("
+       << (cache.size() > 0 ? cache.getBytes() / cache.size() : 0) << " bytes/tesela)\n"
+       << "1 hilo: " << singleMs << " ms (" << (singleMs > 0 ? count * 1000 / singleMs : 0)
+       << " teselas/s)\n"
+       << resolveThreadCount(0) << " hilos: " << parallelMs << " ms (x"
+       << (parallelMs > 0 ? singleMs / parallelMs : 0) << ")\n";
+
+    // Pedir otra vez todas las del zoom mayor: salen del caché
+    int x0, y0, x1, y1;
+    TileGenerator::tileRange(layers.getBounds(), maxZoom, x0, y0, x1, y1);
+    std::vector<uint8_t> png;
+    size_t hitsBefore = cache.getHits();
+    int requests = 0;
+    start = Clock::now();
+    for (int x = x0; x <= x1; x++) {
+        for (int y = y0; y <= y1; y++, requests++) generator.getTile(TileKey(maxZoom, x, y), png);
+    }
+    double cachedMs = elapsedMs(start);
+    ss << "Desde el cache: " << (requests > 0 ? cachedMs * 1000 / requests : 0) << " us/tesela ("
+       << cache.getHits() - hitsBefore << " de " << requests << " aciertos)\n";
+
+    // Cambian 20 geometrías al azar de la primera capa visible
+    std::vector<Rect> changed;
+    std::mt19937 rng(4949);
+    for (size_t i = 0; i < layers.getLayerCount() && changed.empty(); i++) {
+        const Layer& layer = layers.getLayerAt(i);
+        if (!layer.visible || layer.geometries.empty()) continue;
+        std::uniform_int_distribution<size_t> pick(0, layer.geometries.size() - 1);
+        for (int k = 0; k < 20; k++) changed.push_back(layer.geometries[pick(rng)].mbr);
+    }
+    start = Clock::now();
+    int updated = generator.update(changed);
+    double updateMs = elapsedMs(start);
+    ss << "Incremental (20 geometrias): " << updated << " teselas en " << updateMs
+       << " ms, frente a " << parallelMs << " ms de la piramide completa\n";
+    return ss.str();
+}
+
+std::string Benchmark::vectorTiles(const LayerManager& layers, int minZoom, int maxZoom, double budgetMs) {
+    std::stringstream ss;
+    ss << "--- Teselas vectoriales MVT (z" << minZoom << "-" << maxZoom << ") ---\n";
+    if (layers.empty() || !Projection::isGeographic(layers.getBounds())) {
+        ss << "El mapa no esta en lon/lat\n";
+        return ss.str();
+    }
+
+    // Latencia de cada tesela pedida sin caché, como un servidor que la
+    // genera al vuelo; también el tamaño frente a la misma tesela en PNG
+    TileGenerator onDemand(layers, TILE_MVT);
+    TileGenerator raster(layers, TILE_PNG);
+    std::vector<double> latencies;
+    std::vector<uint8_t> data;
+    size_t vectorBytes = 0, rasterBytes = 0;
+    for (int z = minZoom; z <= maxZoom; z++) {
+        int x0, y0, x1, y1;
+        TileGenerator::tileRange(layers.getBounds(), z, x0, y0, x1, y1);
+        for (int x = x0; x <= x1; x++) {
+            for (int y = y0; y <= y1; y++) {
+                auto start = Clock::now();
+                onDemand.getTile(TileKey(z, x, y), data);
+                latencies.push_back(elapsedMs(start));
+                vectorBytes += data.size();
+                raster.getTile(TileKey(z, x, y), data);
+                rasterBytes += data.size();
+            }
+        }
+    }
+    size_t count = latencies.size();
+    std::vector<double> sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+    int overBudget = 0;
+    for (double ms : latencies) {
+        if (ms > budgetMs) overBudget++;
+    }
+    ss << count << " teselas: " << vectorBytes / count << " bytes/tesela (PNG: " << rasterBytes / count
+       << ")\n"
+       << "Latencia por tesela: mediana " << sorted[count / 2] << " ms, p95 "
+       << sorted[std::min(count - 1, count * 95 / 100)] << " ms, maxima " << sorted.back() << " ms\n"
+       << "Presupuesto " << budgetMs << " ms: " << overBudget << " de " << count << " teselas lo exceden"
+       << (overBudget == 0 ? " (OK)" : "") << "\n";
+
+    // Los atributos de las geometrías (properties de GeoJSON, etiquetas de
+    // PBF) tienen que llegar a las entidades de las teselas
+    size_t sourceTagged = 0;
+    for (size_t i = 0; i < layers.getLayerCount(); i++) {
+        const Layer& layer = layers.getLayerAt(i);
+        if (!layer.visible) continue;
+        for (const auto& geom : layer.geometries) {
+            if (!geom.properties.empty()) sourceTagged++;
+        }
+    }
+    VectorTileEncoder encoder;
+    size_t features = 0, tagged = 0;
+    int x0, y0, x1, y1;
+    TileGenerator::tileRange(layers.getBounds(), maxZoom, x0, y0, x1, y1);
+    for (int x = x0; x <= x1; x++) {
+        for (int y = y0; y <= y1; y++) {
+            encoder.encode(layers, TileKey(maxZoom, x, y), data);
+            features += encoder.getFeatureCount();
+            tagged += encoder.getTaggedFeatureCount();
+        }
+    }
+    ss << "Entidades con atributos (z" << maxZoom << "): " << tagged << " de " << features;
+    if (sourceTagged > 0 && tagged == 0) ss << " (se perdieron los atributos!)";
+    ss << "\n";
+
+    // Pirámide completa en paralelo y relectura desde el caché
+    TileGenerator sequential(layers, TILE_MVT);
+    sequential.setThreadCount(1);
+    auto start = Clock::now();
+    sequential.generate(minZoom, maxZoom);
+    double singleMs = elapsedMs(start);
+
+    TileGenerator generator(layers, TILE_MVT);
+    start = Clock::now();
+    generator.generate(minZoom, maxZoom);
+    double parallelMs = elapsedMs(start);
+    ss << "Piramide: 1 hilo " << singleMs << " ms, " << resolveThreadCount(0) << " hilos " << parallelMs
+       << " ms (x" << (parallelMs > 0 ? singleMs / parallelMs : 0) << ")\n";
+
+    start = Clock::now();
+    for (int z = minZoom; z <= maxZoom; z++) {
+        int x0, y0, x1, y1;
+        TileGenerator::tileRange(layers.getBounds(), z, x0, y0, x1, y1);
+        for (int x = x0; x <= x1; x++) {
+            for (int y = y0; y <= y1; y++) generator.getTile(TileKey(z, x, y), data);
+        }
+    }
+    double cachedMs = elapsedMs(start);
+    ss << "Desde el cache: " << cachedMs * 1000 / count << " us/tesela\n";
+    return ss.str();
+}
+
+std::string Benchmark::isochrones(Graph& graph, int origins) {
+    std::stringstream ss;
+    ss << "--- Isocronas (" << origins << " bases) ---\n";
+    if (graph.getNodeCount() < 2 || origins <= 0) {
+        ss << "Grafo vacio\n";
+        return ss.str();
+    }
+
+    // Presupuestos: 1/3, 2/3 y 3/3 de la cuarta parte de la diagonal de la red
+    Rect extent(graph.getMetricPosition(0));
+    for (int i = 1; i < graph.getNodeCount(); i++) extent.expand(graph.getMetricPosition(i));
+    double diagonal = Point(extent.minX, extent.minY).distanceTo(Point(extent.maxX, extent.maxY));
+    double maxBudget = diagonal / 4;
+    std::vector<double> budgets = {maxBudget / 3, maxBudget * 2 / 3, maxBudget};
+
+    std::mt19937 rng(4242);
+    std::uniform_int_distribution<int> pick(0, graph.getNodeCount() - 1);
+    std::vector<Point> bases(origins);
+    for (auto& p : bases) p = graph.getNodePosition(pick(rng));
+
+    auto start = Clock::now();
+    size_t rings = 0;
+    for (const auto& p : bases) {
+        for (const auto& iso : graph.isochrone(p, budgets)) rings += iso.rings.size();
+    }
+    double singleMs = elapsedMs(start);
+
+    start = Clock::now();
+    std::vector<std::vector<Isochrone>> batch = graph.isochrones(bases, budgets);
+    double batchMs = elapsedMs(start);
+
+    ss << "Presupuestos: " << budgets[0] << " / " << budgets[1] << " / " << budgets[2] << "\n"
+       << "Una base: " << singleMs / origins << " ms (" << rings / origins << " anillos)\n"
+       << "Lote en paralelo: " << batchMs << " ms (" << batchMs / origins << " ms/base)\n";
+    return ss.str();
+}
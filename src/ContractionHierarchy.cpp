@@ -0,0 +1,530 @@
+#include "../include/ContractionHierarchy.h"
+#include "../include/Parallel.h"
+#include "../include/SearchWorkspace.h"
+#include <fstream>
+#include <cstring>
+#include <queue>
+#include <limits>
+#include <algorithm>
+
+namespace {
+
+const double INF = std::numeric_limits<double>::max();
+
+// Nodos asentados como máximo por búsqueda de testigo. Cortarla antes sólo
+// agrega atajos de más, nunca rompe la exactitud.
+const int WITNESS_SETTLE_LIMIT = 500;
+
+// La prioridad simula la contracción con una búsqueda algo más corta: con
+// muy pocos nodos sobrestima los atajos; con el límite completo el orden
+// casi no cambia y el preproceso tarda el triple
+const int PRIORITY_SETTLE_LIMIT = 50;
+
+// Un testigo apenas más largo que el atajo por redondeo también vale; sin
+// esta tolerancia, los caminos de igual largo (cuadrículas) generan atajos
+const double WITNESS_TOLERANCE = 1e-9;
+
+const char CH_MAGIC[6] = {'R', 'T', 'C', 'H', 0, 0};
+const uint8_t CH_VERSION = 1;
+
+// Estados de un nodo durante la contracción
+const char NODE_ALIVE = 0;
+const char NODE_CONTRACTING = 1;  // En el lote de la ronda actual
+const char NODE_CONTRACTED = 2;
+
+// Arista del grafo dinámico (una por par de nodos, la más corta)
+struct Arc {
+    int to;
+    double weight;
+    int middle;  // -1 = arista original
+};
+
+struct Shortcut {
+    int from, to;
+    double weight;
+};
+
+typedef std::priority_queue<std::pair<double, int>,
+                            std::vector<std::pair<double, int>>,
+                            std::greater<std::pair<double, int>>> MinQueue;
+
+// Distancias reutilizables: sólo se reinician los nodos tocados
+struct Workspace {
+    std::vector<double> dist;
+    std::vector<int> touched;
+    std::vector<char> isTarget;  // Vecinos buscados por el testigo en curso
+
+    void init(int n) {
+        dist.assign(n, INF);
+        isTarget.assign(n, 0);
+    }
+
+    void set(int v, double d) {
+        if (dist[v] == INF) touched.push_back(v);
+        dist[v] = d;
+    }
+
+    void reset() {
+        for (int v : touched) dist[v] = INF;
+        touched.clear();
+    }
+};
+
+struct ContractionState {
+    std::vector<std::vector<Arc>> adj;
+    std::vector<char> state;
+    std::vector<int> level;  // Profundidad en la jerarquía (1 + nivel del vecino contraído)
+};
+
+// true si agregó un arco nuevo (false si ya había uno entre el par)
+bool addOrImprove(std::vector<Arc>& arcs, int to, double weight, int middle) {
+    for (auto& arc : arcs) {
+        if (arc.to == to) {
+            if (weight < arc.weight) {
+                arc.weight = weight;
+                arc.middle = middle;
+            }
+            return false;
+        }
+    }
+    arcs.push_back({to, weight, middle});
+    return true;
+}
+
+// Dijkstra local desde source que no pasa por 'skip' ni por nodos no vivos.
+// Termina al superar el límite de distancia o al asentar todos los objetivos.
+void witnessSearch(const ContractionState& st, int source, int skip, double limit,
+                   int targets, std::vector<char>& isTarget, int settleLimit, Workspace& ws) {
+    MinQueue queue;
+    ws.set(source, 0);
+    queue.push({0, source});
+
+    int settled = 0;
+    while (!queue.empty() && settled < settleLimit && targets > 0) {
+        double d = queue.top().first;
+        int u = queue.top().second;
+        queue.pop();
+        if (d > ws.dist[u]) continue;
+        if (d > limit) break;
+        settled++;
+        if (isTarget[u]) targets--;
+
+        for (const Arc& arc : st.adj[u]) {
+            if (arc.to == skip || st.state[arc.to] != NODE_ALIVE) continue;
+            double nd = d + arc.weight;
+            if (nd < ws.dist[arc.to]) {
+                ws.set(arc.to, nd);
+                queue.push({nd, arc.to});
+            }
+        }
+    }
+}
+
+// Atajos que exigiría contraer u ahora (no modifica el grafo)
+void findShortcuts(const ContractionState& st, int u, int settleLimit, Workspace& ws,
+                   std::vector<Shortcut>& out) {
+    out.clear();
+    const std::vector<Arc>& arcs = st.adj[u];
+
+    // Grafo no dirigido: basta con cada par (i, j) con i < j
+    for (size_t i = 0; i < arcs.size(); i++) {
+        if (st.state[arcs[i].to] != NODE_ALIVE) continue;
+
+        double maxWeight = 0;
+        int targets = 0;
+        for (size_t j = i + 1; j < arcs.size(); j++) {
+            if (st.state[arcs[j].to] != NODE_ALIVE) continue;
+            maxWeight = std::max(maxWeight, arcs[j].weight);
+            ws.isTarget[arcs[j].to] = 1;
+            targets++;
+        }
+        if (targets == 0) continue;
+
+        witnessSearch(st, arcs[i].to, u, arcs[i].weight + maxWeight, targets, ws.isTarget,
+                      settleLimit, ws);
+        for (size_t j = i + 1; j < arcs.size(); j++) {
+            if (st.state[arcs[j].to] != NODE_ALIVE) continue;
+            ws.isTarget[arcs[j].to] = 0;
+            double via = arcs[i].weight + arcs[j].weight;
+            if (ws.dist[arcs[j].to] > via * (1 + WITNESS_TOLERANCE)) {
+                out.push_back({arcs[i].to, arcs[j].to, via});
+            }
+        }
+        ws.reset();
+    }
+}
+
+// Atajos por arista eliminada + profundidad en la jerarquía. La razón
+// (y no la diferencia) retrasa los nodos cuya contracción densifica el grafo
+double priority(const ContractionState& st, int u, Workspace& ws, std::vector<Shortcut>& scratch) {
+    findShortcuts(st, u, PRIORITY_SETTLE_LIMIT, ws, scratch);
+    int degree = 0;
+    for (const Arc& arc : st.adj[u]) {
+        if (st.state[arc.to] == NODE_ALIVE) degree++;
+    }
+    double ratio = degree > 0 ? (double)scratch.size() / degree : 0;
+    return 4.0 * ratio + st.level[u];
+}
+
+// Desempate pseudoaleatorio: con el id directo, en zonas de prioridad
+// uniforme (cuadrículas) sólo un nodo por fila ganaría y los lotes serían mínimos
+uint32_t tieBreak(int u) {
+    uint32_t x = (uint32_t)u;
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+template <typename T>
+void writeArray(std::ofstream& file, const std::vector<T>& values) {
+    if (!values.empty()) file.write((const char*)values.data(), values.size() * sizeof(T));
+}
+
+template <typename T>
+bool readArray(std::ifstream& file, std::vector<T>& values, size_t count) {
+    values.resize(count);
+    if (count == 0) return true;
+    return (bool)file.read((char*)values.data(), count * sizeof(T));
+}
+
+} // namespace
+
+ContractionHierarchy::ContractionHierarchy()
+    : graph(nullptr), graphFingerprint(0), shortcutCount(0), threadCount(0) {}
+
+void ContractionHierarchy::clear() {
+    graph = nullptr;
+    graphFingerprint = 0;
+    rank.clear();
+    upFirst.clear();
+    upTarget.clear();
+    upWeight.clear();
+    upMiddle.clear();
+    shortcutCount = 0;
+}
+
+void ContractionHierarchy::build(const Graph& g) {
+    clear();
+    int n = g.getNodeCount();
+
+    // Grafo dinámico inicial: sin lazos y con la arista más corta de cada par
+    ContractionState st;
+    st.adj.resize(n);
+    st.state.assign(n, NODE_ALIVE);
+    st.level.assign(n, 0);
+    for (int u = 0; u < n; u++) {
+        for (int e = g.getEdgeBegin(u); e < g.getEdgeEnd(u); e++) {
+            int v = g.getEdgeTarget(e);
+            if (v != u) addOrImprove(st.adj[u], v, g.getEdgeWeight(e), -1);
+        }
+    }
+
+    int threads = resolveThreadCount(threadCount);
+    std::vector<Workspace> workspaces(threads);
+    std::vector<std::vector<Shortcut>> scratch(threads);
+    for (auto& ws : workspaces) ws.init(n);
+
+    std::vector<double> prio(n);
+    parallelForThreads(n, threads, [&](int u, int t) {
+        prio[u] = priority(st, u, workspaces[t], scratch[t]);
+    });
+
+    rank.assign(n, -1);
+    std::vector<std::vector<Arc>> up(n);
+    std::vector<int> remaining(n);
+    for (int u = 0; u < n; u++) remaining[u] = u;
+
+    int order = 0;
+    while (!remaining.empty()) {
+        // Lote independiente: nodos con la menor prioridad a dos saltos. Con
+        // sólo los vecinos directos, dos nodos del lote podían compartir un
+        // vecino y cada uno bloquear los testigos que pasan por el otro
+        std::vector<int> batch;
+        auto precedes = [&](int v, int u) {
+            return prio[v] < prio[u] || (prio[v] == prio[u] && tieBreak(v) < tieBreak(u));
+        };
+        for (int u : remaining) {
+            bool isMinimum = true;
+            for (const Arc& arc : st.adj[u]) {
+                if (precedes(arc.to, u)) {
+                    isMinimum = false;
+                    break;
+                }
+                for (const Arc& second : st.adj[arc.to]) {
+                    if (second.to != u && precedes(second.to, u)) {
+                        isMinimum = false;
+                        break;
+                    }
+                }
+                if (!isMinimum) break;
+            }
+            if (isMinimum) batch.push_back(u);
+        }
+        for (int u : batch) st.state[u] = NODE_CONTRACTING;
+
+        // Los testigos ignoran todo el lote, así cada nodo se puede
+        // contraer en paralelo sobre el grafo sin modificar
+        std::vector<std::vector<Shortcut>> shortcuts(batch.size());
+        parallelForThreads((int)batch.size(), threads, [&](int i, int t) {
+            findShortcuts(st, batch[i], WITNESS_SETTLE_LIMIT, workspaces[t], shortcuts[i]);
+        });
+
+        // Aplicar la contracción
+        std::vector<int> affected;
+        for (size_t i = 0; i < batch.size(); i++) {
+            int u = batch[i];
+            rank[u] = order++;
+            st.state[u] = NODE_CONTRACTED;
+
+            // Sus aristas restantes van hacia nodos que se contraen después
+            up[u] = st.adj[u];
+            for (const Arc& arc : st.adj[u]) {
+                std::vector<Arc>& other = st.adj[arc.to];
+                for (size_t k = 0; k < other.size(); k++) {
+                    if (other[k].to == u) {
+                        other[k] = other.back();
+                        other.pop_back();
+                        break;
+                    }
+                }
+                st.level[arc.to] = std::max(st.level[arc.to], st.level[u] + 1);
+                affected.push_back(arc.to);
+            }
+            std::vector<Arc>().swap(st.adj[u]);
+
+            // Un atajo que mejora un arco existente no agrega aristas
+            for (const Shortcut& sc : shortcuts[i]) {
+                if (addOrImprove(st.adj[sc.from], sc.to, sc.weight, u)) shortcutCount++;
+                addOrImprove(st.adj[sc.to], sc.from, sc.weight, u);
+            }
+        }
+
+        // Recalcular la prioridad de los vecinos afectados
+        std::sort(affected.begin(), affected.end());
+        affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+        parallelForThreads((int)affected.size(), threads, [&](int i, int t) {
+            prio[affected[i]] = priority(st, affected[i], workspaces[t], scratch[t]);
+        });
+
+        remaining.erase(std::remove_if(remaining.begin(), remaining.end(),
+                                       [&](int u) { return st.state[u] == NODE_CONTRACTED; }),
+                        remaining.end());
+    }
+
+    // Grafo ascendente en CSR
+    upFirst.assign(n + 1, 0);
+    for (int u = 0; u < n; u++) upFirst[u + 1] = upFirst[u] + (int)up[u].size();
+    upTarget.reserve(upFirst[n]);
+    upWeight.reserve(upFirst[n]);
+    upMiddle.reserve(upFirst[n]);
+    for (int u = 0; u < n; u++) {
+        for (const Arc& arc : up[u]) {
+            upTarget.push_back(arc.to);
+            upWeight.push_back(arc.weight);
+            upMiddle.push_back(arc.middle);
+        }
+    }
+
+    graph = &g;
+    graphFingerprint = g.fingerprint();
+}
+
+int ContractionHierarchy::findUpEdge(int from, int to) const {
+    // La arista vive en el extremo de menor rango
+    int low = rank[from] < rank[to] ? from : to;
+    int high = low == from ? to : from;
+    for (int e = upFirst[low]; e < upFirst[low + 1]; e++) {
+        if (upTarget[e] == high) return e;
+    }
+    return -1;
+}
+
+void ContractionHierarchy::unpackEdge(int from, int to, int middle, std::vector<int>& out) const {
+    if (middle == -1) {
+        out.push_back(to);
+        return;
+    }
+    // El nodo intermedio tiene menor rango que ambos extremos
+    unpackEdge(from, middle, upMiddle[findUpEdge(middle, from)], out);
+    unpackEdge(middle, to, upMiddle[findUpEdge(middle, to)], out);
+}
+
+Route ContractionHierarchy::findPath(const Point& start, const Point& end) const {
+    EdgeSnap source, target;
+    if (!graph || !graph->snapToEdge(start, source) || !graph->snapToEdge(end, target)) {
+        return Route();
+    }
+
+    // Un espacio por lado, propios del hilo: consultas concurrentes sin bloqueo
+    SearchWorkspace* ws[2] = {&SearchWorkspace::forThread(0), &SearchWorkspace::forThread(1)};
+    ws[0]->prepare((int)rank.size());
+    ws[1]->prepare((int)rank.size());
+
+    // Semillas: extremos de la arista de origen (lado 0) y de destino (lado 1)
+    const EdgeSnap* snaps[2] = {&source, &target};
+    for (int side = 0; side < 2; side++) {
+        const EdgeSnap& s = *snaps[side];
+        double w = graph->getEdgeWeight(s.edge);
+        double costs[2] = {s.t * w, (1 - s.t) * w};
+        int ends[2] = {s.from, s.to};
+        for (int k = 0; k < 2; k++) {
+            ws[side]->relax(ends[k], costs[k], costs[k], -1);
+        }
+    }
+
+    // Origen y destino sobre la misma arista: camino directo (meet = -1)
+    double best = INF;
+    int meet = -1;
+    if (source.edge == target.edge) {
+        best = std::fabs(source.t - target.t) * graph->getEdgeWeight(source.edge);
+    }
+
+    // Búsqueda bidireccional ascendente; cada lado se detiene cuando su
+    // mínimo ya no puede mejorar la mejor ruta encontrada
+    int settled = 0;
+    bool done[2] = {false, false};
+    while (true) {
+        for (int k = 0; k < 2; k++) {
+            if (ws[k]->empty() || ws[k]->topKey() >= best) done[k] = true;
+        }
+        if (done[0] && done[1]) break;
+
+        int side = done[1] || (!done[0] && ws[0]->topKey() <= ws[1]->topKey()) ? 0 : 1;
+        int u = ws[side]->pop();
+        double d = ws[side]->distance(u);
+        settled++;
+
+        double other = ws[1 - side]->distance(u);
+        if (other != INF && d + other < best) {
+            best = d + other;
+            meet = u;
+        }
+
+        // Stall-on-demand: si bajando desde un vecino de mayor rango ya
+        // alcanzado se llega a u más barato, d no es su distancia real y
+        // las rutas que sigan por u no pueden ser las más cortas
+        bool stalled = false;
+        for (int e = upFirst[u]; e < upFirst[u + 1] && !stalled; e++) {
+            stalled = ws[side]->distance(upTarget[e]) + upWeight[e] < d;
+        }
+        if (stalled) continue;
+
+        for (int e = upFirst[u]; e < upFirst[u + 1]; e++) {
+            int v = upTarget[e];
+            double nd = d + upWeight[e];
+            ws[side]->relax(v, nd, nd, u);
+        }
+    }
+
+    if (best == INF) {
+        Route none;
+        none.settledNodes = settled;
+        return none;
+    }
+
+    Route route;
+    route.found = true;
+    route.settledNodes = settled;
+    route.totalDistance = best;
+
+    if (meet != -1) {
+        // Nodos del grafo jerárquico: semilla de origen -> meet -> semilla de destino
+        std::vector<int> chain;
+        for (int v = meet; v != -1; v = ws[0]->predecessor(v)) chain.push_back(v);
+        std::reverse(chain.begin(), chain.end());
+        for (int v = ws[1]->predecessor(meet); v != -1; v = ws[1]->predecessor(v)) chain.push_back(v);
+
+        // Desempaquetar los atajos
+        route.nodeIds.push_back(chain[0]);
+        for (size_t i = 0; i + 1 < chain.size(); i++) {
+            int e = findUpEdge(chain[i], chain[i + 1]);
+            unpackEdge(chain[i], chain[i + 1], upMiddle[e], route.nodeIds);
+        }
+    }
+
+    graph->buildRoutePath(source, target, route);
+    return route;
+}
+
+bool ContractionHierarchy::save(const std::string& filename) const {
+    if (!isReady()) return false;
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    uint8_t header[8] = {0};
+    std::memcpy(header, CH_MAGIC, 6);
+    header[6] = CH_VERSION;
+    uint32_t nodeCount = (uint32_t)rank.size();
+    uint32_t edgeCount = (uint32_t)upTarget.size();
+    uint32_t shortcuts = (uint32_t)shortcutCount;
+
+    file.write((const char*)header, sizeof(header));
+    file.write((const char*)&nodeCount, sizeof(nodeCount));
+    file.write((const char*)&edgeCount, sizeof(edgeCount));
+    file.write((const char*)&shortcuts, sizeof(shortcuts));
+    file.write((const char*)&graphFingerprint, sizeof(graphFingerprint));
+
+    writeArray(file, rank);
+    writeArray(file, upFirst);
+    writeArray(file, upTarget);
+    writeArray(file, upWeight);
+    writeArray(file, upMiddle);
+    return file.good();
+}
+
+bool ContractionHierarchy::load(const std::string& filename, const Graph& g) {
+    clear();
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    uint8_t header[8];
+    uint32_t nodeCount = 0, edgeCount = 0, shortcuts = 0;
+    uint64_t storedFingerprint = 0;
+    if (!file.read((char*)header, sizeof(header)) ||
+        std::memcmp(header, CH_MAGIC, 6) != 0 || header[6] != CH_VERSION ||
+        !file.read((char*)&nodeCount, sizeof(nodeCount)) ||
+        !file.read((char*)&edgeCount, sizeof(edgeCount)) ||
+        !file.read((char*)&shortcuts, sizeof(shortcuts)) ||
+        !file.read((char*)&storedFingerprint, sizeof(storedFingerprint))) {
+        return false;
+    }
+
+    // Sólo sirve para el grafo con el que se construyó
+    if (nodeCount != (uint32_t)g.getNodeCount() || storedFingerprint != g.fingerprint()) {
+        return false;
+    }
+
+    if (!readArray(file, rank, nodeCount) ||
+        !readArray(file, upFirst, (size_t)nodeCount + 1) ||
+        !readArray(file, upTarget, edgeCount) ||
+        !readArray(file, upWeight, edgeCount) ||
+        !readArray(file, upMiddle, edgeCount) ||
+        upFirst.front() != 0 || upFirst.back() != (int)edgeCount) {
+        clear();
+        return false;
+    }
+
+    for (uint32_t u = 0; u < nodeCount; u++) {
+        if (upFirst[u] > upFirst[u + 1] || rank[u] < 0 || rank[u] >= (int)nodeCount) {
+            clear();
+            return false;
+        }
+    }
+    for (uint32_t e = 0; e < edgeCount; e++) {
+        if (upTarget[e] < 0 || upTarget[e] >= (int)nodeCount ||
+            upMiddle[e] < -1 || upMiddle[e] >= (int)nodeCount) {
+            clear();
+            return false;
+        }
+    }
+
+    shortcutCount = (int)shortcuts;
+    graphFingerprint = storedFingerprint;
+    graph = &g;
+    return true;
+}
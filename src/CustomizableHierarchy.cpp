@@ -0,0 +1,378 @@
+#include "../include/CustomizableHierarchy.h"
+#include "../include/Parallel.h"
+#include "../include/SearchWorkspace.h"
+#include <cmath>
+#include <limits>
+#include <iterator>
+#include <algorithm>
+
+namespace {
+
+const double INF = std::numeric_limits<double>::max();
+
+// Tramo cerrado: peso infinito, NaN o DBL_MAX (ver CustomizableHierarchy.h)
+inline bool isClosed(double w) { return !std::isfinite(w) || w >= INF; }
+
+// Las partes de este tamaño o menos ya no se cortan
+const size_t DISSECTION_LEAF = 16;
+
+// Disección anidada: las dos mitades primero, el separador al final (arriba)
+struct Dissection {
+    const Graph& g;
+    std::vector<int> mark;  // Lado de cada nodo en el corte en curso
+    int nextMark;
+    std::vector<int>& order;
+
+    Dissection(const Graph& graph, std::vector<int>& out)
+        : g(graph), mark(graph.getNodeCount(), -1), nextMark(0), order(out) {}
+
+    // Clave del nodo en una de las cuatro direcciones de corte
+    double key(int v, int dir) const {
+        Point p = g.getMetricPosition(v);
+        switch (dir) {
+            case 0: return p.x;
+            case 1: return p.y;
+            case 2: return p.x + p.y;
+            default: return p.x - p.y;
+        }
+    }
+
+    // Corta por la mediana en 'dir'; devuelve el separador (la frontera del
+    // lado más chica) y deja en a y b los nodos de cada lado sin separador
+    void split(std::vector<int>& nodes, int dir, std::vector<int>* a, std::vector<int>* b,
+               std::vector<int>& separator) {
+        size_t half = nodes.size() / 2;
+        std::nth_element(nodes.begin(), nodes.begin() + half, nodes.end(),
+                         [&](int u, int v) { return key(u, dir) < key(v, dir); });
+
+        int markA = nextMark++, markB = nextMark++;
+        for (size_t i = 0; i < nodes.size(); i++) mark[nodes[i]] = i < half ? markA : markB;
+
+        std::vector<int> borderA, borderB;
+        for (size_t i = 0; i < nodes.size(); i++) {
+            int v = nodes[i];
+            int other = i < half ? markB : markA;
+            for (int e = g.getEdgeBegin(v); e < g.getEdgeEnd(v); e++) {
+                if (mark[g.getEdgeTarget(e)] == other) {
+                    (i < half ? borderA : borderB).push_back(v);
+                    break;
+                }
+            }
+        }
+        bool cutA = borderA.size() <= borderB.size();
+        separator.swap(cutA ? borderA : borderB);
+        if (!a) return;
+
+        for (int v : separator) mark[v] = -1;
+        a->clear();
+        b->clear();
+        for (int v : nodes) {
+            if (mark[v] != -1) (mark[v] == markA ? a : b)->push_back(v);
+        }
+    }
+
+    void run(std::vector<int>& nodes) {
+        if (nodes.size() <= DISSECTION_LEAF) {
+            order.insert(order.end(), nodes.begin(), nodes.end());
+            return;
+        }
+
+        // La dirección con el separador más chico
+        int bestDir = 0;
+        size_t bestSize = 0;
+        std::vector<int> separator;
+        for (int dir = 0; dir < 4; dir++) {
+            split(nodes, dir, nullptr, nullptr, separator);
+            if (dir == 0 || separator.size() < bestSize) {
+                bestDir = dir;
+                bestSize = separator.size();
+            }
+        }
+
+        std::vector<int> a, b;
+        split(nodes, bestDir, &a, &b, separator);
+        std::vector<int>().swap(nodes);
+        run(a);
+        run(b);
+        order.insert(order.end(), separator.begin(), separator.end());
+    }
+};
+
+} // namespace
+
+CustomizableHierarchy::CustomizableHierarchy()
+    : graph(nullptr), triangleCount(0), metricVersion(0), threadCount(0) {}
+
+void CustomizableHierarchy::clear() {
+    graph = nullptr;
+    order.clear();
+    rank.clear();
+    upFirst.clear();
+    upTarget.clear();
+    upSource.clear();
+    inputArc.clear();
+    downFirst.clear();
+    downArc.clear();
+    triangleCount = 0;
+    levelFirst.clear();
+    levelNodes.clear();
+    std::atomic_store(&current, std::shared_ptr<const Metric>());
+}
+
+void CustomizableHierarchy::computeOrder(const Graph& g) {
+    int n = g.getNodeCount();
+    std::vector<int> nodes(n);
+    for (int v = 0; v < n; v++) nodes[v] = v;
+
+    order.clear();
+    order.reserve(n);
+    Dissection dissection(g, order);
+    dissection.run(nodes);
+
+    rank.assign(n, -1);
+    for (int r = 0; r < n; r++) rank[order[r]] = r;
+}
+
+void CustomizableHierarchy::prepare(const Graph& g) {
+    clear();
+    int n = g.getNodeCount();
+    if (n == 0) return;
+
+    computeOrder(g);
+
+    // Vecinos de mayor rango de cada rango, sin repetidos
+    std::vector<std::vector<int>> up(n);
+    for (int v = 0; v < n; v++) {
+        int r = rank[v];
+        for (int e = g.getEdgeBegin(v); e < g.getEdgeEnd(v); e++) {
+            int t = rank[g.getEdgeTarget(e)];
+            if (t > r) up[r].push_back(t);
+        }
+        std::sort(up[r].begin(), up[r].end());
+        up[r].erase(std::unique(up[r].begin(), up[r].end()), up[r].end());
+    }
+
+    // Contracción sin testigos: los vecinos de r quedan conectados entre sí.
+    // Basta pasarlos al menor de ellos (su padre en el árbol de eliminación)
+    std::vector<int> merged;
+    for (int r = 0; r < n; r++) {
+        if (up[r].size() < 2) continue;
+        std::vector<int>& parent = up[up[r][0]];
+        merged.clear();
+        std::set_union(parent.begin(), parent.end(), up[r].begin() + 1, up[r].end(),
+                       std::back_inserter(merged));
+        parent.swap(merged);
+    }
+
+    upFirst.assign(n + 1, 0);
+    for (int r = 0; r < n; r++) upFirst[r + 1] = upFirst[r] + (int)up[r].size();
+    upTarget.reserve(upFirst[n]);
+    upSource.reserve(upFirst[n]);
+    for (int r = 0; r < n; r++) {
+        upTarget.insert(upTarget.end(), up[r].begin(), up[r].end());
+        upSource.insert(upSource.end(), up[r].size(), r);
+        std::vector<int>().swap(up[r]);
+    }
+
+    // Arco de cada arista del grafo (las paralelas comparten arco)
+    inputArc.assign(g.getEdgeCount(), -1);
+    for (int v = 0; v < n; v++) {
+        for (int e = g.getEdgeBegin(v); e < g.getEdgeEnd(v); e++) {
+            if (!g.isForwardEdge(e)) continue;
+            int a = rank[v], b = rank[g.getEdgeTarget(e)];
+            if (a != b) inputArc[g.getEdgeId(e)] = findArc(std::min(a, b), std::max(a, b));
+        }
+    }
+
+    // Arcos entrantes de cada rango; cada par de vecinos ascendentes de un
+    // nodo es un triángulo inferior
+    int arcs = (int)upTarget.size();
+    downFirst.assign(n + 1, 0);
+    for (int a = 0; a < arcs; a++) downFirst[upTarget[a] + 1]++;
+    for (int r = 0; r < n; r++) downFirst[r + 1] += downFirst[r];
+    downArc.resize(arcs);
+    std::vector<int> cursor(downFirst.begin(), downFirst.end() - 1);
+    for (int a = 0; a < arcs; a++) downArc[cursor[upTarget[a]]++] = a;
+    triangleCount = 0;
+    for (int r = 0; r < n; r++) {
+        long long degree = upFirst[r + 1] - upFirst[r];
+        triangleCount += degree * (degree - 1) / 2;
+    }
+
+    // Nivel = 1 + el mayor nivel de los nodos de abajo: los arcos de un
+    // nivel sólo dependen de arcos de niveles anteriores
+    std::vector<int> level(n, 0);
+    int levels = 0;
+    for (int r = 0; r < n; r++) {
+        for (int a = upFirst[r]; a < upFirst[r + 1]; a++) {
+            level[upTarget[a]] = std::max(level[upTarget[a]], level[r] + 1);
+        }
+        levels = std::max(levels, level[r] + 1);
+    }
+    levelFirst.assign(levels + 1, 0);
+    for (int r = 0; r < n; r++) levelFirst[level[r] + 1]++;
+    for (int l = 0; l < levels; l++) levelFirst[l + 1] += levelFirst[l];
+    levelNodes.resize(n);
+    cursor.assign(levelFirst.begin(), levelFirst.end() - 1);
+    for (int r = 0; r < n; r++) levelNodes[cursor[level[r]]++] = r;
+
+    graph = &g;
+}
+
+int CustomizableHierarchy::findArc(int low, int high) const {
+    auto begin = upTarget.begin() + upFirst[low];
+    auto end = upTarget.begin() + upFirst[low + 1];
+    auto it = std::lower_bound(begin, end, high);
+    return it != end && *it == high ? (int)(it - upTarget.begin()) : -1;
+}
+
+bool CustomizableHierarchy::customize(const std::vector<double>& weights) {
+    if (!graph || (int)weights.size() != graph->getEdgeCount()) return false;
+
+    std::shared_ptr<Metric> m(new Metric());
+    m->edgeWeight = weights;
+    m->upWeight.assign(upTarget.size(), INF);
+    m->upMiddle.assign(upTarget.size(), -1);
+
+    // Peso inicial: la arista original (la menor si hay paralelas)
+    for (size_t id = 0; id < weights.size(); id++) {
+        int arc = inputArc[id];
+        if (arc != -1 && !isClosed(weights[id]) && weights[id] < m->upWeight[arc]) {
+            m->upWeight[arc] = weights[id];
+        }
+    }
+
+    // Cada nodo actualiza sólo sus arcos ascendentes: sin carreras en un nivel.
+    // slot[v] = arco u -> v del nodo en curso (cada hilo tiene el suyo)
+    double* weight = m->upWeight.data();
+    int* middle = m->upMiddle.data();
+    int threads = resolveThreadCount(threadCount);
+    std::vector<std::vector<int>> slots(threads, std::vector<int>(order.size(), -1));
+    for (size_t l = 0; l + 1 < levelFirst.size(); l++) {
+        int count = levelFirst[l + 1] - levelFirst[l];
+        parallelForThreads(count, std::min(threads, count), [&](int i, int thread) {
+            int u = levelNodes[levelFirst[l] + i];
+            std::vector<int>& slot = slots[thread];
+            for (int a = upFirst[u]; a < upFirst[u + 1]; a++) slot[upTarget[a]] = a;
+
+            // Triángulo w -> u -> v: w -> v está después de w -> u (destinos por rango)
+            for (int k = downFirst[u]; k < downFirst[u + 1]; k++) {
+                int low = downArc[k];
+                if (weight[low] == INF) continue;
+                int w = upSource[low];
+                for (int high = low + 1; high < upFirst[w + 1]; high++) {
+                    if (weight[high] == INF) continue;
+                    int a = slot[upTarget[high]];
+                    double total = weight[low] + weight[high];
+                    if (total < weight[a]) {
+                        weight[a] = total;
+                        middle[a] = w;
+                    }
+                }
+            }
+        });
+    }
+
+    m->version = ++metricVersion;
+    std::atomic_store(&current, std::shared_ptr<const Metric>(m));
+    return true;
+}
+
+std::shared_ptr<const CustomizableHierarchy::Metric> CustomizableHierarchy::getMetric() const {
+    return std::atomic_load(&current);
+}
+
+void CustomizableHierarchy::unpackArc(const Metric& m, int from, int to, std::vector<int>& out) const {
+    int arc = findArc(std::min(from, to), std::max(from, to));
+    int mid = m.upMiddle[arc];
+    if (mid == -1) {
+        out.push_back(order[to]);
+        return;
+    }
+    // El nodo del triángulo tiene menor rango que ambos extremos
+    unpackArc(m, from, mid, out);
+    unpackArc(m, mid, to, out);
+}
+
+Route CustomizableHierarchy::findPath(const Point& start, const Point& end) const {
+    // La métrica se fija al empezar: una personalización en paralelo no la cambia
+    std::shared_ptr<const Metric> m = getMetric();
+    EdgeSnap source, target;
+    if (!m || !graph->snapToEdge(start, source) || !graph->snapToEdge(end, target)) {
+        return Route();
+    }
+    const double* weight = m->upWeight.data();
+
+    SearchWorkspace* ws[2] = {&SearchWorkspace::forThread(0), &SearchWorkspace::forThread(1)};
+    ws[0]->prepare((int)order.size());
+    ws[1]->prepare((int)order.size());
+
+    // Semillas con el costo parcial de la métrica sobre la arista de cada
+    // extremo. Sobre un tramo cerrado sólo sirve un extremo justo en un nodo
+    // (un clic en la esquina): se sale de él por las demás calles
+    const EdgeSnap* snaps[2] = {&source, &target};
+    for (int side = 0; side < 2; side++) {
+        const EdgeSnap& s = *snaps[side];
+        double w = m->edgeWeight[graph->getEdgeId(s.edge)];
+        if (isClosed(w)) {
+            if (s.t <= 0) ws[side]->relax(rank[s.from], 0, 0, -1);
+            if (s.t >= 1) ws[side]->relax(rank[s.to], 0, 0, -1);
+            continue;
+        }
+        ws[side]->relax(rank[s.from], s.t * w, s.t * w, -1);
+        ws[side]->relax(rank[s.to], (1 - s.t) * w, (1 - s.t) * w, -1);
+    }
+
+    double best = INF;
+    int meet = -1;
+    double sourceWeight = m->edgeWeight[graph->getEdgeId(source.edge)];
+    if (source.edge == target.edge && !isClosed(sourceWeight)) {
+        best = std::fabs(source.t - target.t) * sourceWeight;
+    }
+
+    // Búsqueda bidireccional ascendente, como en ContractionHierarchy
+    int settled = 0;
+    bool done[2] = {false, false};
+    while (true) {
+        for (int k = 0; k < 2; k++) {
+            if (ws[k]->empty() || ws[k]->topKey() >= best) done[k] = true;
+        }
+        if (done[0] && done[1]) break;
+
+        int side = done[1] || (!done[0] && ws[0]->topKey() <= ws[1]->topKey()) ? 0 : 1;
+        int u = ws[side]->pop();
+        double d = ws[side]->distance(u);
+        settled++;
+
+        double other = ws[1 - side]->distance(u);
+        if (other != INF && d + other < best) {
+            best = d + other;
+            meet = u;
+        }
+
+        for (int a = upFirst[u]; a < upFirst[u + 1]; a++) {
+            if (weight[a] == INF) continue;
+            double nd = d + weight[a];
+            ws[side]->relax(upTarget[a], nd, nd, u);
+        }
+    }
+
+    Route route;
+    route.settledNodes = settled;
+    if (best == INF) return route;
+
+    route.found = true;
+    route.totalDistance = best;
+    if (meet != -1) {
+        std::vector<int> chain;
+        for (int r = meet; r != -1; r = ws[0]->predecessor(r)) chain.push_back(r);
+        std::reverse(chain.begin(), chain.end());
+        for (int r = ws[1]->predecessor(meet); r != -1; r = ws[1]->predecessor(r)) chain.push_back(r);
+
+        route.nodeIds.push_back(order[chain[0]]);
+        for (size_t i = 0; i + 1 < chain.size(); i++) unpackArc(*m, chain[i], chain[i + 1], route.nodeIds);
+    }
+
+    graph->buildRoutePath(source, target, route, &m->edgeWeight);
+    return route;
+}
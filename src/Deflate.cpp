@@ -0,0 +1,203 @@
+#include "../include/Deflate.h"
+#include <algorithm>
+
+namespace {
+const int WINDOW = 32768;
+const int MIN_MATCH = 3;
+const int MAX_MATCH = 258;
+const int HASH_BITS = 15;
+const int MAX_CHAIN = 16;    // Candidatos revisados por posición
+const int NICE_MATCH = 32;   // Largo que corta la búsqueda de candidatos
+const int LAZY_INSERT = 32;  // Largo desde el que no se indexa dentro de la coincidencia
+
+const int LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                             31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const int LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                              2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const int DIST_BASE[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                           33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                           1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const int DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                            6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Escritura de bits desde el menos significativo, como pide DEFLATE
+class BitWriter {
+private:
+    std::vector<uint8_t>& out;
+    uint32_t buffer;
+    int count;
+
+public:
+    explicit BitWriter(std::vector<uint8_t>& o) : out(o), buffer(0), count(0) {}
+
+    void put(uint32_t bits, int n) {
+        buffer |= bits << count;
+        count += n;
+        while (count >= 8) {
+            out.push_back((uint8_t)buffer);
+            buffer >>= 8;
+            count -= 8;
+        }
+    }
+
+    // Los códigos Huffman van con el bit más significativo primero
+    void putCode(uint32_t code, int n) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < n; i++) reversed |= ((code >> i) & 1) << (n - 1 - i);
+        put(reversed, n);
+    }
+
+    void flush() {
+        if (count > 0) out.push_back((uint8_t)buffer);
+        buffer = 0;
+        count = 0;
+    }
+};
+
+// Códigos fijos de literal/longitud (RFC 1951, 3.2.6), ya invertidos para
+// escribirlos con put
+struct FixedCodes {
+    uint16_t code[288];
+    uint8_t length[288];
+
+    FixedCodes() {
+        for (int symbol = 0; symbol < 288; symbol++) {
+            uint32_t c;
+            int n;
+            if (symbol < 144) { c = 0x30 + symbol; n = 8; }
+            else if (symbol < 256) { c = 0x190 + symbol - 144; n = 9; }
+            else if (symbol < 280) { c = symbol - 256; n = 7; }
+            else { c = 0xC0 + symbol - 280; n = 8; }
+
+            uint32_t reversed = 0;
+            for (int i = 0; i < n; i++) reversed |= ((c >> i) & 1) << (n - 1 - i);
+            code[symbol] = (uint16_t)reversed;
+            length[symbol] = (uint8_t)n;
+        }
+    }
+};
+
+void putLiteral(BitWriter& bits, int symbol) {
+    static const FixedCodes fixed;
+    bits.put(fixed.code[symbol], fixed.length[symbol]);
+}
+
+void putMatch(BitWriter& bits, int length, int distance) {
+    int l = (int)(std::upper_bound(LENGTH_BASE, LENGTH_BASE + 29, length) - LENGTH_BASE) - 1;
+    putLiteral(bits, 257 + l);
+    if (LENGTH_EXTRA[l]) bits.put(length - LENGTH_BASE[l], LENGTH_EXTRA[l]);
+
+    int d = (int)(std::upper_bound(DIST_BASE, DIST_BASE + 30, distance) - DIST_BASE) - 1;
+    bits.putCode(d, 5);
+    if (DIST_EXTRA[d]) bits.put(distance - DIST_BASE[d], DIST_EXTRA[d]);
+}
+
+inline uint32_t hash3(const uint8_t* p) {
+    return ((uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2]) * 2654435761u >> (32 - HASH_BITS);
+}
+}
+
+void deflateZlib(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    out.clear();
+    out.reserve(size / 4 + 64);
+    out.push_back(0x78);  // Método 8, ventana de 32 KB
+    out.push_back(0x01);  // Sin diccionario; (0x7801 % 31) == 0
+
+    // Un único bloque final con códigos fijos
+    BitWriter bits(out);
+    bits.put(1, 1);
+    bits.put(1, 2);
+
+    // head[h] = última posición con ese hash + 1 (0 = ninguna);
+    // prev[pos % WINDOW] = la anterior con el mismo hash
+    std::vector<uint32_t> head((size_t)1 << HASH_BITS, 0);
+    std::vector<uint32_t> prev(WINDOW, 0);
+    auto insert = [&](size_t pos) {
+        uint32_t h = hash3(data + pos);
+        prev[pos % WINDOW] = head[h];
+        head[h] = (uint32_t)pos + 1;
+    };
+
+    size_t pos = 0;
+    while (pos < size) {
+        int bestLength = 0, bestDistance = 0;
+        if (pos + MIN_MATCH <= size) {
+            int maxLength = (int)std::min((size_t)MAX_MATCH, size - pos);
+            uint32_t candidate = head[hash3(data + pos)];
+            for (int chain = 0; candidate > 0 && chain < MAX_CHAIN; chain++) {
+                size_t from = candidate - 1;
+                if (pos - from > WINDOW) break;
+
+                // Sólo puede mejorar si coincide en el byte que rompería la mejor
+                if (bestLength == 0 || data[from + bestLength] == data[pos + bestLength]) {
+                    int length = 0;
+                    while (length < maxLength && data[from + length] == data[pos + length]) length++;
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestDistance = (int)(pos - from);
+                        if (length >= NICE_MATCH || length == maxLength) break;
+                    }
+                }
+
+                uint32_t next = prev[from % WINDOW];
+                if (next == 0 || next - 1 >= from) break;  // La entrada ya fue pisada
+                candidate = next;
+            }
+        }
+
+        if (bestLength >= MIN_MATCH) {
+            putMatch(bits, bestLength, bestDistance);
+
+            // Dentro de coincidencias largas (fondo liso) basta registrar
+            // el final: insertar cada posición casi no mejora la razón
+            size_t end = pos + bestLength;
+            if (bestLength > LAZY_INSERT) pos = end - MIN_MATCH;
+            for (; pos < end; pos++) {
+                if (pos + MIN_MATCH <= size) insert(pos);
+            }
+        } else {
+            putLiteral(bits, data[pos]);
+            if (pos + MIN_MATCH <= size) insert(pos);
+            pos++;
+        }
+    }
+    putLiteral(bits, 256);  // Fin de bloque
+    bits.flush();
+
+    // Datos que no se comprimen (ruido, teselas ya muy variadas): como zlib,
+    // si el bloque con códigos queda más grande, van en bloques sin
+    // comprimir (BTYPE 00) de hasta 65535 bytes con 5 bytes de cabecera
+    const size_t STORED_MAX = 65535;
+    size_t blocks = std::max((size_t)1, (size_t)(size + STORED_MAX - 1) / STORED_MAX);
+    if (out.size() - 2 > size + 5 * blocks) {
+        out.resize(2);
+        size_t start = 0;
+        for (size_t i = 0; i < blocks; i++) {
+            size_t length = std::min(STORED_MAX, size - start);
+            out.push_back(i + 1 == blocks ? 1 : 0);  // BFINAL, BTYPE 00; ya alineado a byte
+            out.push_back((uint8_t)length);
+            out.push_back((uint8_t)(length >> 8));
+            out.push_back((uint8_t)~length);
+            out.push_back((uint8_t)(~length >> 8));
+            out.insert(out.end(), data + start, data + start + length);
+            start += length;
+        }
+    }
+
+    // Adler-32 reduciendo cada 5552 bytes (lo más que se suma sin desbordar)
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < size;) {
+        size_t end = std::min(size, i + 5552);
+        for (; i < end; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    uint32_t adler = (b << 16) | a;
+    out.push_back((uint8_t)(adler >> 24));
+    out.push_back((uint8_t)(adler >> 16));
+    out.push_back((uint8_t)(adler >> 8));
+    out.push_back((uint8_t)adler);
+}
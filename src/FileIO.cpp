@@ -0,0 +1,210 @@
+#include "../include/FileIO.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+#ifdef _WIN32
+
+RandomAccessFile::RandomAccessFile() : handle(INVALID_HANDLE_VALUE), fileSize(0) {}
+
+bool RandomAccessFile::open(const std::string& filename) {
+    close();
+    handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER li;
+    if (!GetFileSizeEx(handle, &li)) {
+        close();
+        return false;
+    }
+    fileSize = (uint64_t)li.QuadPart;
+    return true;
+}
+
+void RandomAccessFile::close() {
+    if (handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(handle);
+        handle = INVALID_HANDLE_VALUE;
+    }
+    fileSize = 0;
+}
+
+bool RandomAccessFile::isOpen() const {
+    return handle != INVALID_HANDLE_VALUE;
+}
+
+bool RandomAccessFile::readAt(uint64_t offset, void* buffer, size_t size) const {
+    char* out = (char*)buffer;
+    while (size > 0) {
+        OVERLAPPED ov = {0};
+        ov.Offset = (DWORD)(offset & 0xffffffff);
+        ov.OffsetHigh = (DWORD)(offset >> 32);
+
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : (DWORD)size;
+        DWORD read = 0;
+        if (!ReadFile(handle, out, chunk, &read, &ov) || read == 0) return false;
+
+        out += read;
+        offset += read;
+        size -= read;
+    }
+    return true;
+}
+
+MappedFile::MappedFile()
+    : handle(INVALID_HANDLE_VALUE), mapping(NULL), base(nullptr), fileSize(0) {}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+    handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER li;
+    if (!GetFileSizeEx(handle, &li) || li.QuadPart == 0) {
+        close();
+        return false;
+    }
+
+    // PAGE_WRITECOPY + FILE_MAP_COPY: copia privada al escribir
+    mapping = CreateFileMappingA(handle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (mapping == NULL) {
+        close();
+        return false;
+    }
+    base = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (base == nullptr) {
+        close();
+        return false;
+    }
+    fileSize = (uint64_t)li.QuadPart;
+    return true;
+}
+
+void MappedFile::close() {
+    if (base) {
+        UnmapViewOfFile(base);
+        base = nullptr;
+    }
+    if (mapping != NULL) {
+        CloseHandle(mapping);
+        mapping = NULL;
+    }
+    if (handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(handle);
+        handle = INVALID_HANDLE_VALUE;
+    }
+    fileSize = 0;
+}
+
+#else
+
+RandomAccessFile::RandomAccessFile() : fd(-1), fileSize(0) {}
+
+bool RandomAccessFile::open(const std::string& filename) {
+    close();
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close();
+        return false;
+    }
+    fileSize = (uint64_t)st.st_size;
+    return true;
+}
+
+void RandomAccessFile::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    fileSize = 0;
+}
+
+bool RandomAccessFile::isOpen() const {
+    return fd >= 0;
+}
+
+bool RandomAccessFile::readAt(uint64_t offset, void* buffer, size_t size) const {
+    char* out = (char*)buffer;
+    while (size > 0) {
+        ssize_t read = pread(fd, out, size, (off_t)offset);
+        if (read <= 0) return false;
+
+        out += read;
+        offset += read;
+        size -= read;
+    }
+    return true;
+}
+
+MappedFile::MappedFile() : base(nullptr), fileSize(0) {}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    // El mapeo sigue vivo después de cerrar el descriptor
+    struct stat st;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        view = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+
+    base = (uint8_t*)view;
+    fileSize = (uint64_t)st.st_size;
+    return true;
+}
+
+void MappedFile::close() {
+    if (base) {
+        munmap(base, (size_t)fileSize);
+        base = nullptr;
+    }
+    fileSize = 0;
+}
+
+#endif
+
+RandomAccessFile::~RandomAccessFile() {
+    close();
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool createDirectories(const std::string& path) {
+    // Cada prefijo hasta un separador, y la ruta completa al final
+    for (size_t i = 1; i <= path.size(); i++) {
+        if (i < path.size() && path[i] != '/' && path[i] != '\\') continue;
+        std::string prefix = path.substr(0, i);
+        if (prefix.empty() || prefix[prefix.size() - 1] == ':') continue;  // Unidad "C:"
+#ifdef _WIN32
+        _mkdir(prefix.c_str());
+#else
+        mkdir(prefix.c_str(), 0755);
+#endif
+    }
+
+#ifdef _WIN32
+    DWORD attributes = GetFileAttributesA(path.c_str());
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+}
@@ -0,0 +1,119 @@
+#include "../include/GdiBackend.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+POINT toPixel(const Point& p) {
+    POINT pixel;
+    pixel.x = (LONG)std::lround(p.x);
+    pixel.y = (LONG)std::lround(p.y);
+    return pixel;
+}
+}
+
+GdiBackend::GdiBackend(HWND window, int w, int h) : width(w), height(h) {
+    HDC hdc = GetDC(window);
+    memDC = CreateCompatibleDC(hdc);
+    memBitmap = CreateCompatibleBitmap(hdc, width, height);
+    previousBitmap = SelectObject(memDC, memBitmap);
+    ReleaseDC(window, hdc);
+}
+
+GdiBackend::~GdiBackend() {
+    SelectObject(memDC, previousBitmap);
+    DeleteObject(memBitmap);
+    DeleteDC(memDC);
+}
+
+HPEN GdiBackend::createPen(const Pen& pen) const {
+    if (!pen.isVisible()) return (HPEN)GetStockObject(NULL_PEN);
+    int w = std::max(1, (int)std::lround(pen.width));
+    return CreatePen(pen.dashed ? PS_DASH : PS_SOLID, w, RGB(pen.color.r, pen.color.g, pen.color.b));
+}
+
+void GdiBackend::clear(const Color& background) {
+    RECT rect = {0, 0, width, height};
+    HBRUSH brush = CreateSolidBrush(RGB(background.r, background.g, background.b));
+    FillRect(memDC, &rect, brush);
+    DeleteObject(brush);
+}
+
+void GdiBackend::drawPolyline(const Point* points, int count, const Pen& pen) {
+    if (!pen.isVisible() || count < 2) return;
+
+    std::vector<POINT> pixels(count);
+    for (int i = 0; i < count; i++) pixels[i] = toPixel(points[i]);
+
+    HPEN gdiPen = createPen(pen);
+    HPEN oldPen = (HPEN)SelectObject(memDC, gdiPen);
+    Polyline(memDC, pixels.data(), count);
+    SelectObject(memDC, oldPen);
+    DeleteObject(gdiPen);
+}
+
+void GdiBackend::drawPolygon(const Point* points, const int* ringSizes, int ringCount,
+                             const Color& fill, const Pen& outline) {
+    if (ringCount <= 0) return;
+
+    std::vector<POINT> pixels;
+    std::vector<INT> counts(ringSizes, ringSizes + ringCount);
+    size_t total = 0;
+    for (int r = 0; r < ringCount; r++) total += ringSizes[r];
+    pixels.reserve(total);
+    for (size_t i = 0; i < total; i++) pixels.push_back(toPixel(points[i]));
+
+    HBRUSH brush = fill.isVisible() ? CreateSolidBrush(RGB(fill.r, fill.g, fill.b))
+                                    : (HBRUSH)GetStockObject(NULL_BRUSH);
+    HPEN gdiPen = createPen(outline);
+    HBRUSH oldBrush = (HBRUSH)SelectObject(memDC, brush);
+    HPEN oldPen = (HPEN)SelectObject(memDC, gdiPen);
+    int previousMode = SetPolyFillMode(memDC, ALTERNATE);  // Los huecos quedan sin pintar
+
+    PolyPolygon(memDC, pixels.data(), counts.data(), ringCount);
+
+    SetPolyFillMode(memDC, previousMode);
+    SelectObject(memDC, oldBrush);
+    SelectObject(memDC, oldPen);
+    DeleteObject(brush);
+    DeleteObject(gdiPen);
+}
+
+void GdiBackend::drawCircle(const Point& center, double radius, const Color& fill,
+                            const Pen& outline) {
+    POINT c = toPixel(center);
+    int r = (int)std::lround(radius);
+
+    HBRUSH brush = fill.isVisible() ? CreateSolidBrush(RGB(fill.r, fill.g, fill.b))
+                                    : (HBRUSH)GetStockObject(NULL_BRUSH);
+    HPEN gdiPen = createPen(outline);
+    HBRUSH oldBrush = (HBRUSH)SelectObject(memDC, brush);
+    HPEN oldPen = (HPEN)SelectObject(memDC, gdiPen);
+
+    Ellipse(memDC, c.x - r, c.y - r, c.x + r, c.y + r);
+
+    SelectObject(memDC, oldBrush);
+    SelectObject(memDC, oldPen);
+    DeleteObject(brush);
+    DeleteObject(gdiPen);
+}
+
+void GdiBackend::drawText(const Point& topLeft, const std::string& text, double size,
+                          const Color& color) {
+    POINT p = toPixel(topLeft);
+    SetBkMode(memDC, TRANSPARENT);
+    SetTextColor(memDC, RGB(color.r, color.g, color.b));
+    HFONT font = CreateFont((int)std::lround(size), 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE,
+                            DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
+                            ANTIALIASED_QUALITY, DEFAULT_PITCH | FF_DONTCARE, "Arial");
+    HFONT oldFont = (HFONT)SelectObject(memDC, font);
+
+    TextOut(memDC, p.x, p.y, text.c_str(), (int)text.size());
+
+    SelectObject(memDC, oldFont);
+    DeleteObject(font);
+}
+
+void GdiBackend::present(HDC hdc) {
+    BitBlt(hdc, 0, 0, width, height, memDC, 0, 0, SRCCOPY);
+}
@@ -0,0 +1,294 @@
+#include "../include/GeoContainer.h"
+#include "../include/GeoJSONParser.h"
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+// Huecos menores a esto entre features se leen igual para agrupar lecturas
+const uint64_t MERGE_GAP_BYTES = 4096;
+
+template <typename T>
+void put(std::vector<uint8_t>& out, const T& value) {
+    size_t pos = out.size();
+    out.resize(pos + sizeof(T));
+    std::memcpy(out.data() + pos, &value, sizeof(T));
+}
+
+void putBytes(std::vector<uint8_t>& out, const std::string& s) {
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+// Cursor de lectura con verificación de límites
+struct ByteCursor {
+    const uint8_t* cur;
+    const uint8_t* end;
+    bool ok;
+
+    ByteCursor(const uint8_t* data, size_t size) : cur(data), end(data + size), ok(true) {}
+
+    template <typename T>
+    T get() {
+        T value = T();
+        if ((size_t)(end - cur) < sizeof(T)) {
+            ok = false;
+            return value;
+        }
+        std::memcpy(&value, cur, sizeof(T));
+        cur += sizeof(T);
+        return value;
+    }
+
+    std::string getBytes(size_t n) {
+        if ((size_t)(end - cur) < n) {
+            ok = false;
+            return std::string();
+        }
+        std::string s((const char*)cur, n);
+        cur += n;
+        return s;
+    }
+};
+
+// Feature: tipo, id, puntos, ids OSM y atributos
+void encodeFeature(const Geometry& geom, std::vector<uint8_t>& out) {
+    put<uint8_t>(out, (uint8_t)geom.type);
+    put<int32_t>(out, geom.id);
+
+    put<uint32_t>(out, (uint32_t)geom.points.size());
+    for (const auto& p : geom.points) {
+        put<double>(out, p.x);
+        put<double>(out, p.y);
+    }
+
+    put<uint32_t>(out, (uint32_t)geom.nodeIds.size());
+    for (long long id : geom.nodeIds) {
+        put<int64_t>(out, (int64_t)id);
+    }
+
+    put<uint16_t>(out, (uint16_t)std::min<size_t>(geom.properties.size(), 0xffff));
+    for (size_t i = 0; i < geom.properties.size() && i < 0xffff; i++) {
+        const auto& prop = geom.properties[i];
+        put<uint16_t>(out, (uint16_t)prop.first.size());
+        putBytes(out, prop.first);
+        put<uint32_t>(out, (uint32_t)prop.second.size());
+        putBytes(out, prop.second);
+    }
+}
+
+bool decodeFeature(const uint8_t* data, size_t size, Geometry& geom) {
+    ByteCursor c(data, size);
+
+    uint8_t type = c.get<uint8_t>();
+    if (type > GEOM_POLYGON) return false;
+    geom.type = (GeometryType)type;
+    geom.id = c.get<int32_t>();
+
+    uint32_t numPoints = c.get<uint32_t>();
+    if (!c.ok || numPoints > size / 16) return false;
+    geom.points.resize(numPoints);
+    for (auto& p : geom.points) {
+        p.x = c.get<double>();
+        p.y = c.get<double>();
+    }
+
+    uint32_t numIds = c.get<uint32_t>();
+    if (!c.ok || numIds > size / 8) return false;
+    geom.nodeIds.resize(numIds);
+    for (auto& id : geom.nodeIds) {
+        id = (long long)c.get<int64_t>();
+    }
+
+    uint16_t numProps = c.get<uint16_t>();
+    for (uint16_t i = 0; i < numProps && c.ok; i++) {
+        std::string key = c.getBytes(c.get<uint16_t>());
+        std::string value = c.getBytes(c.get<uint32_t>());
+        geom.properties.push_back(std::make_pair(key, value));
+    }
+
+    if (!c.ok) return false;
+    geom.calculateMBR();
+    return true;
+}
+
+} // namespace
+
+// ===== Escritura =====
+
+bool GeoContainerWriter::write(const std::string& filename,
+                               const std::vector<Geometry>& geometries, uint16_t nodeSize) {
+    Rect extent;
+    bool first = true;
+    for (const auto& geom : geometries) {
+        if (geom.points.empty()) continue;
+        if (first) {
+            extent = geom.mbr;
+            first = false;
+        } else {
+            extent.expand(geom.mbr);
+        }
+    }
+
+    // Ordenar por índice de Hilbert del centro del MBR
+    std::vector<std::pair<uint32_t, size_t>> order;
+    for (size_t i = 0; i < geometries.size(); i++) {
+        if (geometries[i].points.empty()) continue;
+        order.push_back(std::make_pair(
+            PackedRTree::hilbertIndex(geometries[i].mbr.center(), extent), i));
+    }
+    std::sort(order.begin(), order.end());
+
+    // Codificar features y armar las hojas del índice
+    std::vector<uint8_t> data;
+    std::vector<PackedRTreeItem> leaves;
+    leaves.reserve(order.size());
+    for (const auto& entry : order) {
+        const Geometry& geom = geometries[entry.second];
+        PackedRTreeItem item;
+        item.box = geom.mbr;
+        item.offset = data.size();
+        leaves.push_back(item);
+        encodeFeature(geom, data);
+    }
+
+    PackedRTree index;
+    index.build(leaves, nodeSize);
+
+    size_t indexSize = PackedRTree::serializedSize(leaves.size(), index.getNodeSize());
+    std::vector<uint8_t> header;
+    header.reserve(GEOCONTAINER_HEADER_SIZE + indexSize);
+    header.insert(header.end(), GEOCONTAINER_MAGIC, GEOCONTAINER_MAGIC + 6);
+    put<uint8_t>(header, GEOCONTAINER_VERSION);
+    put<uint8_t>(header, 0);
+    put<uint32_t>(header, (uint32_t)leaves.size());
+    put<uint16_t>(header, index.getNodeSize());
+    put<uint16_t>(header, 0);
+    put<double>(header, extent.minX);
+    put<double>(header, extent.minY);
+    put<double>(header, extent.maxX);
+    put<double>(header, extent.maxY);
+    put<uint64_t>(header, (uint64_t)indexSize);
+    header.resize(GEOCONTAINER_HEADER_SIZE, 0);
+
+    index.serialize(header);
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) return false;
+    file.write((const char*)header.data(), header.size());
+    file.write((const char*)data.data(), data.size());
+    return file.good();
+}
+
+bool GeoContainerWriter::convertGeoJSON(const std::string& geojsonFile,
+                                        const std::string& containerFile) {
+    GeoJSONParser parser;
+    if (!parser.loadFromFile(geojsonFile)) return false;
+    return write(containerFile, parser.getGeometries());
+}
+
+// ===== Lectura =====
+
+GeoContainerReader::GeoContainerReader()
+    : dataOffset(0), featureCount(0), bytesRead(0) {}
+
+bool GeoContainerReader::open(const std::string& filename) {
+    close();
+    if (!file.open(filename)) return false;
+
+    uint8_t header[GEOCONTAINER_HEADER_SIZE];
+    if (!file.readAt(0, header, sizeof(header)) ||
+        std::memcmp(header, GEOCONTAINER_MAGIC, 6) != 0 ||
+        header[6] != GEOCONTAINER_VERSION) {
+        close();
+        return false;
+    }
+
+    ByteCursor c(header + 8, sizeof(header) - 8);
+    featureCount = c.get<uint32_t>();
+    uint16_t nodeSize = c.get<uint16_t>();
+    c.get<uint16_t>();
+    bounds.minX = c.get<double>();
+    bounds.minY = c.get<double>();
+    bounds.maxX = c.get<double>();
+    bounds.maxY = c.get<double>();
+    uint64_t indexSize = c.get<uint64_t>();
+
+    if (indexSize > file.size() - GEOCONTAINER_HEADER_SIZE) {
+        close();
+        return false;
+    }
+
+    std::vector<uint8_t> indexBytes((size_t)indexSize);
+    if (!file.readAt(GEOCONTAINER_HEADER_SIZE, indexBytes.data(), indexBytes.size()) ||
+        !index.deserialize(indexBytes.data(), indexBytes.size(), featureCount, nodeSize)) {
+        close();
+        return false;
+    }
+
+    dataOffset = GEOCONTAINER_HEADER_SIZE + indexSize;
+    return true;
+}
+
+void GeoContainerReader::close() {
+    file.close();
+    index.clear();
+    dataOffset = 0;
+    featureCount = 0;
+    bounds = Rect();
+}
+
+uint64_t GeoContainerReader::featureEnd(size_t leaf) const {
+    if (leaf + 1 < index.size()) return index.getLeaf(leaf + 1).offset;
+    return file.size() - dataOffset;
+}
+
+bool GeoContainerReader::readFeatures(std::vector<size_t>& leaves, std::vector<Geometry>& out) {
+    bytesRead = 0;
+    std::sort(leaves.begin(), leaves.end());
+
+    std::vector<uint8_t> buffer;
+    size_t i = 0;
+    while (i < leaves.size()) {
+        // Agrupar features contiguas (o casi) en una sola lectura
+        size_t j = i;
+        while (j + 1 < leaves.size() &&
+               index.getLeaf(leaves[j + 1]).offset - featureEnd(leaves[j]) <= MERGE_GAP_BYTES) {
+            j++;
+        }
+
+        uint64_t start = index.getLeaf(leaves[i]).offset;
+        uint64_t end = featureEnd(leaves[j]);
+        buffer.resize((size_t)(end - start));
+        if (!file.readAt(dataOffset + start, buffer.data(), buffer.size())) return false;
+        bytesRead += buffer.size();
+
+        for (size_t k = i; k <= j; k++) {
+            uint64_t fStart = index.getLeaf(leaves[k]).offset;
+            Geometry geom;
+            if (!decodeFeature(buffer.data() + (fStart - start),
+                               (size_t)(featureEnd(leaves[k]) - fStart), geom)) {
+                return false;
+            }
+            out.push_back(std::move(geom));
+        }
+        i = j + 1;
+    }
+    return true;
+}
+
+bool GeoContainerReader::loadAll(std::vector<Geometry>& out) {
+    if (!isOpen()) return false;
+
+    std::vector<size_t> leaves(index.size());
+    for (size_t i = 0; i < leaves.size(); i++) leaves[i] = i;
+    return readFeatures(leaves, out);
+}
+
+bool GeoContainerReader::loadInRect(const Rect& range, std::vector<Geometry>& out) {
+    if (!isOpen()) return false;
+
+    std::vector<size_t> leaves;
+    index.search(range, leaves);
+    return readFeatures(leaves, out);
+}
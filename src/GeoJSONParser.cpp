@@ -53,6 +53,13 @@ bool GeoJSONParser::loadFromFile(const std::string& filename) {
             }
         }
 
+        // Buscar atributos de la feature (antes de que empiece la siguiente)
+        size_t nextFeature = json.find("\"Feature\"", pos + 20);
+        size_t propPos = json.find("\"properties\"", pos);
+        if (propPos != std::string::npos && propPos < nextFeature) {
+            parseProperties(json, propPos, geom.properties);
+        }
+
         // Buscar coordenadas
         size_t coordPos = json.find("\"coordinates\"", geomPos);
         if (coordPos != std::string::npos && coordPos < geomPos + 300) {
@@ -171,6 +178,108 @@ void GeoJSONParser::parsePolygonCoordinates(const std::string& coords, std::vect
     }
 }
 
+namespace {
+
+// Lee un string JSON que empieza en json[pos] == '"'. Deja pos tras la comilla de cierre.
+std::string readJsonString(const std::string& json, size_t& pos) {
+    std::string result;
+    pos++;
+    while (pos < json.length() && json[pos] != '"') {
+        char c = json[pos];
+        if (c == '\\' && pos + 1 < json.length()) {
+            char esc = json[++pos];
+            switch (esc) {
+                case 'n': result += '\n'; break;
+                case 't': result += '\t'; break;
+                case 'r': result += '\r'; break;
+                case 'u':
+                    // Se conserva la secuencia \uXXXX sin decodificar
+                    result += "\\u";
+                    break;
+                default: result += esc; break;
+            }
+        } else {
+            result += c;
+        }
+        pos++;
+    }
+    pos++;
+    return result;
+}
+
+void skipSpaces(const std::string& json, size_t& pos) {
+    while (pos < json.length() && std::isspace((unsigned char)json[pos])) pos++;
+}
+
+} // namespace
+
+void GeoJSONParser::parseProperties(const std::string& json, size_t start,
+                                    std::vector<std::pair<std::string, std::string>>& properties) {
+    size_t pos = json.find(':', start);
+    if (pos == std::string::npos) return;
+    pos++;
+    skipSpaces(json, pos);
+
+    // "properties": null u otro valor que no sea objeto
+    if (pos >= json.length() || json[pos] != '{') return;
+    pos++;
+
+    while (pos < json.length()) {
+        skipSpaces(json, pos);
+        if (pos >= json.length() || json[pos] == '}') break;
+        if (json[pos] == ',') {
+            pos++;
+            continue;
+        }
+        if (json[pos] != '"') break;
+
+        std::string key = readJsonString(json, pos);
+        skipSpaces(json, pos);
+        if (pos >= json.length() || json[pos] != ':') break;
+        pos++;
+        skipSpaces(json, pos);
+        if (pos >= json.length()) break;
+
+        std::string value;
+        if (json[pos] == '"') {
+            value = readJsonString(json, pos);
+        } else if (json[pos] == '{' || json[pos] == '[') {
+            // Valor anidado: se guarda el texto JSON tal cual
+            size_t valueStart = pos;
+            int depth = 0;
+            bool inString = false;
+            for (; pos < json.length(); pos++) {
+                char c = json[pos];
+                if (inString) {
+                    if (c == '\\') pos++;
+                    else if (c == '"') inString = false;
+                } else if (c == '"') {
+                    inString = true;
+                } else if (c == '{' || c == '[') {
+                    depth++;
+                } else if (c == '}' || c == ']') {
+                    if (--depth == 0) {
+                        pos++;
+                        break;
+                    }
+                }
+            }
+            value = json.substr(valueStart, pos - valueStart);
+        } else {
+            // Número, true, false o null
+            size_t valueStart = pos;
+            while (pos < json.length() && json[pos] != ',' && json[pos] != '}' &&
+                   !std::isspace((unsigned char)json[pos])) {
+                pos++;
+            }
+            value = json.substr(valueStart, pos - valueStart);
+            if (value == "null") continue;
+        }
+
+        properties.push_back(std::make_pair(key, value));
+    }
+}
+
 Rect GeoJSONParser::getBounds() const {
     if (geometries.empty()) return Rect();
 
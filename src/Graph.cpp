@@ -1,256 +1,1653 @@
 #include "../include/Graph.h"
+#include "../include/Parallel.h"
+#include "../include/Landmarks.h"
+#include "../include/SearchWorkspace.h"
+#include "../include/UnitIndex.h"
 #include <iostream>
 #include <sstream>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <fstream>
+#include <type_traits>
+#include <unordered_map>
 
-Graph::Graph(double threshold) : nextNodeId(0), snapThreshold(threshold) {}
+namespace {
+// Por debajo de esta cantidad de vértices el snapping secuencial ya es instantáneo
+const size_t PARALLEL_SNAP_MIN_VERTICES = 50000;
+
+// Celdas por radio de la rejilla de isócronas cuando no se indica el tamaño,
+// y máximo permitido (acota memoria y tiempo si la celda pedida es muy chica)
+const double ISOCHRONE_AUTO_CELLS = 64;
+const double ISOCHRONE_MAX_CELLS = 512;
+const unsigned char NOT_REACHED = 255;
+
+const char GRAPH_MAGIC[6] = {'R', 'T', 'G', 'R', 0, 0};
+const uint8_t GRAPH_VERSION = 1;
+
+// Cabecera de la instantánea. Todos los campos son de 8 bytes (sin relleno)
+// y cada sección que sigue empieza alineada a 8, así los arreglos se pueden
+// usar directamente desde el archivo mapeado
+struct SnapshotHeader {
+    uint8_t magic[8];         // GRAPH_MAGIC + versión
+    uint64_t source;          // Suma de control de los datos de origen
+    uint64_t nodeCount;
+    uint64_t edgeCount;       // Aristas bidireccionales (arcos CSR = 2x)
+    uint64_t shapeCount;      // Vértices intermedios
+    uint64_t nodeLeaves;      // Hojas de los índices espaciales
+    uint64_t edgeLeaves;
+    uint64_t indexNodeSize;
+    uint64_t projectionBytes;
+};
+
+const size_t SECTION_ALIGN = 8;
+
+size_t alignedSize(size_t bytes) {
+    return (bytes + SECTION_ALIGN - 1) / SECTION_ALIGN * SECTION_ALIGN;
+}
+
+void writeSection(std::ofstream& file, const void* data, size_t bytes) {
+    static const char padding[SECTION_ALIGN] = {0};
+    if (bytes > 0) file.write((const char*)data, bytes);
+    file.write(padding, alignedSize(bytes) - bytes);
+}
+
+// FNV-1a de 64 bits, byte a byte
+struct Fnv1a {
+    uint64_t hash;
+
+    Fnv1a() : hash(1469598103934665603ULL) {}
+
+    void mix(uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    void mixDouble(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        mix(bits);
+    }
+};
+}
+
+Graph::Graph(double threshold)
+    : snapThreshold(threshold), threadCount(0), buildPartitions(0), simplifyChains(true),
+      spatialOrder(true) {
+    firstEdge.push_back(0);
+}
 
 void Graph::clear() {
-    nodes.clear();
-    nextNodeId = 0;
+    nodeX.clear();
+    nodeY.clear();
+    metricX.clear();
+    metricY.clear();
+    firstEdge.assign(1, 0);
+    edgeTarget.clear();
+    edgeWeight.clear();
+    edgeRef.clear();
+    shapeFirst.clear();
+    shapeX.clear();
+    shapeY.clear();
+    shapeMetricX.clear();
+    shapeMetricY.clear();
+    pendingFrom.clear();
+    pendingTo.clear();
+    pendingWeight.clear();
+    osmNodeIndex.clear();
+    nodeIndex.clear();
+    edgeIndex.clear();
 }
 
-int Graph::findOrCreateNode(const Point& p) {
-    // Buscar si ya existe un nodo cercano
-    for (auto& pair : nodes) {
-        if (pair.second.position.distanceTo(p) < snapThreshold) {
-            return pair.first;
+int Graph::addNode(const Point& p) {
+    int id = (int)nodeX.size();
+    Point m = projection.forward(p);
+    nodeX.push_back(p.x);
+    nodeY.push_back(p.y);
+    metricX.push_back(m.x);
+    metricY.push_back(m.y);
+    return id;
+}
+
+// Rejilla hash uniforme para el snapping. Con celda = umbral, un nodo a
+// menos del umbral sólo puede estar en la celda del punto o en sus 8 vecinas.
+// Las entradas de cada celda se encadenan por índice (sin vectores por celda).
+struct Graph::SnapGrid {
+    double cellSize;
+    std::unordered_map<uint64_t, int> head;  // Celda -> última entrada
+    std::vector<int> next;                   // Entrada anterior de la misma celda
+    std::vector<Point> points;
+    std::vector<int> ids;
+
+    explicit SnapGrid(double cell) : cellSize(cell) {}
+
+    long long cellOf(double v) const { return (long long)std::floor(v / cellSize); }
+
+    static uint64_t key(long long cx, long long cy) {
+        return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+    }
+
+    void insert(const Point& p, int id) {
+        uint64_t k = key(cellOf(p.x), cellOf(p.y));
+        auto it = head.find(k);
+        next.push_back(it == head.end() ? -1 : it->second);
+        points.push_back(p);
+        ids.push_back(id);
+        head[k] = (int)ids.size() - 1;
+    }
+
+    // Menor id a distancia < threshold, o -1. Devolver el menor id replica
+    // el recorrido lineal original, que se quedaba con el primer nodo creado.
+    int find(const Point& p, double threshold) const {
+        long long cx = cellOf(p.x), cy = cellOf(p.y);
+        int best = -1;
+        for (long long dx = -1; dx <= 1; dx++) {
+            for (long long dy = -1; dy <= 1; dy++) {
+                auto it = head.find(key(cx + dx, cy + dy));
+                if (it == head.end()) continue;
+                for (int e = it->second; e != -1; e = next[e]) {
+                    if ((best == -1 || ids[e] < best) && points[e].distanceTo(p) < threshold) {
+                        best = ids[e];
+                    }
+                }
+            }
         }
+        return best;
+    }
+};
+
+int Graph::findOrCreateNode(const Point& p, SnapGrid* grid) {
+    // Buscar si ya existe un nodo cercano
+    if (grid) {
+        int id = grid->find(p, snapThreshold);
+        if (id != -1) return id;
     }
-    
+
     // Crear nuevo nodo
-    int id = nextNodeId++;
-    nodes[id] = GraphNode(id, p);
+    int id = addNode(p);
+    if (grid) grid->insert(p, id);
+    return id;
+}
+
+int Graph::findOrCreateOsmNode(long long osmId, const Point& p) {
+    // Con IDs OSM la topología es exacta: no hace falta el umbral de snapping
+    auto it = osmNodeIndex.find(osmId);
+    if (it != osmNodeIndex.end()) {
+        return it->second;
+    }
+
+    int id = addNode(p);
+    osmNodeIndex[osmId] = id;
     return id;
 }
 
 void Graph::buildFromGeometries(const std::vector<Geometry>& geometries) {
+    std::vector<const Geometry*> refs;
+    refs.reserve(geometries.size());
+    for (const auto& geom : geometries) refs.push_back(&geom);
+    build(refs);
+}
+
+void Graph::buildFromGeometries(const std::deque<Geometry>& geometries) {
+    std::vector<const Geometry*> refs;
+    refs.reserve(geometries.size());
+    for (const auto& geom : geometries) refs.push_back(&geom);
+    build(refs);
+}
+
+void Graph::build(const std::vector<const Geometry*>& geometries) {
     clear();
-    
+
     // Construir grafo desde LineStrings (calles)
-    for (const auto& geom : geometries) {
-        if (geom.type == GEOM_LINESTRING && geom.points.size() >= 2) {
-            // Crear nodos para cada punto de la línea
-            std::vector<int> lineNodes;
-            for (const auto& point : geom.points) {
-                int nodeId = findOrCreateNode(point);
-                lineNodes.push_back(nodeId);
+    std::vector<const Geometry*> lines;
+    size_t snapVertices = 0;
+    for (const Geometry* geom : geometries) {
+        if (geom->type != GEOM_LINESTRING || geom->points.size() < 2) continue;
+        lines.push_back(geom);
+        if (geom->nodeIds.size() != geom->points.size()) snapVertices += geom->points.size();
+    }
+
+    // Nodo de cada vértice de cada línea
+    std::vector<std::vector<int>> lineNodes(lines.size());
+    int threads = resolveThreadCount(threadCount);
+    if (threads > 1 && snapThreshold > 0 && snapVertices >= PARALLEL_SNAP_MIN_VERTICES) {
+        snapPartitioned(lines, threads, lineNodes);
+    } else {
+        snapSequential(lines, lineNodes);
+    }
+
+    // Conectar nodos consecutivos
+    for (const auto& nodesOfLine : lineNodes) {
+        for (size_t i = 0; i + 1 < nodesOfLine.size(); i++) {
+            int from = nodesOfLine[i];
+            int to = nodesOfLine[i + 1];
+
+            // Calcular distancia (peso) en coordenadas proyectadas
+            double dx = metricX[from] - metricX[to];
+            double dy = metricY[from] - metricY[to];
+            double dist = std::sqrt(dx * dx + dy * dy);
+
+            // Agregar conexión bidireccional
+            pendingFrom.push_back(from);
+            pendingTo.push_back(to);
+            pendingWeight.push_back(dist);
+        }
+    }
+
+    if (simplifyChains) contractChains();
+    if (spatialOrder) reorderNodes();
+    buildAdjacency();
+    buildSpatialIndex();
+}
+
+void Graph::snapSequential(const std::vector<const Geometry*>& lines,
+                           std::vector<std::vector<int>>& lineNodes) {
+    buildPartitions = 1;
+    std::unique_ptr<SnapGrid> grid;
+    if (snapThreshold > 0) grid.reset(new SnapGrid(snapThreshold));
+
+    // Crear nodos para cada punto de la línea
+    for (size_t l = 0; l < lines.size(); l++) {
+        const Geometry& geom = *lines[l];
+        bool hasOsmIds = geom.nodeIds.size() == geom.points.size();
+        for (size_t i = 0; i < geom.points.size(); i++) {
+            int nodeId = hasOsmIds ? findOrCreateOsmNode(geom.nodeIds[i], geom.points[i])
+                                   : findOrCreateNode(geom.points[i], grid.get());
+            lineNodes[l].push_back(nodeId);
+        }
+    }
+}
+
+void Graph::snapPartitioned(const std::vector<const Geometry*>& lines, int threads,
+                            std::vector<std::vector<int>>& lineNodes) {
+    // Los vértices con ID OSM no necesitan snapping
+    struct VertexRef { int line; int index; };
+    std::vector<VertexRef> refs;
+    for (size_t l = 0; l < lines.size(); l++) {
+        const Geometry& geom = *lines[l];
+        lineNodes[l].resize(geom.points.size());
+        bool hasOsmIds = geom.nodeIds.size() == geom.points.size();
+        for (size_t i = 0; i < geom.points.size(); i++) {
+            if (hasOsmIds) {
+                lineNodes[l][i] = findOrCreateOsmNode(geom.nodeIds[i], geom.points[i]);
+            } else {
+                refs.push_back({(int)l, (int)i});
+            }
+        }
+    }
+
+    // Franjas verticales con la misma cantidad de vértices (cortes por cuantiles de x)
+    int parts = threads;
+    std::vector<double> xs(refs.size());
+    for (size_t r = 0; r < refs.size(); r++) {
+        xs[r] = lines[refs[r].line]->points[refs[r].index].x;
+    }
+    std::vector<double> cuts;
+    auto from = xs.begin();
+    for (int k = 1; k < parts; k++) {
+        auto nth = xs.begin() + refs.size() * k / parts;
+        std::nth_element(from, nth, xs.end());
+        cuts.push_back(*nth);
+        from = nth;
+    }
+
+    std::vector<std::vector<int>> stripRefs(parts);
+    for (size_t r = 0; r < refs.size(); r++) {
+        double x = lines[refs[r].line]->points[refs[r].index].x;
+        int s = (int)(std::upper_bound(cuts.begin(), cuts.end(), x) - cuts.begin());
+        stripRefs[s].push_back((int)r);
+    }
+
+    // Snapping local de cada franja, en paralelo y en el orden de entrada
+    std::vector<std::vector<Point>> stripNodes(parts);
+    std::vector<std::vector<int>> stripLocal(parts);
+    parallelFor(parts, threads, [&](int s) {
+        SnapGrid grid(snapThreshold);
+        for (int r : stripRefs[s]) {
+            const Point& p = lines[refs[r].line]->points[refs[r].index];
+            int id = grid.find(p, snapThreshold);
+            if (id == -1) {
+                id = (int)stripNodes[s].size();
+                stripNodes[s].push_back(p);
+                grid.insert(p, id);
             }
-            
-            // Conectar nodos consecutivos
-            for (size_t i = 0; i < lineNodes.size() - 1; i++) {
-                int from = lineNodes[i];
-                int to = lineNodes[i + 1];
-                
-                // Calcular distancia (peso)
-                double dist = nodes[from].position.distanceTo(nodes[to].position);
-                
-                // Agregar conexión bidireccional
-                nodes[from].neighbors.push_back(to);
-                nodes[from].weights.push_back(dist);
-                
-                nodes[to].neighbors.push_back(from);
-                nodes[to].weights.push_back(dist);
+            stripLocal[s].push_back(id);
+        }
+    });
+
+    // Unir franjas: los nodos a menos del umbral de un corte se fusionan con
+    // los de franjas anteriores que estén a menos del umbral del mismo corte
+    const double INF = std::numeric_limits<double>::max();
+    SnapGrid border(snapThreshold);
+    for (int s = 0; s < parts; s++) {
+        double lo = s > 0 ? cuts[s - 1] : -INF;
+        double hi = s < parts - 1 ? cuts[s] : INF;
+
+        std::vector<int> globalOf(stripNodes[s].size());
+        for (size_t n = 0; n < stripNodes[s].size(); n++) {
+            const Point& p = stripNodes[s][n];
+            int id = -1;
+            if (p.x - lo < snapThreshold) id = border.find(p, snapThreshold);
+            if (id == -1) {
+                id = addNode(p);
+                if (hi - p.x < snapThreshold) border.insert(p, id);
+            }
+            globalOf[n] = id;
+        }
+
+        for (size_t k = 0; k < stripRefs[s].size(); k++) {
+            const VertexRef& ref = refs[stripRefs[s][k]];
+            lineNodes[ref.line][ref.index] = globalOf[stripLocal[s][k]];
+        }
+    }
+    buildPartitions = parts;
+}
+
+void Graph::contractChains() {
+    // Los tramos entre vértices fusionados por el snapping no aportan nada
+    size_t kept = 0;
+    for (size_t i = 0; i < pendingFrom.size(); i++) {
+        if (pendingFrom[i] == pendingTo[i]) continue;
+        pendingFrom[kept] = pendingFrom[i];
+        pendingTo[kept] = pendingTo[i];
+        pendingWeight[kept++] = pendingWeight[i];
+    }
+    pendingFrom.resize(kept);
+    pendingTo.resize(kept);
+    pendingWeight.resize(kept);
+
+    // Aristas incidentes a cada nodo (CSR temporal sobre las pendientes)
+    int n = getNodeCount();
+    int m = (int)pendingFrom.size();
+    std::vector<int> first(n + 1, 0), incident(2 * (size_t)m);
+    for (int i = 0; i < m; i++) {
+        first[pendingFrom[i] + 1]++;
+        first[pendingTo[i] + 1]++;
+    }
+    for (int u = 0; u < n; u++) first[u + 1] += first[u];
+    std::vector<int> cursor(first.begin(), first.end() - 1);
+    for (int i = 0; i < m; i++) {
+        incident[cursor[pendingFrom[i]]++] = i;
+        incident[cursor[pendingTo[i]]++] = i;
+    }
+
+    // Quedan como nodos los cruces y las puntas; los de grado 2 son vértices
+    // intermedios y los aislados desaparecen
+    std::vector<char> isNode(n);
+    for (int u = 0; u < n; u++) {
+        int degree = first[u + 1] - first[u];
+        isNode[u] = degree > 0 && degree != 2;
+    }
+
+    std::vector<int> chainFrom, chainTo;
+    std::vector<double> chainWeight;
+    std::vector<char> used(m, 0);
+    shapeFirst.assign(1, 0);
+    shapeX.clear();
+    shapeY.clear();
+    shapeMetricX.clear();
+    shapeMetricY.clear();
+
+    // Recorre la cadena que sale de 'start' por 'edge' hasta el próximo nodo
+    auto walk = [&](int start, int edge) {
+        int current = start;
+        double weight = 0;
+        while (true) {
+            used[edge] = 1;
+            weight += pendingWeight[edge];
+            current = pendingFrom[edge] == current ? pendingTo[edge] : pendingFrom[edge];
+            if (isNode[current]) break;
+
+            shapeX.push_back(nodeX[current]);
+            shapeY.push_back(nodeY[current]);
+            shapeMetricX.push_back(metricX[current]);
+            shapeMetricY.push_back(metricY[current]);
+            int a = incident[first[current]], b = incident[first[current] + 1];
+            edge = a == edge ? b : a;
+        }
+        chainFrom.push_back(start);
+        chainTo.push_back(current);
+        chainWeight.push_back(weight);
+        shapeFirst.push_back((int)shapeX.size());
+    };
+
+    for (int u = 0; u < n; u++) {
+        if (!isNode[u]) continue;
+        for (int k = first[u]; k < first[u + 1]; k++) {
+            if (!used[incident[k]]) walk(u, incident[k]);
+        }
+    }
+
+    // Ciclos sin cruces (p. ej. una rotonda aislada): uno de sus vértices
+    // pasa a ser nodo y el ciclo queda como un lazo
+    for (int i = 0; i < m; i++) {
+        if (used[i]) continue;
+        isNode[pendingFrom[i]] = 1;
+        walk(pendingFrom[i], i);
+    }
+
+    // Ids densos para los nodos que quedan, en el orden original
+    std::vector<int> newId(n, -1);
+    int count = 0;
+    for (int u = 0; u < n; u++) {
+        if (!isNode[u]) continue;
+        newId[u] = count;
+        nodeX[count] = nodeX[u];
+        nodeY[count] = nodeY[u];
+        metricX[count] = metricX[u];
+        metricY[count] = metricY[u];
+        count++;
+    }
+    nodeX.resize(count);
+    nodeY.resize(count);
+    metricX.resize(count);
+    metricY.resize(count);
+
+    for (auto it = osmNodeIndex.begin(); it != osmNodeIndex.end();) {
+        if (newId[it->second] == -1) {
+            it = osmNodeIndex.erase(it);
+        } else {
+            it->second = newId[it->second];
+            ++it;
+        }
+    }
+
+    for (size_t i = 0; i < chainFrom.size(); i++) {
+        chainFrom[i] = newId[chainFrom[i]];
+        chainTo[i] = newId[chainTo[i]];
+    }
+    pendingFrom.swap(chainFrom);
+    pendingTo.swap(chainTo);
+    pendingWeight.swap(chainWeight);
+}
+
+void Graph::reorderNodes() {
+    int n = getNodeCount();
+    if (n < 2) return;
+
+    Rect extent(getMetricPosition(0));
+    for (int u = 1; u < n; u++) extent.expand(getMetricPosition(u));
+
+    // Nuevo id = posición en la curva (empates en el orden de carga)
+    std::vector<std::pair<uint32_t, int>> keys(n);
+    for (int u = 0; u < n; u++) {
+        keys[u] = std::make_pair(PackedRTree::hilbertIndex(getMetricPosition(u), extent), u);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<int> newId(n);
+    for (int i = 0; i < n; i++) newId[keys[i].second] = i;
+
+    auto permute = [&](MappedArray<double>& values) {
+        std::vector<double> sorted(n);
+        for (int i = 0; i < n; i++) sorted[i] = values[keys[i].second];
+        values.swap(sorted);
+    };
+    permute(nodeX);
+    permute(nodeY);
+    permute(metricX);
+    permute(metricY);
+
+    for (auto& entry : osmNodeIndex) entry.second = newId[entry.second];
+    for (size_t i = 0; i < pendingFrom.size(); i++) {
+        pendingFrom[i] = newId[pendingFrom[i]];
+        pendingTo[i] = newId[pendingTo[i]];
+    }
+
+    // Las aristas (y su forma) en el orden de su extremo menor, para que los
+    // ids de arista también sigan la curva
+    int m = (int)pendingFrom.size();
+    std::vector<int> edges(m);
+    for (int i = 0; i < m; i++) edges[i] = i;
+    std::stable_sort(edges.begin(), edges.end(), [&](int a, int b) {
+        return std::min(pendingFrom[a], pendingTo[a]) < std::min(pendingFrom[b], pendingTo[b]);
+    });
+
+    std::vector<int> from(m), to(m);
+    std::vector<double> weight(m);
+    for (int i = 0; i < m; i++) {
+        from[i] = pendingFrom[edges[i]];
+        to[i] = pendingTo[edges[i]];
+        weight[i] = pendingWeight[edges[i]];
+    }
+    pendingFrom.swap(from);
+    pendingTo.swap(to);
+    pendingWeight.swap(weight);
+
+    if (shapeFirst.size() == (size_t)m + 1) {
+        std::vector<int> first(1, 0);
+        std::vector<double> x, y, mx, my;
+        x.reserve(shapeX.size());
+        y.reserve(shapeX.size());
+        mx.reserve(shapeX.size());
+        my.reserve(shapeX.size());
+        for (int id : edges) {
+            for (int k = shapeFirst[id]; k < shapeFirst[id + 1]; k++) {
+                x.push_back(shapeX[k]);
+                y.push_back(shapeY[k]);
+                mx.push_back(shapeMetricX[k]);
+                my.push_back(shapeMetricY[k]);
             }
+            first.push_back((int)x.size());
         }
+        shapeFirst.swap(first);
+        shapeX.swap(x);
+        shapeY.swap(y);
+        shapeMetricX.swap(mx);
+        shapeMetricY.swap(my);
+    }
+}
+
+void Graph::buildAdjacency() {
+    int n = getNodeCount();
+
+    // Sin contracción ninguna arista tiene vértices intermedios
+    if (shapeFirst.size() != pendingFrom.size() + 1) {
+        shapeFirst.assign(pendingFrom.size() + 1, 0);
+    }
+
+    // Contar el grado de cada nodo (ambos sentidos)
+    firstEdge.assign(n + 1, 0);
+    for (size_t i = 0; i < pendingFrom.size(); i++) {
+        firstEdge[pendingFrom[i] + 1]++;
+        firstEdge[pendingTo[i] + 1]++;
+    }
+    for (int u = 0; u < n; u++) {
+        firstEdge[u + 1] += firstEdge[u];
+    }
+
+    // Repartir las aristas en su rango (orden estable de inserción)
+    edgeTarget.resize(firstEdge[n]);
+    edgeWeight.resize(firstEdge[n]);
+    edgeRef.resize(firstEdge[n]);
+    std::vector<int> cursor(firstEdge.begin(), firstEdge.end() - 1);
+    for (size_t i = 0; i < pendingFrom.size(); i++) {
+        int a = pendingFrom[i], b = pendingTo[i];
+        edgeTarget[cursor[a]] = b;
+        edgeRef[cursor[a]] = (int)i << 1;
+        edgeWeight[cursor[a]++] = pendingWeight[i];
+        edgeTarget[cursor[b]] = a;
+        edgeRef[cursor[b]] = ((int)i << 1) | 1;
+        edgeWeight[cursor[b]++] = pendingWeight[i];
     }
+
+    std::vector<int>().swap(pendingFrom);
+    std::vector<int>().swap(pendingTo);
+    std::vector<double>().swap(pendingWeight);
+}
+
+void Graph::buildSpatialIndex() {
+    int n = getNodeCount();
+    if (n == 0) return;
+
+    Rect extent(getMetricPosition(0));
+    for (int u = 1; u < n; u++) extent.expand(getMetricPosition(u));
+
+    // Hojas en orden de Hilbert para que nodos cercanos queden en la misma página
+    std::vector<std::pair<uint32_t, PackedRTreeItem>> items;
+    items.reserve(n);
+    for (int u = 0; u < n; u++) {
+        PackedRTreeItem item;
+        item.box = Rect(getMetricPosition(u));
+        item.offset = (uint64_t)u;
+        items.push_back(std::make_pair(PackedRTree::hilbertIndex(getMetricPosition(u), extent), item));
+    }
+
+    auto byHilbert = [](const std::pair<uint32_t, PackedRTreeItem>& a,
+                        const std::pair<uint32_t, PackedRTreeItem>& b) {
+        return a.first < b.first;
+    };
+    std::sort(items.begin(), items.end(), byHilbert);
+
+    std::vector<PackedRTreeItem> leaves;
+    leaves.reserve(items.size());
+    for (const auto& item : items) leaves.push_back(item.second);
+    nodeIndex.build(leaves);
+
+    // Cada arista bidireccional una sola vez (sentido de carga), con la caja
+    // de toda su polilínea
+    items.clear();
+    for (int u = 0; u < n; u++) {
+        for (int e = firstEdge[u]; e < firstEdge[u + 1]; e++) {
+            if (!isForwardEdge(e)) continue;
+
+            PackedRTreeItem item;
+            item.box = Rect(getMetricPosition(u));
+            for (int k = 1; k < edgeVertexCount(e); k++) item.box.expand(edgeVertex(e, u, k, true));
+            item.offset = (uint64_t)e;
+            items.push_back(std::make_pair(PackedRTree::hilbertIndex(item.box.center(), extent), item));
+        }
+    }
+    std::sort(items.begin(), items.end(), byHilbert);
+
+    leaves.clear();
+    for (const auto& item : items) leaves.push_back(item.second);
+    edgeIndex.build(leaves);
+}
+
+int Graph::edgeSource(int edge) const {
+    return (int)(std::upper_bound(firstEdge.begin(), firstEdge.end(), edge) - firstEdge.begin()) - 1;
+}
+
+GraphNode Graph::getNode(int id) const {
+    GraphNode node;
+    if (id < 0 || id >= getNodeCount()) return node;
+    node.id = id;
+    node.position = getNodePosition(id);
+    node.metric = getMetricPosition(id);
+    for (int e = firstEdge[id]; e < firstEdge[id + 1]; e++) {
+        node.neighbors.push_back(edgeTarget[e]);
+        node.weights.push_back(edgeWeight[e]);
+    }
+    return node;
+}
+
+std::map<int, GraphNode> Graph::getNodes() const {
+    std::map<int, GraphNode> nodes;
+    for (int u = 0; u < getNodeCount(); u++) nodes.emplace_hint(nodes.end(), u, getNode(u));
+    return nodes;
 }
 
 int Graph::findNearestNode(const Point& p) const {
-    if (nodes.empty()) return -1;
-    
-    int nearestId = -1;
-    double minDist = std::numeric_limits<double>::max();
-    
-    for (const auto& pair : nodes) {
-        double dist = pair.second.position.distanceTo(p);
-        if (dist < minDist) {
-            minDist = dist;
-            nearestId = pair.first;
+    Point q = projection.forward(p);
+    size_t leaf = nodeIndex.nearest(q, [&](size_t i) {
+        return getMetricPosition((int)nodeIndex.getLeaf(i).offset).distanceTo(q);
+    });
+    return leaf == PackedRTree::NOT_FOUND ? -1 : (int)nodeIndex.getLeaf(leaf).offset;
+}
+
+double Graph::projectOnEdge(int edge, int from, const Point& q, double* t, Point* point) const {
+    // Proyección de q sobre la polilínea de la arista: distancia, fracción t
+    // del largo recorrido hasta el punto y punto proyectado (lon/lat)
+    int count = edgeVertexCount(edge);
+    double best = std::numeric_limits<double>::max();
+    double length = 0, bestLength = 0;
+    int bestSegment = 0;
+    double bestU = 0;
+    Point a = edgeVertex(edge, from, 0, true);
+    for (int k = 1; k < count; k++) {
+        Point b = edgeVertex(edge, from, k, true);
+        double dx = b.x - a.x, dy = b.y - a.y;
+        double len2 = dx * dx + dy * dy;
+        double u = len2 > 0 ? ((q.x - a.x) * dx + (q.y - a.y) * dy) / len2 : 0.0;
+        u = std::min(1.0, std::max(0.0, u));
+        double d = Point(a.x + u * dx, a.y + u * dy).distanceTo(q);
+        double segment = std::sqrt(len2);
+        if (d < best) {
+            best = d;
+            bestSegment = k - 1;
+            bestU = u;
+            bestLength = length + u * segment;
         }
+        length += segment;
+        a = b;
     }
-    
-    return nearestId;
+    if (t) *t = length > 0 ? std::min(1.0, bestLength / length) : 0.0;
+    if (point) {
+        Point ga = edgeVertex(edge, from, bestSegment, false);
+        Point gb = edgeVertex(edge, from, bestSegment + 1, false);
+        *point = Point(ga.x + bestU * (gb.x - ga.x), ga.y + bestU * (gb.y - ga.y));
+    }
+    return best;
 }
 
-const GraphNode* Graph::getNode(int id) const {
-    auto it = nodes.find(id);
-    return (it != nodes.end()) ? &it->second : nullptr;
+Rect Graph::metricRange(const Rect& range) const {
+    // Esquinas y puntos medios de los lados: con UTM los meridianos no son
+    // rectas, así la caja métrica no se queda corta en los bordes
+    Rect box(projection.forward(Point(range.minX, range.minY)));
+    double midX = (range.minX + range.maxX) / 2, midY = (range.minY + range.maxY) / 2;
+    const Point samples[7] = {Point(range.maxX, range.minY), Point(range.maxX, range.maxY),
+                              Point(range.minX, range.maxY), Point(midX, range.minY),
+                              Point(midX, range.maxY), Point(range.minX, midY),
+                              Point(range.maxX, midY)};
+    for (const auto& p : samples) box.expand(projection.forward(p));
+    return box;
 }
 
-int Graph::getEdgeCount() const {
-    int count = 0;
-    for (const auto& pair : nodes) {
-        count += pair.second.neighbors.size();
+void Graph::edgesInRange(const Rect& range, std::vector<int>& out) const {
+    std::vector<size_t> leaves;
+    edgeIndex.search(metricRange(range), leaves);
+    for (size_t leaf : leaves) out.push_back((int)edgeIndex.getLeaf(leaf).offset);
+}
+
+void Graph::nodesInRange(const Rect& range, std::vector<int>& out) const {
+    std::vector<size_t> leaves;
+    nodeIndex.search(metricRange(range), leaves);
+    for (size_t leaf : leaves) out.push_back((int)nodeIndex.getLeaf(leaf).offset);
+}
+
+bool Graph::snapToEdge(const Point& p, EdgeSnap& snap) const {
+    Point q = projection.forward(p);
+
+    double distance;
+    size_t leaf = edgeIndex.nearest(q, [&](size_t i) {
+        int edge = (int)edgeIndex.getLeaf(i).offset;
+        return projectOnEdge(edge, edgeSource(edge), q, nullptr, nullptr);
+    }, &distance);
+    if (leaf == PackedRTree::NOT_FOUND) return false;
+
+    snap.edge = (int)edgeIndex.getLeaf(leaf).offset;
+    snap.from = edgeSource(snap.edge);
+    snap.to = edgeTarget[snap.edge];
+    snap.distance = projectOnEdge(snap.edge, snap.from, q, &snap.t, &snap.point);
+    return true;
+}
+
+int Graph::snapCandidates(const Point& p, double radius, int maxCount,
+                          std::vector<EdgeSnap>& out) const {
+    out.clear();
+    if (maxCount <= 0) return 0;
+
+    Point q = projection.forward(p);
+    std::vector<size_t> leaves;
+    edgeIndex.search(Rect(q.x - radius, q.y - radius, q.x + radius, q.y + radius), leaves);
+
+    for (size_t leaf : leaves) {
+        EdgeSnap snap;
+        snap.edge = (int)edgeIndex.getLeaf(leaf).offset;
+        snap.from = edgeSource(snap.edge);
+        snap.to = edgeTarget[snap.edge];
+        snap.distance = projectOnEdge(snap.edge, snap.from, q, &snap.t, &snap.point);
+        if (snap.distance <= radius) out.push_back(snap);
+    }
+
+    // Las más cercanas primero; empates por arista para un orden estable
+    std::sort(out.begin(), out.end(), [](const EdgeSnap& a, const EdgeSnap& b) {
+        return a.distance < b.distance || (a.distance == b.distance && a.edge < b.edge);
+    });
+    if ((int)out.size() > maxCount) out.resize(maxCount);
+    return (int)out.size();
+}
+
+Point Graph::edgePoint(int edge, int from, double t, bool metric) const {
+    // Avance sobre los tramos (medidos en coordenadas proyectadas, como el peso)
+    int count = edgeVertexCount(edge);
+    double target = t * edgeWeight[edge];
+    double length = 0;
+    for (int k = 1; k < count; k++) {
+        Point a = edgeVertex(edge, from, k - 1, true);
+        Point b = edgeVertex(edge, from, k, true);
+        double segment = a.distanceTo(b);
+        if (length + segment >= target || k == count - 1) {
+            double u = segment > 0 ? std::min(1.0, std::max(0.0, (target - length) / segment)) : 0.0;
+            if (!metric) {
+                a = edgeVertex(edge, from, k - 1, false);
+                b = edgeVertex(edge, from, k, false);
+            }
+            return Point(a.x + u * (b.x - a.x), a.y + u * (b.y - a.y));
+        }
+        length += segment;
+    }
+    return edgeVertex(edge, from, 0, metric);
+}
+
+void Graph::edgeSection(int edge, int from, double t0, double t1, bool metric,
+                        std::vector<Point>& out) const {
+    int count = edgeVertexCount(edge);
+    if (count == 2) return;
+
+    // Fracción del largo en cada vértice intermedio
+    std::vector<double> at(count, 0);
+    for (int k = 1; k < count; k++) {
+        at[k] = at[k - 1] + edgeVertex(edge, from, k - 1, true).distanceTo(edgeVertex(edge, from, k, true));
+    }
+    double total = at[count - 1];
+    if (!(total > 0)) return;
+
+    if (t0 <= t1) {
+        for (int k = 1; k < count - 1; k++) {
+            double f = at[k] / total;
+            if (f > t0 && f < t1) out.push_back(edgeVertex(edge, from, k, metric));
+        }
+    } else {
+        for (int k = count - 2; k >= 1; k--) {
+            double f = at[k] / total;
+            if (f < t0 && f > t1) out.push_back(edgeVertex(edge, from, k, metric));
+        }
+    }
+}
+
+void Graph::getEdgeGeometry(int edge, std::vector<Point>& points) const {
+    points.clear();
+    int from = edgeSource(edge);
+    for (int k = 0; k < edgeVertexCount(edge); k++) points.push_back(edgeVertex(edge, from, k, false));
+}
+
+std::vector<double> Graph::getEdgeWeights() const {
+    std::vector<double> weights(getEdgeCount(), 0);
+    for (size_t e = 0; e < edgeWeight.size(); e++) weights[edgeRef[e] >> 1] = edgeWeight[e];
+    return weights;
+}
+
+void Graph::buildRoutePath(const EdgeSnap& source, const EdgeSnap& target, Route& route,
+                           const std::vector<double>* idWeights) const {
+    route.path.clear();
+    route.path.push_back(source.point);
+
+    if (route.nodeIds.empty()) {
+        // Origen y destino sobre la misma arista: tramo directo
+        edgeSection(source.edge, source.from, source.t, target.t, false, route.path);
+        route.path.push_back(target.point);
+        return;
+    }
+
+    // Tramo de la arista de origen hasta el primer nodo (en un lazo, from y
+    // to coinciden: se sale por el lado más corto)
+    int first = route.nodeIds.front();
+    bool leavesByEnd = first == source.to && (first != source.from || source.t >= 0.5);
+    edgeSection(source.edge, source.from, source.t, leavesByEnd ? 1.0 : 0.0, false, route.path);
+    route.path.push_back(getNodePosition(first));
+
+    // Entre nodos consecutivos, la arista más corta que los une según la
+    // métrica de la búsqueda (con paralelas, la misma que eligió la consulta)
+    auto weightOf = [&](int e) { return idWeights ? (*idWeights)[getEdgeId(e)] : (double)edgeWeight[e]; };
+    for (size_t i = 0; i + 1 < route.nodeIds.size(); i++) {
+        int u = route.nodeIds[i], v = route.nodeIds[i + 1];
+        int best = -1;
+        double bestWeight = 0;
+        for (int e = firstEdge[u]; e < firstEdge[u + 1]; e++) {
+            if (edgeTarget[e] != v) continue;
+            double w = weightOf(e);
+            if (best == -1 || w < bestWeight || std::isnan(bestWeight)) {
+                best = e;
+                bestWeight = w;
+            }
+        }
+        if (best != -1) edgeSection(best, u, 0.0, 1.0, false, route.path);
+        route.path.push_back(getNodePosition(v));
     }
-    return count / 2;  // Dividir por 2 porque las aristas son bidireccionales
+
+    int last = route.nodeIds.back();
+    bool entersByStart = last == target.from && (last != target.to || target.t <= 0.5);
+    edgeSection(target.edge, target.from, entersByStart ? 0.0 : 1.0, target.t, false, route.path);
+    route.path.push_back(target.point);
 }
 
 Route Graph::findShortestPath(const Point& start, const Point& end) {
-    Route route;
-    
-    int startNode = findNearestNode(start);
-    int endNode = findNearestNode(end);
-    
-    if (startNode == -1 || endNode == -1) {
-        return route;
-    }
-    
-    // Distancias y predecesores
-    std::map<int, double> distances;
-    std::map<int, int> predecessors;
-    std::set<int> visited;
-    
-    // Inicializar distancias
-    for (const auto& pair : nodes) {
-        distances[pair.first] = std::numeric_limits<double>::max();
-    }
-    distances[startNode] = 0;
-    
-    // Cola de prioridad: (distancia, nodo)
-    std::priority_queue<std::pair<double, int>,
-                       std::vector<std::pair<double, int>>,
-                       std::greater<std::pair<double, int>>> pq;
-    pq.push({0, startNode});
-    
-    // Dijkstra
-    while (!pq.empty()) {
-        int current = pq.top().second;
-        double currentDist = pq.top().first;
-        pq.pop();
-        
-        if (visited.count(current)) continue;
-        visited.insert(current);
-        
-        if (current == endNode) break;
-        
-        const GraphNode& node = nodes.at(current);
-        for (size_t i = 0; i < node.neighbors.size(); i++) {
-            int neighbor = node.neighbors[i];
-            double weight = node.weights[i];
-            double newDist = currentDist + weight;
-            
-            if (newDist < distances[neighbor]) {
-                distances[neighbor] = newDist;
-                predecessors[neighbor] = current;
-                pq.push({newDist, neighbor});
+    return routeBetween(start, end, false, nullptr);
+}
+
+Route Graph::findAStarPath(const Point& start, const Point& end) {
+    return routeBetween(start, end, true, nullptr);
+}
+
+Route Graph::findALTPath(const Point& start, const Point& end, const Landmarks& landmarks) const {
+    return routeBetween(start, end, true, landmarks.isReady() ? &landmarks : nullptr);
+}
+
+UnitRanking Graph::nearestByNetwork(const Point& p, int k, const UnitIndex& units) const {
+    UnitRanking result;
+    EdgeSnap source;
+    if (k <= 0 || units.getGraph() != this || units.size() == 0 || !snapToEdge(p, source)) {
+        return result;
+    }
+    k = std::min(k, units.size());
+
+    // Nodos 0..n-1 del grafo y n + i para la unidad i
+    int n = getNodeCount();
+    SearchWorkspace& ws = SearchWorkspace::forThread();
+    ws.prepare(n + units.size());
+
+    double sourceWeight = edgeWeight[source.edge];
+    ws.relax(source.from, source.t * sourceWeight, source.t * sourceWeight, -1);
+    ws.relax(source.to, (1 - source.t) * sourceWeight, (1 - source.t) * sourceWeight, -1);
+
+    // Unidades sobre la misma arista del punto: también se llega directo
+    int sourceId = getEdgeId(source.edge);
+    for (int i = units.getEdgeUnitsBegin(sourceId); i < units.getEdgeUnitsEnd(sourceId); i++) {
+        int unit = units.getEdgeUnit(i);
+        double d = std::fabs(source.t - units.getSnap(unit).t) * sourceWeight;
+        ws.relax(n + unit, d, d, -1);
+    }
+
+    while (!ws.empty()) {
+        int current = ws.pop();
+        double d = ws.distance(current);
+
+        if (current >= n) {
+            result.units.push_back(current - n);
+            result.distances.push_back(d);
+            if ((int)result.units.size() == k) break;
+            continue;
+        }
+        result.settledNodes++;
+
+        for (int e = firstEdge[current]; e < firstEdge[current + 1]; e++) {
+            // Unidades sobre la arista: t se mide desde el extremo de carga
+            int id = getEdgeId(e);
+            for (int i = units.getEdgeUnitsBegin(id); i < units.getEdgeUnitsEnd(id); i++) {
+                int unit = units.getEdgeUnit(i);
+                double t = units.getSnap(unit).t;
+                double offset = (isForwardEdge(e) ? t : 1 - t) * edgeWeight[e];
+                ws.relax(n + unit, d + offset, d + offset, current);
             }
+
+            int neighbor = edgeTarget[e];
+            if (ws.isSettled(neighbor)) continue;
+            ws.relax(neighbor, d + edgeWeight[e], d + edgeWeight[e], current);
         }
     }
-    
-    // Reconstruir camino
-    if (distances[endNode] != std::numeric_limits<double>::max()) {
-        route.found = true;
-        route.totalDistance = distances[endNode];
-        
-        // Reconstruir desde el final
-        int current = endNode;
-        while (current != startNode) {
-            route.nodeIds.push_back(current);
-            route.path.push_back(nodes.at(current).position);
-            current = predecessors[current];
-        }
-        route.nodeIds.push_back(startNode);
-        route.path.push_back(nodes.at(startNode).position);
-        
-        // Invertir para tener el orden correcto
-        std::reverse(route.nodeIds.begin(), route.nodeIds.end());
-        std::reverse(route.path.begin(), route.path.end());
+    return result;
+}
+
+UnitRanking Graph::nearestByNetworkIER(const Point& p, int k, const UnitIndex& units) const {
+    UnitRanking result;
+    EdgeSnap source;
+    if (k <= 0 || units.getGraph() != this || units.size() == 0 || !snapToEdge(p, source)) {
+        return result;
+    }
+    k = std::min(k, units.size());
+
+    // Las distancias euclidianas se miden entre puntos ya ubicados en la red
+    Point origin = getSnapPosition(source, true);
+    const PackedRTree& index = units.getEuclideanIndex();
+    index.nearestFirst(origin, [&](size_t leaf, double euclidean) {
+        if ((int)result.units.size() == k && euclidean >= result.distances.back()) return false;
+
+        int unit = (int)index.getLeaf(leaf).offset;
+        Route route = routeBetween(p, units.getPosition(unit), true, nullptr);
+        result.verifiedUnits++;
+        result.settledNodes += route.settledNodes;
+        if (!route.found) return true;
+
+        // Inserción ordenada en las k mejores
+        size_t pos = std::upper_bound(result.distances.begin(), result.distances.end(),
+                                      route.totalDistance) - result.distances.begin();
+        if ((int)pos >= k) return true;
+        result.units.insert(result.units.begin() + pos, unit);
+        result.distances.insert(result.distances.begin() + pos, route.totalDistance);
+        if ((int)result.units.size() > k) {
+            result.units.pop_back();
+            result.distances.pop_back();
+        }
+        return true;
+    });
+    return result;
+}
+
+Route Graph::routeBetween(const Point& start, const Point& end, bool useHeuristic,
+                          const Landmarks* landmarks) const {
+    EdgeSnap source, target;
+    if (!snapToEdge(start, source) || !snapToEdge(end, target)) {
+        return Route();
     }
-    
+
+    // El destino es un nodo virtual (id n) sobre su arista; se llega a él
+    // desde cualquiera de los dos extremos con el costo parcial
+    int n = getNodeCount();
+    int goal = n;
+    Point goalMetric = edgePoint(target.edge, target.from, target.t, true);
+    double sourceWeight = edgeWeight[source.edge];
+    double targetWeight = edgeWeight[target.edge];
+
+    Landmarks::Target landmarkTarget;
+    if (landmarks) landmarks->prepare(source, target, landmarkTarget);
+
+    // g: costo real desde inicio (distancia del espacio de búsqueda)
+    // f: g + heurística (prioridad en la cola; 0 en Dijkstra)
+    SearchWorkspace& ws = SearchWorkspace::forThread();
+    ws.prepare(n + 1);
+
+    auto relax = [&](int from, int to, double g) {
+        if (g >= ws.distance(to)) return;
+        double h = 0.0;
+        if (useHeuristic && to != goal) {
+            // Ambas cotas son admisibles: vale la mayor
+            h = heuristic(to, goalMetric);
+            if (landmarks) h = std::max(h, landmarks->lowerBound(to, landmarkTarget));
+        }
+        ws.relax(to, g, g + h, from);
+    };
+
+    // Semillas: ambos extremos de la arista de origen
+    relax(-1, source.from, source.t * sourceWeight);
+    relax(-1, source.to, (1 - source.t) * sourceWeight);
+
+    // Origen y destino sobre la misma arista: también se puede ir directo
+    if (source.edge == target.edge) {
+        relax(-1, goal, std::fabs(source.t - target.t) * sourceWeight);
+    }
+
+    int settled = 0;
+    while (!ws.empty()) {
+        int current = ws.pop();
+        settled++;
+
+        if (current == goal) break;
+
+        // Desde un extremo de la arista de destino se llega al punto final
+        if (current == target.from) {
+            relax(current, goal, ws.distance(current) + target.t * targetWeight);
+        }
+        if (current == target.to) {
+            relax(current, goal, ws.distance(current) + (1 - target.t) * targetWeight);
+        }
+
+        for (int e = firstEdge[current]; e < firstEdge[current + 1]; e++) {
+            int neighbor = edgeTarget[e];
+            if (ws.isSettled(neighbor)) continue;
+            relax(current, neighbor, ws.distance(current) + edgeWeight[e]);
+        }
+    }
+
+    if (ws.distance(goal) == SearchWorkspace::INF) {
+        Route none;
+        none.settledNodes = settled;
+        return none;
+    }
+
+    Route route;
+    route.found = true;
+    route.settledNodes = settled;
+    route.totalDistance = ws.distance(goal);
+
+    // Reconstruir desde el final e invertir para tener el orden correcto
+    for (int current = ws.predecessor(goal); current != -1; current = ws.predecessor(current)) {
+        route.nodeIds.push_back(current);
+    }
+    std::reverse(route.nodeIds.begin(), route.nodeIds.end());
+    buildRoutePath(source, target, route);
     return route;
 }
 
-Route Graph::findAStarPath(const Point& start, const Point& end) {
+Route Graph::findBidirectionalPath(const Point& start, const Point& end, bool useHeuristic) const {
+    EdgeSnap source, target;
+    if (!snapToEdge(start, source) || !snapToEdge(end, target)) {
+        return Route();
+    }
+
+    // Puntos de origen y destino en coordenadas proyectadas
+    const EdgeSnap* snaps[2] = {&source, &target};
+    Point ends[2];
+    for (int side = 0; side < 2; side++) {
+        const EdgeSnap& s = *snaps[side];
+        ends[side] = edgePoint(s.edge, s.from, s.t, true);
+    }
+
+    // Potencial del lado 0 (hacia adelante); el lado 1 usa el opuesto. Como
+    // ambos suman cero, la búsqueda puede cortar cuando la suma de los dos
+    // mínimos de las colas alcanza la mejor ruta encontrada
+    auto potential = [&](int node, int side) {
+        if (!useHeuristic) return 0.0;
+        double forward = (heuristic(node, ends[1]) - heuristic(node, ends[0])) / 2;
+        return side == 0 ? forward : -forward;
+    };
+
+    const double INF = SearchWorkspace::INF;
+    SearchWorkspace* ws[2] = {&SearchWorkspace::forThread(0), &SearchWorkspace::forThread(1)};
+    ws[0]->prepare(getNodeCount());
+    ws[1]->prepare(getNodeCount());
+
+    // Mejor ruta encontrada y nodo de encuentro (-1 = misma arista, directo)
+    double best = INF;
+    int meet = -1;
+    if (source.edge == target.edge) {
+        best = std::fabs(source.t - target.t) * edgeWeight[source.edge];
+    }
+
+    auto relax = [&](int side, int from, int to, double d) {
+        if (d >= ws[side]->distance(to)) return;
+        ws[side]->relax(to, d, d + potential(to, side), from);
+        double other = ws[1 - side]->distance(to);
+        if (other != INF && d + other < best) {
+            best = d + other;
+            meet = to;
+        }
+    };
+
+    // Semillas: extremos de la arista de origen (lado 0) y de destino (lado 1)
+    for (int side = 0; side < 2; side++) {
+        const EdgeSnap& s = *snaps[side];
+        double w = edgeWeight[s.edge];
+        relax(side, -1, s.from, s.t * w);
+        relax(side, -1, s.to, (1 - s.t) * w);
+    }
+
+    int settled = 0;
+    while (!ws[0]->empty() && !ws[1]->empty()) {
+        if (ws[0]->topKey() + ws[1]->topKey() >= best) break;
+
+        // Se avanza el frente con el menor mínimo
+        int side = ws[0]->topKey() <= ws[1]->topKey() ? 0 : 1;
+        int current = ws[side]->pop();
+        settled++;
+
+        for (int e = firstEdge[current]; e < firstEdge[current + 1]; e++) {
+            int neighbor = edgeTarget[e];
+            if (ws[side]->isSettled(neighbor)) continue;
+            relax(side, current, neighbor, ws[side]->distance(current) + edgeWeight[e]);
+        }
+    }
+
     Route route;
-    
-    int startNode = findNearestNode(start);
-    int endNode = findNearestNode(end);
-    
-    if (startNode == -1 || endNode == -1) {
-        return route;
-    }
-    
-    // g: costo real desde inicio
-    // f: g + heurística (costo estimado total)
-    std::map<int, double> gScore;
-    std::map<int, double> fScore;
-    std::map<int, int> predecessors;
-    std::set<int> closedSet;
-    
-    // Inicializar scores
-    for (const auto& pair : nodes) {
-        gScore[pair.first] = std::numeric_limits<double>::max();
-        fScore[pair.first] = std::numeric_limits<double>::max();
-    }
-    gScore[startNode] = 0;
-    fScore[startNode] = heuristic(nodes.at(startNode).position, nodes.at(endNode).position);
-    
-    // Cola de prioridad: (fScore, nodo)
-    std::priority_queue<std::pair<double, int>,
-                       std::vector<std::pair<double, int>>,
-                       std::greater<std::pair<double, int>>> openSet;
-    openSet.push({fScore[startNode], startNode});
-    
-    // A*
-    while (!openSet.empty()) {
-        int current = openSet.top().second;
-        openSet.pop();
-        
-        if (closedSet.count(current)) continue;
-        closedSet.insert(current);
-        
-        if (current == endNode) {
-            // Reconstruir camino
-            route.found = true;
-            route.totalDistance = gScore[endNode];
-            
-            int node = endNode;
-            while (node != startNode) {
-                route.nodeIds.push_back(node);
-                route.path.push_back(nodes.at(node).position);
-                node = predecessors[node];
+    route.settledNodes = settled;
+    if (best == INF) return route;
+
+    route.found = true;
+    route.totalDistance = best;
+    if (meet != -1) {
+        for (int v = meet; v != -1; v = ws[0]->predecessor(v)) route.nodeIds.push_back(v);
+        std::reverse(route.nodeIds.begin(), route.nodeIds.end());
+        for (int v = ws[1]->predecessor(meet); v != -1; v = ws[1]->predecessor(v)) {
+            route.nodeIds.push_back(v);
+        }
+    }
+    buildRoutePath(source, target, route);
+    return route;
+}
+
+DistanceMatrix Graph::distanceMatrix(const std::vector<Point>& sources,
+                                     const std::vector<Point>& targets) const {
+    DistanceMatrix matrix((int)sources.size(), (int)targets.size());
+    if (sources.empty() || targets.empty() || getNodeCount() == 0) return matrix;
+
+    // Ubicar todos los puntos sobre la red una sola vez (edge = -1: sin calle)
+    std::vector<EdgeSnap> sourceSnaps(sources.size()), targetSnaps(targets.size());
+    for (size_t i = 0; i < sources.size(); i++) snapToEdge(sources[i], sourceSnaps[i]);
+    for (size_t j = 0; j < targets.size(); j++) snapToEdge(targets[j], targetSnaps[j]);
+
+    // Nodos que cada fila debe asentar: extremos de las aristas de destino
+    std::vector<char> isEndpoint(getNodeCount(), 0);
+    int endpointCount = 0;
+    for (const EdgeSnap& t : targetSnaps) {
+        if (t.edge == -1) continue;
+        for (int v : {t.from, t.to}) {
+            if (!isEndpoint[v]) {
+                isEndpoint[v] = 1;
+                endpointCount++;
+            }
+        }
+    }
+
+    int threads = std::min(resolveThreadCount(threadCount), (int)sources.size());
+    parallelForThreads((int)sources.size(), threads, [&](int i, int) {
+        if (sourceSnaps[i].edge == -1) return;
+        distanceRow(sourceSnaps[i], targetSnaps, isEndpoint, endpointCount,
+                    SearchWorkspace::forThread(), &matrix.values[(size_t)i * matrix.cols]);
+    });
+    return matrix;
+}
+
+void Graph::distanceRow(const EdgeSnap& source, const std::vector<EdgeSnap>& targets,
+                        const std::vector<char>& isEndpoint, int endpointCount,
+                        SearchWorkspace& ws, double* row) const {
+    ws.prepare(getNodeCount());
+    auto relax = [&](int v, double d) { ws.relax(v, d, d, -1); };
+
+    double w = edgeWeight[source.edge];
+    relax(source.from, source.t * w);
+    relax(source.to, (1 - source.t) * w);
+
+    // Un solo Dijkstra para toda la fila: termina al asentar todos los extremos
+    int pending = endpointCount;
+    while (!ws.empty() && pending > 0) {
+        int u = ws.pop();
+        double d = ws.distance(u);
+        if (isEndpoint[u]) pending--;
+
+        for (int e = firstEdge[u]; e < firstEdge[u + 1]; e++) {
+            relax(edgeTarget[e], d + edgeWeight[e]);
+        }
+    }
+
+    const double INF = SearchWorkspace::INF;
+    for (size_t j = 0; j < targets.size(); j++) {
+        const EdgeSnap& t = targets[j];
+        if (t.edge == -1) continue;
+
+        double best = INF;
+        double tw = edgeWeight[t.edge];
+        if (ws.distance(t.from) != INF) best = std::min(best, ws.distance(t.from) + t.t * tw);
+        if (ws.distance(t.to) != INF) best = std::min(best, ws.distance(t.to) + (1 - t.t) * tw);
+        if (t.edge == source.edge) best = std::min(best, std::fabs(source.t - t.t) * tw);
+        if (best != INF) row[j] = best;
+    }
+}
+
+std::vector<Isochrone> Graph::isochrone(const Point& origin, const std::vector<double>& budgets,
+                                        double cellSize) const {
+    return isochroneWith(origin, budgets, cellSize, SearchWorkspace::forThread());
+}
+
+std::vector<std::vector<Isochrone>> Graph::isochrones(const std::vector<Point>& origins,
+                                                      const std::vector<double>& budgets,
+                                                      double cellSize) const {
+    std::vector<std::vector<Isochrone>> result(origins.size());
+    if (origins.empty()) return result;
+
+    int threads = std::min(resolveThreadCount(threadCount), (int)origins.size());
+    parallelForThreads((int)origins.size(), threads, [&](int i, int) {
+        result[i] = isochroneWith(origins[i], budgets, cellSize, SearchWorkspace::forThread());
+    });
+    return result;
+}
+
+std::vector<Isochrone> Graph::isochroneWith(const Point& origin, const std::vector<double>& budgets,
+                                            double cellSize, SearchWorkspace& ws) const {
+    std::vector<Isochrone> result(budgets.size());
+    for (size_t k = 0; k < budgets.size(); k++) result[k].budget = budgets[k];
+
+    EdgeSnap source;
+    if (budgets.empty() || budgets.size() >= NOT_REACHED || !snapToEdge(origin, source)) {
+        return result;
+    }
+
+    // Presupuestos de menor a mayor: el nivel de una celda es el índice del
+    // menor presupuesto que la alcanza
+    std::vector<int> byBudget(budgets.size());
+    for (size_t k = 0; k < budgets.size(); k++) byBudget[k] = (int)k;
+    std::sort(byBudget.begin(), byBudget.end(),
+              [&](int a, int b) { return budgets[a] < budgets[b]; });
+    std::vector<double> sorted;
+    for (int k : byBudget) sorted.push_back(budgets[k]);
+    double maxBudget = sorted.back();
+    if (!(maxBudget > 0)) return result;
+
+    // Dijkstra acotado: sólo se asientan nodos dentro del mayor presupuesto
+    ws.prepare(getNodeCount());
+    auto relax = [&](int v, double d) {
+        if (d <= maxBudget) ws.relax(v, d, d, -1);
+    };
+
+    double sourceWeight = edgeWeight[source.edge];
+    relax(source.from, source.t * sourceWeight);
+    relax(source.to, (1 - source.t) * sourceWeight);
+
+    std::vector<int> reached;
+    while (!ws.empty()) {
+        int u = ws.pop();
+        double d = ws.distance(u);
+        reached.push_back(u);
+
+        for (int e = firstEdge[u]; e < firstEdge[u + 1]; e++) {
+            relax(edgeTarget[e], d + edgeWeight[e]);
+        }
+    }
+
+    // Rejilla centrada en el origen: la distancia de red nunca es menor que
+    // la euclidiana, así que todo lo alcanzable cae dentro del radio
+    double minCell = maxBudget / ISOCHRONE_MAX_CELLS;
+    double cell = cellSize > 0 ? std::max(cellSize, minCell) : maxBudget / ISOCHRONE_AUTO_CELLS;
+    int radius = (int)std::ceil(maxBudget / cell) + 4;
+    int size = 2 * radius + 1;
+    Point originMetric = edgePoint(source.edge, source.from, source.t, true);
+    double gridX = originMetric.x - (radius + 0.5) * cell;
+    double gridY = originMetric.y - (radius + 0.5) * cell;
+    std::vector<unsigned char> level((size_t)size * size, NOT_REACHED);
+
+    // Recorre el tramo a -> b hasta 'length' marcando cada celda con el
+    // primer presupuesto que cubre la llegada (arrival + avance)
+    auto markSegment = [&](double ax, double ay, double bx, double by,
+                           double segmentLength, double arrival, double length) {
+        int steps = std::max(1, (int)std::ceil(length / (cell * 0.5)));
+        for (int i = 0; i <= steps; i++) {
+            double s = length * i / steps;
+            double f = segmentLength > 0 ? s / segmentLength : 0;
+            int cx = (int)std::floor((ax + f * (bx - ax) - gridX) / cell);
+            int cy = (int)std::floor((ay + f * (by - ay) - gridY) / cell);
+            if (cx < 0 || cy < 0 || cx >= size || cy >= size) continue;
+            unsigned char k = 0;
+            while (k < sorted.size() && sorted[k] < arrival + s) k++;
+            if (k == sorted.size()) break;
+            unsigned char& c = level[(size_t)cy * size + cx];
+            c = std::min(c, k);
+        }
+    };
+
+    // Recorre la polilínea de la arista entre las fracciones t0 y t1,
+    // tramo a tramo, llegando a t0 con 'arrival'
+    std::vector<Point> section;
+    auto markEdge = [&](int edge, int from, double t0, double t1, double arrival) {
+        section.clear();
+        section.push_back(edgePoint(edge, from, t0, true));
+        edgeSection(edge, from, t0, t1, true, section);
+        section.push_back(edgePoint(edge, from, t1, true));
+        for (size_t i = 0; i + 1 < section.size() && arrival <= maxBudget; i++) {
+            const Point& a = section[i];
+            const Point& b = section[i + 1];
+            double segment = a.distanceTo(b);
+            markSegment(a.x, a.y, b.x, b.y, segment, arrival, std::min(segment, maxBudget - arrival));
+            arrival += segment;
+        }
+    };
+
+    // Tramos de la arista del origen hacia sus dos extremos
+    markEdge(source.edge, source.from, source.t, 0.0, 0);
+    markEdge(source.edge, source.from, source.t, 1.0, 0);
+
+    // Aristas salientes de cada nodo alcanzado, completas o hasta agotar el presupuesto
+    for (int u : reached) {
+        for (int e = firstEdge[u]; e < firstEdge[u + 1]; e++) {
+            markEdge(e, u, 0.0, 1.0, ws.distance(u));
+        }
+    }
+
+    // Las calles son líneas: se ensanchan dos celdas y se recortan una
+    // (cierre morfológico), así el área cubre las manzanas entre calles
+    // alcanzadas sin crecer más de una celda hacia afuera
+    auto filter = [&](const std::vector<unsigned char>& in, int radius, bool dilate) {
+        std::vector<unsigned char> out(in.size(), NOT_REACHED);
+        for (int y = radius; y < size - radius; y++) {
+            for (int x = radius; x < size - radius; x++) {
+                unsigned char value = dilate ? NOT_REACHED : 0;
+                for (int dy = -radius; dy <= radius; dy++) {
+                    for (int dx = -radius; dx <= radius; dx++) {
+                        unsigned char c = in[(size_t)(y + dy) * size + (x + dx)];
+                        value = dilate ? std::min(value, c) : std::max(value, c);
+                    }
+                }
+                out[(size_t)y * size + x] = value;
             }
-            route.nodeIds.push_back(startNode);
-            route.path.push_back(nodes.at(startNode).position);
-            
-            std::reverse(route.nodeIds.begin(), route.nodeIds.end());
-            std::reverse(route.path.begin(), route.path.end());
-            
-            return route;
-        }
-        
-        const GraphNode& node = nodes.at(current);
-        for (size_t i = 0; i < node.neighbors.size(); i++) {
-            int neighbor = node.neighbors[i];
-            
-            if (closedSet.count(neighbor)) continue;
-            
-            double tentativeGScore = gScore[current] + node.weights[i];
-            
-            if (tentativeGScore < gScore[neighbor]) {
-                predecessors[neighbor] = current;
-                gScore[neighbor] = tentativeGScore;
-                fScore[neighbor] = gScore[neighbor] + 
-                                  heuristic(nodes.at(neighbor).position, nodes.at(endNode).position);
-                openSet.push({fScore[neighbor], neighbor});
+        }
+        return out;
+    };
+    std::vector<unsigned char> area = filter(filter(level, 2, true), 1, false);
+
+    // Bordes de cada presupuesto: lados entre celda dentro y fuera, orientados
+    // con el interior a la izquierda, encadenados en anillos
+    static const int DX[4] = {1, 0, -1, 0};
+    static const int DY[4] = {0, 1, 0, -1};
+    int vertices = (size + 1) * (size + 1);
+    std::vector<int> outgoing((size_t)vertices * 2);
+    std::vector<int> sideStart, sideDir;
+    std::vector<char> used;
+
+    for (size_t k = 0; k < sorted.size(); k++) {
+        Isochrone& iso = result[byBudget[k]];
+        iso.reachedNodes = 0;
+        for (int u : reached) {
+            if (ws.distance(u) <= sorted[k]) iso.reachedNodes++;
+        }
+
+        auto inside = [&](int x, int y) {
+            return x >= 0 && y >= 0 && x < size && y < size && area[(size_t)y * size + x] <= k;
+        };
+
+        std::fill(outgoing.begin(), outgoing.end(), -1);
+        sideStart.clear();
+        sideDir.clear();
+        int cells = 0;
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                if (!inside(x, y)) continue;
+                cells++;
+                // Vértice inicial de cada lado recorriendo la celda en sentido antihorario
+                const int startX[4] = {x, x + 1, x + 1, x};
+                const int startY[4] = {y, y, y + 1, y + 1};
+                const int neighborX[4] = {x, x + 1, x, x - 1};
+                const int neighborY[4] = {y - 1, y, y + 1, y};
+                for (int dir = 0; dir < 4; dir++) {
+                    if (inside(neighborX[dir], neighborY[dir])) continue;
+                    int vertex = startY[dir] * (size + 1) + startX[dir];
+                    int slot = outgoing[(size_t)vertex * 2] == -1 ? 0 : 1;
+                    outgoing[(size_t)vertex * 2 + slot] = (int)sideStart.size();
+                    sideStart.push_back(vertex);
+                    sideDir.push_back(dir);
+                }
+            }
+        }
+        iso.area = cells * cell * cell;
+
+        used.assign(sideStart.size(), 0);
+        for (size_t first = 0; first < sideStart.size(); first++) {
+            if (used[first]) continue;
+
+            std::vector<Point> ring;
+            int side = (int)first;
+            int previousDir = -1;
+            while (side != -1 && !used[side]) {
+                used[side] = 1;
+                int dir = sideDir[side];
+                if (dir != previousDir) {
+                    // Sólo las esquinas: los lados colineales no agregan vértices
+                    int vx = sideStart[side] % (size + 1), vy = sideStart[side] / (size + 1);
+                    ring.push_back(projection.inverse(Point(gridX + vx * cell, gridY + vy * cell)));
+                }
+                previousDir = dir;
+
+                int vx = sideStart[side] % (size + 1) + DX[dir];
+                int vy = sideStart[side] / (size + 1) + DY[dir];
+                int vertex = vy * (size + 1) + vx;
+                int a = outgoing[(size_t)vertex * 2], b = outgoing[(size_t)vertex * 2 + 1];
+                // En un vértice con dos salidas (celdas en diagonal) se gira a la izquierda
+                if (b != -1 && !used[b] && (used[a] || sideDir[b] == (dir + 1) % 4)) a = b;
+                side = (a != -1 && !used[a]) ? a : -1;
+            }
+            // El primer vértice sobra si el último lado sigue la misma dirección
+            if (ring.size() > 1 && previousDir == sideDir[first]) ring.erase(ring.begin());
+            if (ring.size() >= 3) {
+                ring.push_back(ring.front());
+                iso.rings.push_back(ring);
             }
         }
     }
-    
-    return route;
+
+    return result;
+}
+
+uint64_t Graph::fingerprint() const {
+    // FNV-1a sobre la adyacencia y los pesos
+    Fnv1a hash;
+    hash.mix((uint64_t)getNodeCount());
+    for (int u = 0; u < getNodeCount(); u++) {
+        hash.mix((uint64_t)firstEdge[u + 1]);
+        for (int e = firstEdge[u]; e < firstEdge[u + 1]; e++) {
+            hash.mix((uint64_t)edgeTarget[e]);
+            hash.mixDouble(edgeWeight[e]);
+        }
+    }
+    return hash.hash;
+}
+
+uint64_t Graph::sourceChecksum(const std::vector<Geometry>& geometries) const {
+    std::vector<const Geometry*> refs;
+    refs.reserve(geometries.size());
+    for (const auto& geom : geometries) refs.push_back(&geom);
+    return checksumOf(refs);
+}
+
+uint64_t Graph::sourceChecksum(const std::deque<Geometry>& geometries) const {
+    std::vector<const Geometry*> refs;
+    refs.reserve(geometries.size());
+    for (const auto& geom : geometries) refs.push_back(&geom);
+    return checksumOf(refs);
+}
+
+uint64_t Graph::checksumOf(const std::vector<const Geometry*>& geometries) const {
+    Fnv1a hash;
+    hash.mixDouble(snapThreshold);
+    hash.mix((uint64_t)simplifyChains);
+    hash.mix((uint64_t)spatialOrder);
+
+    // Los parámetros de la proyección son privados: entra por su tipo y por
+    // dónde deja dos puntos fijos
+    hash.mix((uint64_t)projection.getType());
+    hash.mix((uint64_t)projection.getZone());
+    Point a = projection.forward(Point(0, 0));
+    Point b = projection.forward(Point(1, 1));
+    hash.mixDouble(a.x);
+    hash.mixDouble(a.y);
+    hash.mixDouble(b.x);
+    hash.mixDouble(b.y);
+
+    // Sólo las líneas que usa build, con sus vértices e IDs OSM
+    for (const Geometry* geom : geometries) {
+        if (geom->type != GEOM_LINESTRING || geom->points.size() < 2) continue;
+        hash.mix((uint64_t)geom->points.size());
+        for (const auto& p : geom->points) {
+            hash.mixDouble(p.x);
+            hash.mixDouble(p.y);
+        }
+        hash.mix((uint64_t)geom->nodeIds.size());
+        for (long long id : geom->nodeIds) hash.mix((uint64_t)id);
+    }
+    return hash.hash;
+}
+
+bool Graph::saveSnapshot(const std::string& filename, uint64_t source) const {
+    if (getNodeCount() == 0) return false;
+
+    static_assert(std::is_trivially_copyable<Projection>::value,
+                  "la proyección se guarda byte a byte");
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    std::vector<uint8_t> nodeTree, edgeTree;
+    nodeIndex.serialize(nodeTree);
+    edgeIndex.serialize(edgeTree);
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, GRAPH_MAGIC, 6);
+    header.magic[6] = GRAPH_VERSION;
+    header.source = source;
+    header.nodeCount = (uint64_t)getNodeCount();
+    header.edgeCount = (uint64_t)getEdgeCount();
+    header.shapeCount = (uint64_t)shapeX.size();
+    header.nodeLeaves = (uint64_t)nodeIndex.size();
+    header.edgeLeaves = (uint64_t)edgeIndex.size();
+    header.indexNodeSize = nodeIndex.getNodeSize();
+    header.projectionBytes = sizeof(Projection);
+    file.write((const char*)&header, sizeof(header));
+
+    size_t n = nodeX.size(), arcs = edgeTarget.size(), shapes = shapeX.size();
+    writeSection(file, nodeX.data(), n * sizeof(double));
+    writeSection(file, nodeY.data(), n * sizeof(double));
+    writeSection(file, metricX.data(), n * sizeof(double));
+    writeSection(file, metricY.data(), n * sizeof(double));
+    writeSection(file, firstEdge.data(), (n + 1) * sizeof(int));
+    writeSection(file, edgeTarget.data(), arcs * sizeof(int));
+    writeSection(file, edgeWeight.data(), arcs * sizeof(double));
+    writeSection(file, edgeRef.data(), arcs * sizeof(int));
+    writeSection(file, shapeFirst.data(), shapeFirst.size() * sizeof(int));
+    writeSection(file, shapeX.data(), shapes * sizeof(double));
+    writeSection(file, shapeY.data(), shapes * sizeof(double));
+    writeSection(file, shapeMetricX.data(), shapes * sizeof(double));
+    writeSection(file, shapeMetricY.data(), shapes * sizeof(double));
+    writeSection(file, nodeTree.data(), nodeTree.size());
+    writeSection(file, edgeTree.data(), edgeTree.size());
+    writeSection(file, &projection, sizeof(Projection));
+    return file.good();
+}
+
+bool Graph::openSnapshot(const std::string& filename, uint64_t source) {
+    std::shared_ptr<MappedFile> file(new MappedFile());
+    if (!file->open(filename) || file->size() < sizeof(SnapshotHeader)) return false;
+
+    SnapshotHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, GRAPH_MAGIC, 6) != 0 || header.magic[6] != GRAPH_VERSION ||
+        header.source != source || header.projectionBytes != sizeof(Projection)) {
+        return false;
+    }
+
+    // Los conteos deben caber en ids int y explicar exactamente el tamaño
+    const uint64_t MAX_COUNT = (uint64_t)std::numeric_limits<int>::max() / 2;
+    if (header.nodeCount == 0 || header.nodeCount > MAX_COUNT || header.edgeCount > MAX_COUNT ||
+        header.shapeCount > MAX_COUNT || header.indexNodeSize < 2 ||
+        header.indexNodeSize > 0xffff || header.nodeLeaves != header.nodeCount ||
+        header.edgeLeaves != header.edgeCount) {
+        return false;
+    }
+    size_t n = (size_t)header.nodeCount, m = (size_t)header.edgeCount;
+    size_t arcs = 2 * m, shapes = (size_t)header.shapeCount;
+    uint16_t indexNodeSize = (uint16_t)header.indexNodeSize;
+    size_t nodeTreeBytes = PackedRTree::serializedSize(n, indexNodeSize);
+    size_t edgeTreeBytes = PackedRTree::serializedSize(m, indexNodeSize);
+
+    size_t sections[] = {
+        n * sizeof(double), n * sizeof(double), n * sizeof(double), n * sizeof(double),
+        (n + 1) * sizeof(int), arcs * sizeof(int), arcs * sizeof(double), arcs * sizeof(int),
+        (m + 1) * sizeof(int), shapes * sizeof(double), shapes * sizeof(double),
+        shapes * sizeof(double), shapes * sizeof(double), nodeTreeBytes, edgeTreeBytes,
+        sizeof(Projection)
+    };
+    uint64_t expected = sizeof(SnapshotHeader);
+    for (size_t bytes : sections) expected += alignedSize(bytes);
+    if (expected != file->size()) return false;
+
+    // Punteros a cada sección dentro del mapeo, en el orden de saveSnapshot
+    uint8_t* cursor = file->data() + sizeof(SnapshotHeader);
+    uint8_t* at[sizeof(sections) / sizeof(sections[0])];
+    for (size_t i = 0; i < sizeof(sections) / sizeof(sections[0]); i++) {
+        at[i] = cursor;
+        cursor += alignedSize(sections[i]);
+    }
+
+    // Extremos del CSR y de las formas: descartan un archivo truncado o
+    // con conteos cruzados sin recorrer los arreglos
+    const int* first = (const int*)at[4];
+    const int* shapeStart = (const int*)at[8];
+    if (first[0] != 0 || first[n] != (int)arcs || shapeStart[0] != 0 ||
+        shapeStart[m] != (int)shapes) {
+        return false;
+    }
+
+    // Una pasada lineal por los índices: el archivo puede estar dañado con
+    // la cabecera intacta, y las consultas los usan sin comprobar rangos
+    const int* target = (const int*)at[5];
+    const double* weight = (const double*)at[6];
+    const int* ref = (const int*)at[7];
+    for (size_t u = 0; u < n; u++) {
+        if (first[u] > first[u + 1]) return false;
+    }
+    for (size_t e = 0; e < arcs; e++) {
+        if (target[e] < 0 || (size_t)target[e] >= n || ref[e] < 0 || (size_t)(ref[e] >> 1) >= m ||
+            !std::isfinite(weight[e]) || weight[e] < 0) {
+            return false;
+        }
+    }
+    for (size_t id = 0; id < m; id++) {
+        if (shapeStart[id] > shapeStart[id + 1]) return false;
+    }
+
+    clear();
+    nodeX.attach(file, (double*)at[0], n);
+    nodeY.attach(file, (double*)at[1], n);
+    metricX.attach(file, (double*)at[2], n);
+    metricY.attach(file, (double*)at[3], n);
+    firstEdge.attach(file, (int*)at[4], n + 1);
+    edgeTarget.attach(file, (int*)at[5], arcs);
+    edgeWeight.attach(file, (double*)at[6], arcs);
+    edgeRef.attach(file, (int*)at[7], arcs);
+    shapeFirst.attach(file, (int*)at[8], m + 1);
+    shapeX.attach(file, (double*)at[9], shapes);
+    shapeY.attach(file, (double*)at[10], shapes);
+    shapeMetricX.attach(file, (double*)at[11], shapes);
+    shapeMetricY.attach(file, (double*)at[12], shapes);
+    if (!nodeIndex.attach(file, at[13], nodeTreeBytes, n, indexNodeSize) ||
+        !edgeIndex.attach(file, at[14], edgeTreeBytes, m, indexNodeSize)) {
+        clear();
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (nodeIndex.getLeaf(i).offset >= n) {
+            clear();
+            return false;
+        }
+    }
+    for (size_t i = 0; i < m; i++) {
+        if (edgeIndex.getLeaf(i).offset >= arcs) {
+            clear();
+            return false;
+        }
+    }
+    std::memcpy(&projection, at[15], sizeof(Projection));
+    buildPartitions = 0;
+    return true;
 }
 
 void Graph::printStats() const {
     std::cout << "=== Estadisticas del Grafo ===" << std::endl;
     std::cout << "Nodos: " << getNodeCount() << std::endl;
     std::cout << "Aristas: " << getEdgeCount() << std::endl;
-    
+    std::cout << "Vertices intermedios: " << getShapePointCount() << std::endl;
+
     // Calcular grado promedio
-    int totalDegree = 0;
-    for (const auto& pair : nodes) {
-        totalDegree += pair.second.neighbors.size();
-    }
-    double avgDegree = nodes.empty() ? 0 : (double)totalDegree / nodes.size();
+    double avgDegree = getNodeCount() == 0 ? 0 : (double)edgeTarget.size() / getNodeCount();
     std::cout << "Grado promedio: " << avgDegree << std::endl;
-}
\ No newline at end of file
+}
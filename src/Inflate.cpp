@@ -0,0 +1,272 @@
+#include "../include/Inflate.h"
+
+namespace {
+
+// Lector de bits LSB-first sobre el buffer comprimido
+struct BitReader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    uint32_t bitBuf;
+    int bitCount;
+    bool overflow;
+
+    BitReader(const uint8_t* d, size_t s)
+        : data(d), size(s), pos(0), bitBuf(0), bitCount(0), overflow(false) {}
+
+    int bits(int need) {
+        uint32_t val = bitBuf;
+        while (bitCount < need) {
+            if (pos >= size) {
+                overflow = true;
+                return 0;
+            }
+            val |= (uint32_t)data[pos++] << bitCount;
+            bitCount += 8;
+        }
+        bitBuf = val >> need;
+        bitCount -= need;
+        return (int)(val & ((1u << need) - 1));
+    }
+
+    void alignToByte() {
+        bitBuf = 0;
+        bitCount = 0;
+    }
+};
+
+const int MAX_BITS = 15;
+
+// Tabla de Huffman canónica: cantidad de códigos por longitud y símbolos ordenados
+struct Huffman {
+    short count[MAX_BITS + 1];
+    short symbol[288];
+};
+
+// Construye la tabla; devuelve < 0 si el conjunto de longitudes está sobresuscrito
+int buildHuffman(Huffman& h, const short* length, int n) {
+    for (int len = 0; len <= MAX_BITS; len++) h.count[len] = 0;
+    for (int s = 0; s < n; s++) h.count[length[s]]++;
+    if (h.count[0] == n) return 0;
+
+    int left = 1;
+    for (int len = 1; len <= MAX_BITS; len++) {
+        left <<= 1;
+        left -= h.count[len];
+        if (left < 0) return left;
+    }
+
+    short offs[MAX_BITS + 1];
+    offs[1] = 0;
+    for (int len = 1; len < MAX_BITS; len++) {
+        offs[len + 1] = offs[len] + h.count[len];
+    }
+    for (int s = 0; s < n; s++) {
+        if (length[s] != 0) h.symbol[offs[length[s]]++] = (short)s;
+    }
+    return left;
+}
+
+int decodeSymbol(BitReader& br, const Huffman& h) {
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len <= MAX_BITS; len++) {
+        code |= br.bits(1);
+        if (br.overflow) return -1;
+        int count = h.count[len];
+        if (code - count < first) {
+            return h.symbol[index + (code - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+const short LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const short LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const short DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577};
+const short DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+bool inflateCodes(BitReader& br, std::vector<uint8_t>& out,
+                  const Huffman& lencode, const Huffman& distcode) {
+    while (true) {
+        int symbol = decodeSymbol(br, lencode);
+        if (symbol < 0) return false;
+
+        if (symbol < 256) {
+            out.push_back((uint8_t)symbol);
+        } else if (symbol == 256) {
+            return true;
+        } else {
+            symbol -= 257;
+            if (symbol >= 29) return false;
+            int len = LENGTH_BASE[symbol] + br.bits(LENGTH_EXTRA[symbol]);
+
+            int distSymbol = decodeSymbol(br, distcode);
+            if (distSymbol < 0 || distSymbol >= 30) return false;
+            size_t dist = DIST_BASE[distSymbol] + br.bits(DIST_EXTRA[distSymbol]);
+            if (br.overflow || dist > out.size()) return false;
+
+            // Copia byte a byte: la referencia puede solaparse con lo que se escribe
+            size_t from = out.size() - dist;
+            for (int i = 0; i < len; i++) {
+                out.push_back(out[from + i]);
+            }
+        }
+    }
+}
+
+bool inflateStored(BitReader& br, std::vector<uint8_t>& out) {
+    br.alignToByte();
+    if (br.pos + 4 > br.size) return false;
+
+    unsigned len = br.data[br.pos] | (br.data[br.pos + 1] << 8);
+    unsigned nlen = br.data[br.pos + 2] | (br.data[br.pos + 3] << 8);
+    br.pos += 4;
+    if (len != (~nlen & 0xffff)) return false;
+    if (br.pos + len > br.size) return false;
+
+    out.insert(out.end(), br.data + br.pos, br.data + br.pos + len);
+    br.pos += len;
+    return true;
+}
+
+struct FixedTables {
+    Huffman lencode, distcode;
+
+    FixedTables() {
+        short lengths[288];
+        int s = 0;
+        for (; s < 144; s++) lengths[s] = 8;
+        for (; s < 256; s++) lengths[s] = 9;
+        for (; s < 280; s++) lengths[s] = 7;
+        for (; s < 288; s++) lengths[s] = 8;
+        buildHuffman(lencode, lengths, 288);
+
+        for (s = 0; s < 30; s++) lengths[s] = 5;
+        buildHuffman(distcode, lengths, 30);
+    }
+};
+
+bool inflateFixed(BitReader& br, std::vector<uint8_t>& out) {
+    // Inicialización estática segura entre hilos (los bloques se descomprimen en paralelo)
+    static const FixedTables tables;
+    return inflateCodes(br, out, tables.lencode, tables.distcode);
+}
+
+bool inflateDynamic(BitReader& br, std::vector<uint8_t>& out) {
+    static const short ORDER[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+    int nlen = br.bits(5) + 257;
+    int ndist = br.bits(5) + 1;
+    int ncode = br.bits(4) + 4;
+    if (br.overflow || nlen > 286 || ndist > 30) return false;
+
+    short lengths[320];
+    int index = 0;
+    for (; index < ncode; index++) lengths[ORDER[index]] = (short)br.bits(3);
+    for (; index < 19; index++) lengths[ORDER[index]] = 0;
+
+    Huffman lencode, distcode;
+    if (buildHuffman(lencode, lengths, 19) != 0) return false;
+
+    // Longitudes de los códigos literal/longitud y distancia
+    index = 0;
+    while (index < nlen + ndist) {
+        int symbol = decodeSymbol(br, lencode);
+        if (symbol < 0) return false;
+
+        if (symbol < 16) {
+            lengths[index++] = (short)symbol;
+        } else {
+            short len = 0;
+            int repeat;
+            if (symbol == 16) {
+                if (index == 0) return false;
+                len = lengths[index - 1];
+                repeat = 3 + br.bits(2);
+            } else if (symbol == 17) {
+                repeat = 3 + br.bits(3);
+            } else {
+                repeat = 11 + br.bits(7);
+            }
+            if (index + repeat > nlen + ndist) return false;
+            while (repeat--) lengths[index++] = len;
+        }
+    }
+
+    if (lengths[256] == 0) return false;
+
+    // Se permiten códigos incompletos sólo si tienen un único símbolo
+    int err = buildHuffman(lencode, lengths, nlen);
+    if (err < 0 || (err > 0 && nlen - lencode.count[0] != 1)) return false;
+
+    err = buildHuffman(distcode, lengths + nlen, ndist);
+    if (err < 0 || (err > 0 && ndist - distcode.count[0] != 1)) return false;
+
+    return inflateCodes(br, out, lencode, distcode);
+}
+
+} // namespace
+
+bool inflateRaw(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    BitReader br(data, size);
+
+    int last;
+    do {
+        last = br.bits(1);
+        int type = br.bits(2);
+        if (br.overflow) return false;
+
+        bool ok;
+        switch (type) {
+            case 0: ok = inflateStored(br, out); break;
+            case 1: ok = inflateFixed(br, out); break;
+            case 2: ok = inflateDynamic(br, out); break;
+            default: ok = false; break;
+        }
+        if (!ok) return false;
+    } while (!last);
+
+    return true;
+}
+
+bool inflateZlib(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+                 size_t expectedSize) {
+    if (size < 6) return false;
+
+    // CMF/FLG: método 8 (deflate) y checksum de cabecera múltiplo de 31
+    int cmf = data[0];
+    int flg = data[1];
+    if ((cmf & 0x0f) != 8 || ((cmf << 8) | flg) % 31 != 0) return false;
+    if (flg & 0x20) return false;  // Diccionario preestablecido no soportado
+
+    out.clear();
+    if (expectedSize > 0) out.reserve(expectedSize);
+
+    if (!inflateRaw(data + 2, size - 2, out)) return false;
+
+    // Verificar Adler-32 al final del stream
+    const uint8_t* tail = data + size - 4;
+    uint32_t expected = ((uint32_t)tail[0] << 24) | ((uint32_t)tail[1] << 16) |
+                        ((uint32_t)tail[2] << 8) | (uint32_t)tail[3];
+
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < out.size(); i++) {
+        a = (a + out[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return ((b << 16) | a) == expected;
+}
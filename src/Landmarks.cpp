@@ -0,0 +1,297 @@
+#include "../include/Landmarks.h"
+#include <fstream>
+#include <cstring>
+#include <cmath>
+#include <queue>
+#include <limits>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+const double INF = std::numeric_limits<double>::max();
+const uint32_t UNREACHABLE = 0xFFFFFFFFu;
+
+const char LANDMARK_MAGIC[6] = {'R', 'T', 'L', 'M', 0, 0};
+const uint8_t LANDMARK_VERSION = 1;
+
+// Dijkstra completo desde source. Devuelve los nodos en orden de asentamiento
+// y, si se pide, el árbol de caminos mínimos.
+void shortestDistances(const Graph& g, int source, std::vector<double>& dist,
+                       std::vector<int>& order, std::vector<int>* parent) {
+    int n = g.getNodeCount();
+    dist.assign(n, INF);
+    order.clear();
+    if (parent) parent->assign(n, -1);
+
+    std::priority_queue<std::pair<double, int>,
+                        std::vector<std::pair<double, int>>,
+                        std::greater<std::pair<double, int>>> queue;
+    dist[source] = 0;
+    queue.push({0, source});
+
+    while (!queue.empty()) {
+        double d = queue.top().first;
+        int u = queue.top().second;
+        queue.pop();
+        if (d > dist[u]) continue;
+        order.push_back(u);
+
+        for (int e = g.getEdgeBegin(u); e < g.getEdgeEnd(u); e++) {
+            int v = g.getEdgeTarget(e);
+            double nd = d + g.getEdgeWeight(e);
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                if (parent) (*parent)[v] = u;
+                queue.push({nd, v});
+            }
+        }
+    }
+}
+
+// Nodo alcanzable más lejano de los landmarks ya elegidos
+int farthestNode(const std::vector<double>& nearest, const std::vector<int>& reachable) {
+    int best = -1;
+    for (int v : reachable) {
+        if (best == -1 || nearest[v] > nearest[best]) best = v;
+    }
+    return best;
+}
+
+} // namespace
+
+Landmarks::Landmarks()
+    : graph(nullptr), graphFingerprint(0), selection(LANDMARK_AVOID), scale(1) {}
+
+void Landmarks::clear() {
+    graph = nullptr;
+    graphFingerprint = 0;
+    landmarkNodes.clear();
+    table.clear();
+    scale = 1;
+}
+
+void Landmarks::build(const Graph& g, int count, LandmarkSelection sel) {
+    clear();
+    int n = g.getNodeCount();
+    if (n == 0 || count <= 0) return;
+    count = std::min(count, n);
+    selection = sel;
+
+    std::mt19937 rng(20240611);
+    std::uniform_int_distribution<int> pick(0, n - 1);
+
+    // Distancias exactas de cada landmark (se pasan a punto fijo al final)
+    std::vector<std::vector<double>> exact;
+    std::vector<double> nearest(n, INF);  // Distancia al landmark más cercano
+    std::vector<char> isLandmark(n, 0);
+    std::vector<double> dist;
+    std::vector<int> order, parent;
+
+    auto addLandmark = [&](int node) {
+        landmarkNodes.push_back(node);
+        isLandmark[node] = 1;
+        exact.emplace_back();
+        shortestDistances(g, node, exact.back(), order, nullptr);
+        for (int v = 0; v < n; v++) nearest[v] = std::min(nearest[v], exact.back()[v]);
+    };
+
+    // Primer landmark: el nodo más lejano de uno al azar
+    shortestDistances(g, pick(rng), dist, order, nullptr);
+    addLandmark(farthestNode(dist, order));
+
+    while ((int)landmarkNodes.size() < count) {
+        int next = -1;
+
+        if (sel == LANDMARK_FARTHEST) {
+            shortestDistances(g, landmarkNodes.back(), dist, order, nullptr);
+            next = farthestNode(nearest, order);
+        } else {
+            // Árbol de caminos mínimos desde una raíz al azar. Peso de cada
+            // nodo: cuánto subestima la cota actual su distancia a la raíz.
+            // Se baja por los subárboles de mayor peso sin landmarks hasta
+            // una hoja, que pasa a ser el nuevo landmark.
+            int root = pick(rng);
+            shortestDistances(g, root, dist, order, &parent);
+
+            std::vector<double> size(n, 0);
+            std::vector<char> covered(n, 0);  // Subárbol con algún landmark
+            for (size_t k = order.size(); k-- > 0;) {
+                int v = order[k];
+                double bound = 0;
+                for (const auto& d : exact) {
+                    if (d[v] != INF && d[root] != INF) {
+                        bound = std::max(bound, std::fabs(d[root] - d[v]));
+                    }
+                }
+                if (isLandmark[v]) covered[v] = 1;
+                size[v] = covered[v] ? 0 : size[v] + dist[v] - bound;
+                if (parent[v] != -1) {
+                    size[parent[v]] += size[v];
+                    if (covered[v]) covered[parent[v]] = 1;
+                }
+            }
+
+            std::vector<std::vector<int>> children(n);
+            int start = -1;
+            for (int v : order) {
+                if (parent[v] != -1) children[parent[v]].push_back(v);
+                if (size[v] > 0 && (start == -1 || size[v] > size[start])) start = v;
+            }
+            next = start;
+            while (next != -1) {
+                int child = -1;
+                for (int c : children[next]) {
+                    if (size[c] > 0 && (child == -1 || size[c] > size[child])) child = c;
+                }
+                if (child == -1) break;
+                next = child;
+            }
+            if (next == -1 || isLandmark[next]) next = farthestNode(nearest, order);
+        }
+
+        if (next == -1 || isLandmark[next]) break;  // No quedan nodos útiles
+        addLandmark(next);
+    }
+
+    // Punto fijo: la mayor distancia finita ocupa casi todo el rango
+    int k = (int)landmarkNodes.size();
+    double maxDistance = 0;
+    for (const auto& d : exact) {
+        for (double value : d) {
+            if (value != INF) maxDistance = std::max(maxDistance, value);
+        }
+    }
+    scale = maxDistance > 0 ? maxDistance / (double)(UNREACHABLE - 1) : 1;
+
+    table.assign((size_t)n * k, UNREACHABLE);
+    for (int i = 0; i < k; i++) {
+        for (int v = 0; v < n; v++) {
+            if (exact[i][v] != INF) {
+                table[(size_t)v * k + i] = (uint32_t)std::llround(exact[i][v] / scale);
+            }
+        }
+    }
+
+    graph = &g;
+    graphFingerprint = g.fingerprint();
+}
+
+double Landmarks::distance(int landmark, int node) const {
+    uint32_t q = table[(size_t)node * landmarkNodes.size() + landmark];
+    return q == UNREACHABLE ? -1 : q * scale;
+}
+
+double Landmarks::targetDistance(int landmark, const EdgeSnap& target) const {
+    // Punto sobre una arista: se llega por cualquiera de sus extremos
+    double w = graph->getEdgeWeight(target.edge);
+    double a = distance(landmark, target.from);
+    double b = distance(landmark, target.to);
+    if (a < 0 || b < 0) return -1;
+    return std::min(a + target.t * w, b + (1 - target.t) * w);
+}
+
+void Landmarks::prepare(const EdgeSnap& source, const EdgeSnap& target, Target& out) const {
+    out.activeCount = 0;
+    if (!graph) return;
+
+    // Los landmarks con mejor cota entre origen y destino
+    std::vector<std::pair<double, int>> ranked;
+    for (int i = 0; i < getCount(); i++) {
+        double ds = targetDistance(i, source);
+        double dt = targetDistance(i, target);
+        if (ds < 0 || dt < 0) continue;
+        ranked.push_back({std::fabs(dt - ds), i});
+    }
+    int active = std::min((int)ranked.size(), (int)ACTIVE_LANDMARKS);
+    std::partial_sort(ranked.begin(), ranked.begin() + active, ranked.end(),
+                      std::greater<std::pair<double, int>>());
+
+    for (int k = 0; k < active; k++) {
+        out.active[k] = ranked[k].second;
+        out.distance[k] = targetDistance(ranked[k].second, target);
+    }
+    out.activeCount = active;
+}
+
+double Landmarks::lowerBound(int node, const Target& target) const {
+    const uint32_t* row = &table[(size_t)node * landmarkNodes.size()];
+    double bound = 0;
+    for (int k = 0; k < target.activeCount; k++) {
+        uint32_t q = row[target.active[k]];
+        if (q == UNREACHABLE) continue;
+        bound = std::max(bound, std::fabs(target.distance[k] - q * scale));
+    }
+    // Redondeo del punto fijo: medio paso en cada una de las dos distancias
+    return std::max(0.0, bound - scale);
+}
+
+bool Landmarks::save(const std::string& filename) const {
+    if (!isReady()) return false;
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    uint8_t header[8] = {0};
+    std::memcpy(header, LANDMARK_MAGIC, 6);
+    header[6] = LANDMARK_VERSION;
+    header[7] = (uint8_t)selection;
+    uint32_t nodeCount = (uint32_t)graph->getNodeCount();
+    uint32_t count = (uint32_t)landmarkNodes.size();
+
+    file.write((const char*)header, sizeof(header));
+    file.write((const char*)&nodeCount, sizeof(nodeCount));
+    file.write((const char*)&count, sizeof(count));
+    file.write((const char*)&scale, sizeof(scale));
+    file.write((const char*)&graphFingerprint, sizeof(graphFingerprint));
+    file.write((const char*)landmarkNodes.data(), count * sizeof(int));
+    file.write((const char*)table.data(), table.size() * sizeof(uint32_t));
+    return file.good();
+}
+
+bool Landmarks::load(const std::string& filename, const Graph& g) {
+    clear();
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    uint8_t header[8];
+    uint32_t nodeCount = 0, count = 0;
+    double storedScale = 0;
+    uint64_t storedFingerprint = 0;
+    if (!file.read((char*)header, sizeof(header)) ||
+        std::memcmp(header, LANDMARK_MAGIC, 6) != 0 || header[6] != LANDMARK_VERSION ||
+        header[7] > LANDMARK_AVOID ||
+        !file.read((char*)&nodeCount, sizeof(nodeCount)) ||
+        !file.read((char*)&count, sizeof(count)) ||
+        !file.read((char*)&storedScale, sizeof(storedScale)) ||
+        !file.read((char*)&storedFingerprint, sizeof(storedFingerprint))) {
+        return false;
+    }
+
+    // Sólo sirve para el grafo con el que se construyó
+    if (nodeCount != (uint32_t)g.getNodeCount() || count == 0 || count > nodeCount ||
+        !(storedScale > 0) || storedFingerprint != g.fingerprint()) {
+        return false;
+    }
+
+    landmarkNodes.resize(count);
+    table.resize((size_t)nodeCount * count);
+    if (!file.read((char*)landmarkNodes.data(), count * sizeof(int)) ||
+        !file.read((char*)table.data(), table.size() * sizeof(uint32_t))) {
+        clear();
+        return false;
+    }
+    for (int node : landmarkNodes) {
+        if (node < 0 || node >= (int)nodeCount) {
+            clear();
+            return false;
+        }
+    }
+
+    selection = (LandmarkSelection)header[7];
+    scale = storedScale;
+    graphFingerprint = storedFingerprint;
+    graph = &g;
+    return true;
+}
@@ -0,0 +1,158 @@
+#include "../include/LayerManager.h"
+#include <algorithm>
+
+Layer& LayerManager::append(const std::string& name, std::vector<Geometry> geoms) {
+    Layer* layer = getLayer(name);
+    if (!layer) {
+        layers.push_back(std::unique_ptr<Layer>(new Layer(name)));
+        layer = layers.back().get();
+    }
+
+    for (auto& geom : geoms) {
+        layer->geometries.push_back(std::move(geom));
+        layer->index.insert(&layer->geometries.back());
+    }
+    layer->lod.build(layer->geometries);
+    return *layer;
+}
+
+Layer& LayerManager::replace(const std::string& name, std::vector<Geometry> geoms) {
+    Layer* layer = getLayer(name);
+    if (layer) {
+        layer->index.clear();
+        layer->geometries.clear();
+    }
+    return append(name, std::move(geoms));
+}
+
+bool LayerManager::drop(const std::string& name) {
+    for (size_t i = 0; i < layers.size(); i++) {
+        if (layers[i]->name == name) {
+            layers.erase(layers.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void LayerManager::clear() {
+    layers.clear();
+}
+
+Layer* LayerManager::getLayer(const std::string& name) {
+    for (auto& layer : layers) {
+        if (layer->name == name) return layer.get();
+    }
+    return nullptr;
+}
+
+const Layer* LayerManager::getLayer(const std::string& name) const {
+    for (const auto& layer : layers) {
+        if (layer->name == name) return layer.get();
+    }
+    return nullptr;
+}
+
+void LayerManager::collectTargets(const std::vector<std::string>& names,
+                                  std::vector<Layer*>& out) {
+    if (names.empty()) {
+        for (auto& layer : layers) {
+            if (layer->visible) out.push_back(layer.get());
+        }
+        return;
+    }
+
+    for (const auto& name : names) {
+        Layer* layer = getLayer(name);
+        if (layer) out.push_back(layer);
+    }
+}
+
+std::vector<Geometry*> LayerManager::rangeSearch(const Rect& range,
+                                                 const std::vector<std::string>& names) {
+    std::vector<Layer*> targets;
+    collectTargets(names, targets);
+
+    std::vector<Geometry*> results;
+    for (Layer* layer : targets) {
+        std::vector<Geometry*> found = layer->index.rangeSearch(range);
+        results.insert(results.end(), found.begin(), found.end());
+    }
+    return results;
+}
+
+std::vector<Geometry*> LayerManager::kNNSearch(const Point& queryPoint, int k,
+                                               const std::vector<std::string>& names) {
+    std::vector<Layer*> targets;
+    collectTargets(names, targets);
+
+    // Los k mejores globales están entre los k mejores de cada capa
+    std::vector<std::pair<double, Geometry*>> candidates;
+    for (Layer* layer : targets) {
+        for (Geometry* geom : layer->index.kNNSearch(queryPoint, k)) {
+            candidates.push_back(std::make_pair(geom->minDistance(queryPoint), geom));
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<double, Geometry*>& a, const std::pair<double, Geometry*>& b) {
+                  return a.first < b.first;
+              });
+
+    std::vector<Geometry*> results;
+    for (int i = 0; i < k && i < (int)candidates.size(); i++) {
+        results.push_back(candidates[i].second);
+    }
+    return results;
+}
+
+std::vector<Geometry> LayerManager::collectGeometries() const {
+    std::vector<Geometry> result;
+    for (const auto& layer : layers) {
+        if (!layer->visible) continue;
+        result.insert(result.end(), layer->geometries.begin(), layer->geometries.end());
+    }
+    return result;
+}
+
+Rect LayerManager::getBounds() const {
+    Rect bounds;
+    bool first = true;
+    for (const auto& layer : layers) {
+        if (layer->geometries.empty()) continue;
+
+        // El MBR de la raíz cubre toda la capa
+        const Rect& layerBounds = layer->index.getRoot()->mbr;
+        if (first) {
+            bounds = layerBounds;
+            first = false;
+        } else {
+            bounds.expand(layerBounds);
+        }
+    }
+    return bounds;
+}
+
+int LayerManager::getGeometryCount() const {
+    int count = 0;
+    for (const auto& layer : layers) {
+        count += layer->index.getGeometryCount();
+    }
+    return count;
+}
+
+int LayerManager::getTreeHeight() const {
+    int height = 0;
+    for (const auto& layer : layers) {
+        height = std::max(height, layer->index.getHeight());
+    }
+    return height;
+}
+
+int LayerManager::getNodeCount() const {
+    int count = 0;
+    for (const auto& layer : layers) {
+        count += layer->index.getNodeCount();
+    }
+    return count;
+}
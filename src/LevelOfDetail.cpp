@@ -0,0 +1,159 @@
+#include "../include/LevelOfDetail.h"
+#include <algorithm>
+
+namespace {
+// Distancia de p al segmento ab
+double segmentDistance(const Point& p, const Point& a, const Point& b) {
+    double dx = b.x - a.x, dy = b.y - a.y;
+    double len2 = dx * dx + dy * dy;
+    if (len2 == 0) return p.distanceTo(a);
+    double u = ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2;
+    u = std::min(1.0, std::max(0.0, u));
+    return p.distanceTo(Point(a.x + u * dx, a.y + u * dy));
+}
+
+// Douglas-Peucker con pila explícita: conserva los extremos y, en cada
+// tramo, el vértice más alejado de la cuerda si supera la tolerancia
+void douglasPeucker(const std::vector<Point>& in, double tolerance,
+                    std::vector<char>& keep, std::vector<std::pair<size_t, size_t>>& stack,
+                    std::vector<Point>& out) {
+    out.clear();
+    if (in.size() < 3) {
+        out = in;
+        return;
+    }
+
+    keep.assign(in.size(), 0);
+    keep.front() = keep.back() = 1;
+    stack.clear();
+    stack.push_back(std::make_pair((size_t)0, in.size() - 1));
+    while (!stack.empty()) {
+        size_t a = stack.back().first, b = stack.back().second;
+        stack.pop_back();
+
+        double worst = -1;
+        size_t worstAt = a;
+        for (size_t i = a + 1; i < b; i++) {
+            double d = segmentDistance(in[i], in[a], in[b]);
+            if (d > worst) {
+                worst = d;
+                worstAt = i;
+            }
+        }
+        if (worst > tolerance) {
+            keep[worstAt] = 1;
+            stack.push_back(std::make_pair(a, worstAt));
+            stack.push_back(std::make_pair(worstAt, b));
+        }
+    }
+
+    for (size_t i = 0; i < in.size(); i++) {
+        if (keep[i]) out.push_back(in[i]);
+    }
+}
+}
+
+void LevelOfDetail::clear() {
+    levels.clear();
+}
+
+void LevelOfDetail::build(const std::deque<Geometry>& geometries) {
+    clear();
+
+    Rect extent;
+    bool first = true;
+    for (const auto& geom : geometries) {
+        if (geom.points.empty()) continue;
+        if (first) extent = geom.mbr;
+        else extent.expand(geom.mbr);
+        first = false;
+    }
+    double side = std::max(extent.maxX - extent.minX, extent.maxY - extent.minY);
+    if (first || side <= 0) return;
+
+    origin = Point(extent.minX, extent.minY);
+    levels.resize(LEVELS);
+    for (int k = 0; k < LEVELS; k++) {
+        levels[k].tolerance = side / 16384 * (1 << (2 * k));
+        levels[k].first.push_back(0);
+    }
+
+    // Cada geometría baja por todos los niveles: el nivel k simplifica la
+    // salida del k - 1, así el costo total es casi el del primer nivel
+    std::vector<Point> current, simplified;
+    std::vector<char> keep;
+    std::vector<std::pair<size_t, size_t>> stack;
+    for (const auto& geom : geometries) {
+        if (geom.points.empty()) continue;
+        current = geom.points;
+        double size = std::max(geom.mbr.maxX - geom.mbr.minX, geom.mbr.maxY - geom.mbr.minY);
+
+        for (int k = 0; k < LEVELS; k++) {
+            Level& level = levels[k];
+            if (geom.type != GEOM_POINT) {
+                // Cabe en un píxel del zoom al que se usa este nivel
+                if (size < 2 * level.tolerance) break;
+
+                douglasPeucker(current, level.tolerance, keep, stack, simplified);
+                current.swap(simplified);
+
+                bool closed = current.size() > 1 && current.front().x == current.back().x &&
+                              current.front().y == current.back().y;
+                size_t minimum = geom.type == GEOM_POLYGON ? (closed ? 4 : 3) : 2;
+                if (current.size() < minimum) break;
+            }
+
+            for (const auto& p : current) {
+                level.x.push_back((float)(p.x - origin.x));
+                level.y.push_back((float)(p.y - origin.y));
+            }
+            level.first.push_back((uint32_t)level.x.size());
+            level.source.push_back(&geom);
+        }
+    }
+
+    // Índice de cada nivel, hojas en orden de Hilbert
+    for (auto& level : levels) {
+        std::vector<std::pair<uint32_t, PackedRTreeItem>> items;
+        items.reserve(level.source.size());
+        for (size_t i = 0; i < level.source.size(); i++) {
+            PackedRTreeItem item;
+            item.box = level.source[i]->mbr;
+            item.offset = (uint64_t)i;
+            items.push_back(std::make_pair(PackedRTree::hilbertIndex(item.box.center(), extent), item));
+        }
+        std::sort(items.begin(), items.end(),
+                  [](const std::pair<uint32_t, PackedRTreeItem>& a,
+                     const std::pair<uint32_t, PackedRTreeItem>& b) { return a.first < b.first; });
+
+        std::vector<PackedRTreeItem> leaves;
+        leaves.reserve(items.size());
+        for (const auto& item : items) leaves.push_back(item.second);
+        level.index.build(leaves);
+    }
+}
+
+int LevelOfDetail::levelFor(double pixelSize) const {
+    int chosen = 0;
+    for (int k = 1; k <= (int)levels.size(); k++) {
+        if (levels[k - 1].tolerance <= pixelSize / 2) chosen = k;
+    }
+    return chosen;
+}
+
+void LevelOfDetail::search(int level, const Rect& range, std::vector<size_t>& out) const {
+    const Level& l = levels[level - 1];
+    std::vector<size_t> leaves;
+    l.index.search(range, leaves);
+    for (size_t leaf : leaves) out.push_back((size_t)l.index.getLeaf(leaf).offset);
+}
+
+size_t LevelOfDetail::getMemoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& l : levels) {
+        bytes += (l.x.size() + l.y.size()) * sizeof(float) + l.first.size() * sizeof(uint32_t) +
+                 l.source.size() * sizeof(const Geometry*) +
+                 PackedRTree::serializedSize(l.index.size(), l.index.getNodeSize());
+    }
+    return bytes;
+}
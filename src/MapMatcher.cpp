@@ -0,0 +1,357 @@
+#include "../include/MapMatcher.h"
+#include "../include/SearchWorkspace.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace {
+const double NO_ROUTE = std::numeric_limits<double>::infinity();
+const double IMPOSSIBLE = -std::numeric_limits<double>::infinity();
+
+// Los árboles se calculan con algo más de alcance que el pedido, así el
+// paso siguiente (con otra distancia entre puntos) casi siempre los reutiliza
+const double TREE_SLACK = 1.5;
+const size_t TREE_CAPACITY = 1024;
+}
+
+MapMatcher::MapMatcher(const Graph& g)
+    : graph(&g), gpsSigma(10), transitionBeta(20), searchRadius(50), maxDetour(300),
+      maxCandidates(8), maxLag(64), nextIndex(0), treeCapacity(TREE_CAPACITY), useClock(0),
+      cacheHits(0), cacheMisses(0) {}
+
+void MapMatcher::reset() {
+    pending.clear();
+    output.clear();
+    nextIndex = 0;
+}
+
+const MapMatcher::Tree& MapMatcher::treeFrom(int node, double bound) {
+    useClock++;
+    auto it = trees.find(node);
+    if (it != trees.end() && it->second.bound >= bound) {
+        cacheHits++;
+        it->second.lastUse = useClock;
+        return it->second;
+    }
+    cacheMisses++;
+
+    Tree& tree = trees[node];
+    tree.bound = bound * TREE_SLACK;
+    tree.lastUse = useClock;
+    tree.reached.clear();
+
+    // Dijkstra acotado: sólo los nodos a distancia <= bound
+    SearchWorkspace& ws = SearchWorkspace::forThread();
+    ws.prepare(graph->getNodeCount());
+    ws.relax(node, 0, 0, -1);
+    while (!ws.empty() && ws.topKey() <= tree.bound) {
+        int u = ws.pop();
+        double d = ws.distance(u);
+        tree.reached.push_back(std::make_pair(u, d));
+        for (int e = graph->getEdgeBegin(u); e < graph->getEdgeEnd(u); e++) {
+            int v = graph->getEdgeTarget(e);
+            if (ws.isSettled(v)) continue;
+            double nd = d + graph->getEdgeWeight(e);
+            ws.relax(v, nd, nd, u);
+        }
+    }
+    std::sort(tree.reached.begin(), tree.reached.end());
+    return tree;
+}
+
+double MapMatcher::routeDistance(const EdgeSnap& a, const EdgeSnap& b, double bound) {
+    double wa = graph->getEdgeWeight(a.edge);
+    double wb = graph->getEdgeWeight(b.edge);
+
+    // Sobre la misma arista se puede ir directo
+    double best = a.edge == b.edge ? std::fabs(a.t - b.t) * wa : NO_ROUTE;
+
+    int sources[2] = {a.from, a.to};
+    double sourceCost[2] = {a.t * wa, (1 - a.t) * wa};
+    int targets[2] = {b.from, b.to};
+    double targetCost[2] = {b.t * wb, (1 - b.t) * wb};
+
+    for (int i = 0; i < 2; i++) {
+        if (sourceCost[i] > bound) continue;
+        const Tree& tree = treeFrom(sources[i], bound - sourceCost[i]);
+        for (int j = 0; j < 2; j++) {
+            auto it = std::lower_bound(tree.reached.begin(), tree.reached.end(),
+                                       std::make_pair(targets[j], -NO_ROUTE));
+            if (it == tree.reached.end() || it->first != targets[j]) continue;
+            best = std::min(best, sourceCost[i] + it->second + targetCost[j]);
+        }
+    }
+    return best;
+}
+
+void MapMatcher::push(const Point& gps) {
+    // Entre pasos (nunca durante uno) se descarta la mitad menos usada del caché
+    if (trees.size() > treeCapacity) {
+        std::vector<uint64_t> uses;
+        uses.reserve(trees.size());
+        for (const auto& entry : trees) uses.push_back(entry.second.lastUse);
+        std::nth_element(uses.begin(), uses.begin() + uses.size() / 2, uses.end());
+        uint64_t cutoff = uses[uses.size() / 2];
+        for (auto it = trees.begin(); it != trees.end();) {
+            if (it->second.lastUse < cutoff) {
+                it = trees.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    Step step;
+    step.index = nextIndex++;
+    step.observed = gps;
+    step.metric = graph->getProjection().forward(gps);
+
+    // Sin calles cerca: se cierra el tramo anterior y el punto sale sin ajustar
+    graph->snapCandidates(gps, searchRadius, maxCandidates, found);
+    if (found.empty()) {
+        flush();
+        MatchedPoint point;
+        point.index = step.index;
+        point.position = gps;
+        output.push_back(point);
+        return;
+    }
+
+    if (!pending.empty() && pending.back().metric.distanceTo(step.metric) < 2 * gpsSigma) {
+        Follower follower;
+        follower.index = step.index;
+        follower.observed = gps;
+        follower.candidates = found;
+        pending.back().followers.push_back(follower);
+        return;
+    }
+
+    // Emisión: gaussiana sobre la distancia del GPS a la calle
+    std::vector<double> emission(found.size());
+    step.candidates.resize(found.size());
+    for (size_t j = 0; j < found.size(); j++) {
+        double z = found[j].distance / gpsSigma;
+        emission[j] = -0.5 * z * z;
+        step.candidates[j].snap = found[j];
+        step.candidates[j].score = emission[j];
+        step.candidates[j].previous = -1;
+    }
+
+    // Transición: |ruta - recta| con escala beta, desde el mejor antecesor
+    if (!pending.empty()) {
+        const Step& prev = pending.back();
+        double straight = prev.metric.distanceTo(step.metric);
+        double bound = straight + maxDetour;
+
+        bool connected = false;
+        for (auto& cand : step.candidates) {
+            double best = IMPOSSIBLE;
+            int from = -1;
+            for (size_t i = 0; i < prev.candidates.size(); i++) {
+                const Candidate& p = prev.candidates[i];
+                if (p.score == IMPOSSIBLE) continue;
+                double route = routeDistance(p.snap, cand.snap, bound);
+                if (route > bound) continue;
+                double score = p.score - std::fabs(route - straight) / transitionBeta;
+                if (score > best) {
+                    best = score;
+                    from = (int)i;
+                }
+            }
+            if (from == -1) {
+                cand.score = IMPOSSIBLE;
+            } else {
+                cand.score += best;
+                cand.previous = from;
+                connected = true;
+            }
+        }
+
+        // Ningún candidato se alcanza desde el punto anterior (salto del GPS
+        // o calle faltante): se decide lo anterior y se empieza de nuevo aquí
+        if (!connected) {
+            flush();
+            for (size_t j = 0; j < step.candidates.size(); j++) {
+                step.candidates[j].score = emission[j];
+                step.candidates[j].previous = -1;
+            }
+        }
+    }
+
+    // El mejor queda en 0: los puntajes no crecen sin límite en trazas largas
+    double top = IMPOSSIBLE;
+    for (const auto& cand : step.candidates) top = std::max(top, cand.score);
+    for (auto& cand : step.candidates) {
+        if (cand.score != IMPOSSIBLE) cand.score -= top;
+    }
+
+    pending.push_back(step);
+    decideConverged();
+}
+
+void MapMatcher::decideConverged() {
+    if (pending.empty()) return;
+
+    // Candidatos vivos del último punto y, hacia atrás, sus antecesores. El
+    // primer punto (desde el final) donde quedan todos en uno solo ya no
+    // puede cambiar: todo camino futuro pasa por él. Se entregan los
+    // anteriores y ese punto queda como raíz con su único candidato, así el
+    // siguiente tiene de dónde tomar la transición (y sus seguidores)
+    std::vector<int> alive, parents;
+    const Step& last = pending.back();
+    for (size_t j = 0; j < last.candidates.size(); j++) {
+        if (last.candidates[j].score != IMPOSSIBLE) alive.push_back((int)j);
+    }
+
+    for (size_t k = pending.size(); k-- > 0;) {
+        if (alive.size() == 1 && k > 0) {
+            Step& root = pending[k];
+            for (size_t j = 0; j < root.candidates.size(); j++) {
+                if ((int)j != alive[0]) root.candidates[j].score = IMPOSSIBLE;
+            }
+            decide(k, root.candidates[alive[0]].previous, alive[0]);
+            return;
+        }
+        if (k == 0) break;
+
+        parents.clear();
+        for (int c : alive) parents.push_back(pending[k].candidates[c].previous);
+        std::sort(parents.begin(), parents.end());
+        parents.erase(std::unique(parents.begin(), parents.end()), parents.end());
+        alive.swap(parents);
+    }
+
+    // Sin convergencia, el retraso se acota siguiendo el mejor camino actual
+    if ((int)pending.size() > maxLag && maxLag > 0) {
+        size_t count = pending.size() - maxLag;
+        int best = 0;
+        for (size_t j = 1; j < last.candidates.size(); j++) {
+            if (last.candidates[j].score > last.candidates[best].score) best = (int)j;
+        }
+        int after = best;
+        for (size_t k = pending.size() - 1; k >= count; k--) {
+            after = best;
+            best = pending[k].candidates[best].previous;
+        }
+        decide(count, best, after);
+    }
+}
+
+void MapMatcher::decide(size_t stepCount, int candidate, int nextCandidate) {
+    // Camino hacia atrás desde el candidato elegido
+    std::vector<int> chosen(stepCount);
+    int c = candidate;
+    for (size_t k = stepCount; k-- > 0;) {
+        chosen[k] = c;
+        c = pending[k].candidates[c].previous;
+    }
+
+    for (size_t k = 0; k < stepCount; k++) {
+        const Candidate& cand = pending[k].candidates[chosen[k]];
+        MatchedPoint point;
+        point.index = pending[k].index;
+        point.matched = true;
+        point.snap = cand.snap;
+        point.position = cand.snap.point;
+        output.push_back(point);
+
+        // Los seguidores van a la calle de este paso o, si ya la dejaron, a
+        // la del siguiente; si no pasan cerca de ninguna, a la más cercana
+        int here = graph->getEdgeId(cand.snap.edge);
+        int next = -1;
+        if (k + 1 < stepCount) {
+            next = graph->getEdgeId(pending[k + 1].candidates[chosen[k + 1]].snap.edge);
+        } else if (nextCandidate != -1) {
+            next = graph->getEdgeId(pending[stepCount].candidates[nextCandidate].snap.edge);
+        }
+        for (const auto& follower : pending[k].followers) {
+            const EdgeSnap* pick = &follower.candidates[0];
+            const EdgeSnap* onNext = nullptr;
+            for (const auto& option : follower.candidates) {
+                int id = graph->getEdgeId(option.edge);
+                if (id == here) {
+                    onNext = nullptr;
+                    pick = &option;
+                    break;
+                }
+                if (id == next && !onNext) onNext = &option;
+            }
+            if (onNext) pick = onNext;
+
+            MatchedPoint extra;
+            extra.index = follower.index;
+            extra.matched = true;
+            extra.snap = *pick;
+            extra.position = pick->point;
+            output.push_back(extra);
+        }
+    }
+
+    pending.erase(pending.begin(), pending.begin() + stepCount);
+    if (!pending.empty()) {
+        for (auto& cand : pending.front().candidates) cand.previous = -1;
+    }
+}
+
+void MapMatcher::flush() {
+    if (pending.empty()) return;
+
+    const Step& last = pending.back();
+    int best = 0;
+    for (size_t j = 1; j < last.candidates.size(); j++) {
+        if (last.candidates[j].score > last.candidates[best].score) best = (int)j;
+    }
+    decide(pending.size(), best);
+}
+
+void MapMatcher::finish() {
+    flush();
+}
+
+std::vector<MatchedPoint> MapMatcher::takeMatched() {
+    std::vector<MatchedPoint> result;
+    result.swap(output);
+    return result;
+}
+
+std::vector<MatchedPoint> MapMatcher::match(const std::vector<Point>& trace) {
+    reset();
+    for (const auto& p : trace) push(p);
+    finish();
+    return takeMatched();
+}
+
+SyntheticTrace MapMatcher::synthesize(const Graph& g, const Point& start, const Point& end,
+                                      double spacing, double noise, unsigned seed) {
+    SyntheticTrace trace;
+    Route route = g.findBidirectionalPath(start, end, true);
+    if (!route.found || route.path.size() < 2 || spacing <= 0) return trace;
+
+    const Projection& proj = g.getProjection();
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> gauss(0.0, noise > 0 ? noise : 1.0);
+
+    // Una muestra cada 'spacing' a lo largo de la ruta (coordenadas proyectadas)
+    double next = 0, walked = 0;
+    Point a = proj.forward(route.path[0]);
+    for (size_t i = 1; i < route.path.size(); i++) {
+        Point b = proj.forward(route.path[i]);
+        double segment = a.distanceTo(b);
+        while (next <= walked + segment) {
+            double u = segment > 0 ? (next - walked) / segment : 0.0;
+            Point onRoad(a.x + u * (b.x - a.x), a.y + u * (b.y - a.y));
+            Point noisy = onRoad;
+            if (noise > 0) {
+                noisy.x += gauss(rng);
+                noisy.y += gauss(rng);
+            }
+            trace.truth.push_back(proj.inverse(onRoad));
+            trace.observed.push_back(proj.inverse(noisy));
+            next += spacing;
+        }
+        walked += segment;
+        a = b;
+    }
+    return trace;
+}
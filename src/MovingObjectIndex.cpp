@@ -0,0 +1,438 @@
+#include "../include/MovingObjectIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <limits>
+
+namespace {
+double boxDistance(const Rect& box, const Point& p) {
+    double dx = std::max(0.0, std::max(box.minX - p.x, p.x - box.maxX));
+    double dy = std::max(0.0, std::max(box.minY - p.y, p.y - box.maxY));
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+int clampIndex(double v, int count) {
+    if (!(v > 0)) return 0;   // También NaN
+    if (v >= count - 1) return count - 1;
+    return (int)v;
+}
+}
+
+void MovingObjectIndex::MotionBound::expand(const Point& p, const Point& v, double t) {
+    // El punto se lleva al instante de referencia de la caja
+    Point q(p.x + v.x * (time - t), p.y + v.y * (time - t));
+    if (empty) {
+        box = Rect(q);
+        velocity = Rect(v);
+        empty = false;
+    } else {
+        box.expand(q);
+        velocity.expand(v);
+    }
+}
+
+void MovingObjectIndex::MotionBound::merge(const MotionBound& other) {
+    if (other.empty) return;
+    if (empty) {
+        box = other.at(time);
+        velocity = other.velocity;
+        empty = false;
+    } else {
+        box.expand(other.at(time));
+        velocity.expand(other.velocity);
+    }
+}
+
+Rect MovingObjectIndex::MotionBound::at(double t) const {
+    double dt = t - time;
+    if (dt >= 0) {
+        return Rect(box.minX + velocity.minX * dt, box.minY + velocity.minY * dt,
+                    box.maxX + velocity.maxX * dt, box.maxY + velocity.maxY * dt);
+    }
+    return Rect(box.minX + velocity.maxX * dt, box.minY + velocity.maxY * dt,
+                box.maxX + velocity.minX * dt, box.maxY + velocity.minY * dt);
+}
+
+MovingObjectIndex::MovingObjectIndex(const Rect& ext, double size, double predictionHorizon,
+                                     double speedLimit)
+    : extent(ext), cellSize(size > 0 ? size : 1), horizon(predictionHorizon > 0 ? predictionHorizon : 0),
+      motionCellSize(0), velocityStep(0), maxSpeed(speedLimit > 0 ? speedLimit : 1),
+      motionCols(0), motionRows(0), velocityClasses(0), blockCols(0), blockRows(0),
+      objectCount(0), latestTime(0) {
+    cols = std::max(1, (int)std::ceil((extent.maxX - extent.minX) / cellSize));
+    rows = std::max(1, (int)std::ceil((extent.maxY - extent.minY) / cellSize));
+    cells.resize((size_t)cols * rows);
+    if (horizon == 0) return;
+
+    // Para que cada celda predictiva tenga tantos objetos como una común,
+    // lado * paso de velocidad = cellSize * rango de velocidades; y para que
+    // a 'horizon' pesen igual la posición y la velocidad, lado = paso * horizon
+    double range = 2 * maxSpeed;
+    velocityStep = std::sqrt(cellSize * range / horizon);
+    motionCellSize = std::max(cellSize, velocityStep * horizon);
+    velocityClasses = std::max(1, (int)std::ceil(range / velocityStep));
+
+    motionCols = std::max(1, (int)std::ceil((extent.maxX - extent.minX) / motionCellSize));
+    motionRows = std::max(1, (int)std::ceil((extent.maxY - extent.minY) / motionCellSize));
+    blockCols = (motionCols + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    blockRows = (motionRows + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    size_t classes = (size_t)velocityClasses * velocityClasses;
+    motionCells.resize(classes * motionCols * motionRows);
+    motionBlocks.resize(classes * blockCols * blockRows);
+}
+
+double MovingObjectIndex::cellSizeFor(const Rect& extent, int expectedCount, int perCell) {
+    double area = (extent.maxX - extent.minX) * (extent.maxY - extent.minY);
+    int cellsWanted = std::max(1, expectedCount / std::max(1, perCell));
+    return area > 0 ? std::sqrt(area / cellsWanted) : 1.0;
+}
+
+int MovingObjectIndex::cellIndex(const Point& p) const {
+    int cx = clampIndex((p.x - extent.minX) / cellSize, cols);
+    int cy = clampIndex((p.y - extent.minY) / cellSize, rows);
+    return cy * cols + cx;
+}
+
+int MovingObjectIndex::motionCellIndex(const Point& p, const Point& v) const {
+    int vx = clampIndex((v.x + maxSpeed) / velocityStep, velocityClasses);
+    int vy = clampIndex((v.y + maxSpeed) / velocityStep, velocityClasses);
+    int cx = clampIndex((p.x - extent.minX) / motionCellSize, motionCols);
+    int cy = clampIndex((p.y - extent.minY) / motionCellSize, motionRows);
+    return ((vy * velocityClasses + vx) * motionRows + cy) * motionCols + cx;
+}
+
+int MovingObjectIndex::motionBlockOf(int motionCell) const {
+    int perClass = motionCols * motionRows;
+    int cls = motionCell / perClass;
+    int rest = motionCell % perClass;
+    int cy = rest / motionCols, cx = rest % motionCols;
+    return (cls * blockRows + cy / BLOCK_SIZE) * blockCols + cx / BLOCK_SIZE;
+}
+
+void MovingObjectIndex::blockCells(int block, std::vector<int>& out) const {
+    out.clear();
+    int perClass = blockCols * blockRows;
+    int cls = block / perClass;
+    int rest = block % perClass;
+    int by = rest / blockCols, bx = rest % blockCols;
+    int base = cls * motionCols * motionRows;
+    for (int cy = by * BLOCK_SIZE; cy < std::min(motionRows, (by + 1) * BLOCK_SIZE); cy++) {
+        for (int cx = bx * BLOCK_SIZE; cx < std::min(motionCols, (bx + 1) * BLOCK_SIZE); cx++) {
+            int cell = base + cy * motionCols + cx;
+            if (!motionCells[cell].items.empty()) out.push_back(cell);
+        }
+    }
+}
+
+void MovingObjectIndex::place(int id, const Point& position) {
+    int cell = cellIndex(position);
+    cellOf[id] = cell;
+    slotOf[id] = (int)cells[cell].size();
+    cells[cell].push_back(Item{position, id});
+    if (horizon > 0) placeMotion(id, position);
+}
+
+void MovingObjectIndex::unplace(int id) {
+    // Intercambio con el último: la lista no queda con huecos
+    std::vector<Item>& items = cells[cellOf[id]];
+    int slot = slotOf[id];
+    items[slot] = items.back();
+    slotOf[items[slot].id] = slot;
+    items.pop_back();
+    cellOf[id] = -1;
+    if (horizon > 0) unplaceMotion(id);
+}
+
+void MovingObjectIndex::touchMotion(int motionCell, const Point& position, int id) {
+    MotionCell& c = motionCells[motionCell];
+    MotionBlock& b = motionBlocks[motionBlockOf(motionCell)];
+    if (c.bound.empty) c.bound.time = times[id];
+    if (b.bound.empty) b.bound.time = times[id];
+    c.bound.expand(position, velocities[id], times[id]);
+    b.bound.expand(position, velocities[id], times[id]);
+    c.changes++;
+    b.changes++;
+}
+
+void MovingObjectIndex::placeMotion(int id, const Point& position) {
+    int cell = motionCellIndex(position, velocities[id]);
+    MotionCell& c = motionCells[cell];
+    motionOf[id] = cell;
+    motionSlotOf[id] = (int)c.items.size();
+    c.items.push_back(id);
+    motionBlocks[motionBlockOf(cell)].count++;
+    touchMotion(cell, position, id);
+}
+
+void MovingObjectIndex::unplaceMotion(int id) {
+    int cell = motionOf[id];
+    MotionCell& c = motionCells[cell];
+    int slot = motionSlotOf[id];
+    int last = c.items.back();
+    c.items[slot] = last;
+    motionSlotOf[last] = slot;
+    c.items.pop_back();
+
+    // La caja no se achica aquí (sigue acotando a los que quedan)
+    MotionBlock& b = motionBlocks[motionBlockOf(cell)];
+    b.count--;
+    b.changes++;
+    c.changes++;
+    motionOf[id] = -1;
+}
+
+int MovingObjectIndex::insert(const Point& position, double time, const Point& velocity) {
+    int id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        id = (int)cellOf.size();
+        velocities.push_back(Point());
+        times.push_back(0);
+        cellOf.push_back(-1);
+        slotOf.push_back(-1);
+        motionOf.push_back(-1);
+        motionSlotOf.push_back(-1);
+    }
+
+    velocities[id] = horizon > 0 ? velocity : Point();
+    times[id] = time;
+    latestTime = std::max(latestTime, time);
+    place(id, position);
+    objectCount++;
+    return id;
+}
+
+void MovingObjectIndex::update(int id, const Point& position, double time) {
+    if (!contains(id)) return;
+    update(id, position, velocities[id], time);
+}
+
+void MovingObjectIndex::update(int id, const Point& position, const Point& velocity, double time) {
+    if (!contains(id)) return;
+
+    times[id] = time;
+    latestTime = std::max(latestTime, time);
+
+    int cell = cellIndex(position);
+    if (cell == cellOf[id]) {
+        cells[cell][slotOf[id]].position = position;
+    } else {
+        std::vector<Item>& items = cells[cellOf[id]];
+        int slot = slotOf[id];
+        items[slot] = items.back();
+        slotOf[items[slot].id] = slot;
+        items.pop_back();
+
+        cellOf[id] = cell;
+        slotOf[id] = (int)cells[cell].size();
+        cells[cell].push_back(Item{position, id});
+    }
+
+    if (horizon > 0) {
+        velocities[id] = velocity;
+        int motionCell = motionCellIndex(position, velocity);
+        if (motionCell == motionOf[id]) {
+            touchMotion(motionCell, position, id);
+        } else {
+            unplaceMotion(id);
+            placeMotion(id, position);
+        }
+    }
+}
+
+void MovingObjectIndex::remove(int id) {
+    if (!contains(id)) return;
+    unplace(id);
+    freeIds.push_back(id);
+    objectCount--;
+}
+
+void MovingObjectIndex::clear() {
+    for (auto& c : cells) c.clear();
+    for (auto& c : motionCells) c = MotionCell();
+    for (auto& b : motionBlocks) b = MotionBlock();
+    velocities.clear();
+    times.clear();
+    cellOf.clear();
+    slotOf.clear();
+    motionOf.clear();
+    motionSlotOf.clear();
+    freeIds.clear();
+    objectCount = 0;
+    latestTime = 0;
+}
+
+Point MovingObjectIndex::getPositionAt(int id, double t) const {
+    Point p = getPosition(id);
+    double dt = t - times[id];
+    return Point(p.x + velocities[id].x * dt, p.y + velocities[id].y * dt);
+}
+
+void MovingObjectIndex::refreshCell(int motionCell) {
+    MotionCell& c = motionCells[motionCell];
+    if (c.changes <= (int)c.items.size()) return;
+
+    c.bound = MotionBound();
+    c.bound.time = latestTime;
+    for (int id : c.items) c.bound.expand(getPosition(id), velocities[id], times[id]);
+    c.changes = 0;
+}
+
+void MovingObjectIndex::refreshBlock(int block) {
+    MotionBlock& b = motionBlocks[block];
+    if (b.changes <= b.count) return;
+
+    std::vector<int> members;
+    blockCells(block, members);
+    b.bound = MotionBound();
+    b.bound.time = latestTime;
+    for (int cell : members) {
+        refreshCell(cell);
+        b.bound.merge(motionCells[cell].bound);
+    }
+    b.changes = 0;
+}
+
+void MovingObjectIndex::rangeSearch(const Rect& range, std::vector<int>& results) const {
+    results.clear();
+    if (objectCount == 0) return;
+
+    int x0 = clampIndex((range.minX - extent.minX) / cellSize, cols);
+    int x1 = clampIndex((range.maxX - extent.minX) / cellSize, cols);
+    int y0 = clampIndex((range.minY - extent.minY) / cellSize, rows);
+    int y1 = clampIndex((range.maxY - extent.minY) / cellSize, rows);
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            const std::vector<Item>& items = cells[cy * cols + cx];
+            // Celdas interiores al rango: todos entran sin comparar
+            bool inside = cx > x0 && cx < x1 && cy > y0 && cy < y1;
+            for (const Item& item : items) {
+                if (inside || range.contains(item.position)) results.push_back(item.id);
+            }
+        }
+    }
+}
+
+std::vector<int> MovingObjectIndex::kNNSearch(const Point& p, int k) const {
+    std::vector<int> result;
+    if (k <= 0 || objectCount == 0) return result;
+
+    // Máximo de los k mejores hasta ahora
+    std::priority_queue<std::pair<double, int>> best;
+    int cell = cellIndex(p);
+    int cx = cell % cols, cy = cell / cols;
+
+    for (int r = 0;; r++) {
+        // Anillo r: celdas a distancia de Chebyshev r de la celda del punto
+        for (int y = cy - r; y <= cy + r; y++) {
+            if (y < 0 || y >= rows) continue;
+            bool edgeRow = y == cy - r || y == cy + r;
+            for (int x = cx - r; x <= cx + r; x += edgeRow ? 1 : 2 * r) {
+                if (x >= 0 && x < cols) {
+                    for (const Item& item : cells[y * cols + x]) {
+                        double d = p.distanceTo(item.position);
+                        if ((int)best.size() < k) {
+                            best.push(std::make_pair(d, item.id));
+                        } else if (d < best.top().first) {
+                            best.pop();
+                            best.push(std::make_pair(d, item.id));
+                        }
+                    }
+                }
+                if (r == 0) break;
+            }
+        }
+
+        // Lo que queda afuera del cuadrado de anillos 0..r está al menos a
+        // la distancia del punto a sus lados interiores (los lados sobre el
+        // borde de la rejilla siguen hasta el infinito: las celdas del borde
+        // guardan también a los objetos que salieron de la extensión)
+        double beyond = std::numeric_limits<double>::infinity();
+        if (cx - r > 0) beyond = std::min(beyond, p.x - (extent.minX + (cx - r) * cellSize));
+        if (cx + r < cols - 1) beyond = std::min(beyond, extent.minX + (cx + r + 1) * cellSize - p.x);
+        if (cy - r > 0) beyond = std::min(beyond, p.y - (extent.minY + (cy - r) * cellSize));
+        if (cy + r < rows - 1) beyond = std::min(beyond, extent.minY + (cy + r + 1) * cellSize - p.y);
+
+        if (beyond == std::numeric_limits<double>::infinity()) break;
+        if ((int)best.size() == k && best.top().first <= beyond) break;
+    }
+
+    result.resize(best.size());
+    for (size_t i = result.size(); i-- > 0;) {
+        result[i] = best.top().second;
+        best.pop();
+    }
+    return result;
+}
+
+void MovingObjectIndex::rangeSearchAt(const Rect& range, double t, std::vector<int>& results) {
+    if (horizon == 0) {
+        rangeSearch(range, results);
+        return;
+    }
+    results.clear();
+    if (objectCount == 0) return;
+
+    std::vector<int> members;
+    for (int block = 0; block < (int)motionBlocks.size(); block++) {
+        if (motionBlocks[block].count == 0) continue;
+        refreshBlock(block);
+        if (!motionBlocks[block].bound.at(t).intersects(range)) continue;
+
+        blockCells(block, members);
+        for (int cell : members) {
+            refreshCell(cell);
+            if (!motionCells[cell].bound.at(t).intersects(range)) continue;
+            for (int id : motionCells[cell].items) {
+                if (range.contains(getPositionAt(id, t))) results.push_back(id);
+            }
+        }
+    }
+}
+
+std::vector<int> MovingObjectIndex::kNNSearchAt(const Point& p, int k, double t) {
+    if (horizon == 0) return kNNSearch(p, k);
+
+    std::vector<int> result;
+    if (k <= 0 || objectCount == 0) return result;
+
+    // Best-first sobre bloques, celdas y objetos (cajas estimadas en t)
+    enum { BLOCK, CELL, OBJECT };
+    struct Entry {
+        double dist;
+        int kind;
+        int index;
+        bool operator>(const Entry& other) const { return dist > other.dist; }
+    };
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+    for (int block = 0; block < (int)motionBlocks.size(); block++) {
+        if (motionBlocks[block].count == 0) continue;
+        refreshBlock(block);
+        queue.push(Entry{boxDistance(motionBlocks[block].bound.at(t), p), BLOCK, block});
+    }
+
+    std::vector<int> members;
+    while (!queue.empty() && (int)result.size() < k) {
+        Entry e = queue.top();
+        queue.pop();
+
+        if (e.kind == OBJECT) {
+            result.push_back(e.index);
+        } else if (e.kind == CELL) {
+            for (int id : motionCells[e.index].items) {
+                queue.push(Entry{p.distanceTo(getPositionAt(id, t)), OBJECT, id});
+            }
+        } else {
+            blockCells(e.index, members);
+            for (int cell : members) {
+                refreshCell(cell);
+                queue.push(Entry{boxDistance(motionCells[cell].bound.at(t), p), CELL, cell});
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,463 @@
+#include "../include/PBFReader.h"
+#include "../include/Inflate.h"
+#include "../include/Protobuf.h"
+#include "../include/Parallel.h"
+#include <fstream>
+#include <atomic>
+#include <algorithm>
+
+// ===== NodeLocationStore =====
+
+void NodeLocationStore::reserve(size_t n) {
+    ids.reserve(n);
+    lons.reserve(n);
+    lats.reserve(n);
+}
+
+void NodeLocationStore::add(long long id, int32_t lon, int32_t lat) {
+    if (!ids.empty() && id < ids.back()) sorted = false;
+    ids.push_back(id);
+    lons.push_back(lon);
+    lats.push_back(lat);
+}
+
+void NodeLocationStore::finalize() {
+    if (sorted) return;
+
+    // Ordenar por permutación para mantener las tres columnas alineadas
+    std::vector<size_t> order(ids.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [this](size_t a, size_t b) { return ids[a] < ids[b]; });
+
+    std::vector<long long> newIds(ids.size());
+    std::vector<int32_t> newLons(ids.size()), newLats(ids.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        newIds[i] = ids[order[i]];
+        newLons[i] = lons[order[i]];
+        newLats[i] = lats[order[i]];
+    }
+    ids.swap(newIds);
+    lons.swap(newLons);
+    lats.swap(newLats);
+    sorted = true;
+}
+
+void NodeLocationStore::clear() {
+    ids.clear();
+    lons.clear();
+    lats.clear();
+    sorted = true;
+}
+
+bool NodeLocationStore::find(long long id, Point& p) const {
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it == ids.end() || *it != id) return false;
+
+    size_t i = it - ids.begin();
+    p = Point(lons[i] * 1e-7, lats[i] * 1e-7);
+    return true;
+}
+
+// ===== Decodificación de bloques =====
+
+namespace {
+
+// Vía leída de un bloque, aún sin coordenadas
+struct ParsedWay {
+    long long id;
+    std::vector<long long> refs;
+    std::vector<std::pair<std::string, std::string>> tags;  // Pasan a Geometry::properties
+    bool isArea;
+};
+
+// Resultado de decodificar un PrimitiveBlock
+struct BlockData {
+    std::vector<long long> nodeIds;
+    std::vector<int32_t> nodeLons;
+    std::vector<int32_t> nodeLats;
+    std::vector<ParsedWay> ways;
+};
+
+bool readBigEndian32(std::ifstream& file, uint32_t& value) {
+    unsigned char buf[4];
+    if (!file.read((char*)buf, 4)) return false;
+    value = ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) |
+            ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+    return true;
+}
+
+// Blob: raw (1), raw_size (2), zlib_data (3). LZMA y otros no están soportados.
+bool decodeBlob(const std::vector<uint8_t>& blob, std::vector<uint8_t>& out) {
+    ProtobufReader pb(blob.data(), blob.size());
+    size_t rawSize = 0;
+    const uint8_t* payload = nullptr;
+    size_t payloadSize = 0;
+    bool compressed = false;
+
+    while (pb.next()) {
+        switch (pb.tag()) {
+            case 1: {
+                ProtobufReader raw = pb.message();
+                payload = raw.data();
+                payloadSize = raw.remaining();
+                compressed = false;
+                break;
+            }
+            case 2:
+                rawSize = (size_t)pb.varint();
+                break;
+            case 3: {
+                ProtobufReader z = pb.message();
+                payload = z.data();
+                payloadSize = z.remaining();
+                compressed = true;
+                break;
+            }
+            default:
+                pb.skip();
+                break;
+        }
+    }
+
+    if (pb.hasError() || !payload) return false;
+
+    if (!compressed) {
+        out.assign(payload, payload + payloadSize);
+        return true;
+    }
+    return inflateZlib(payload, payloadSize, out, rawSize);
+}
+
+// Lee un campo repetido de enteros con signo (empaquetado o no) aplicando delta
+template <typename Fn>
+void readPackedSigned(ProtobufReader& pb, bool delta, Fn fn) {
+    if (pb.type() != WIRE_LENGTH) {
+        fn(pb.svarint());
+        return;
+    }
+    ProtobufReader packed = pb.message();
+    int64_t acc = 0;
+    while (!packed.atEnd() && !packed.hasError()) {
+        int64_t v = packed.svarint();
+        acc = delta ? acc + v : v;
+        fn(acc);
+    }
+}
+
+template <typename Fn>
+void readPackedUnsigned(ProtobufReader& pb, Fn fn) {
+    if (pb.type() != WIRE_LENGTH) {
+        fn((uint32_t)pb.varint());
+        return;
+    }
+    ProtobufReader packed = pb.message();
+    while (!packed.atEnd() && !packed.hasError()) {
+        fn((uint32_t)packed.varint());
+    }
+}
+
+struct BlockContext {
+    std::vector<std::string> strings;
+    int64_t granularity;
+    int64_t latOffset;
+    int64_t lonOffset;
+
+    // Coordenada en nanogrados -> punto fijo 1e-7
+    int32_t toFixed(int64_t offset, int64_t value) const {
+        return (int32_t)((offset + granularity * value) / 100);
+    }
+};
+
+void parseDenseNodes(ProtobufReader pb, const BlockContext& ctx, BlockData& block) {
+    std::vector<long long> ids;
+    std::vector<int64_t> lats, lons;
+
+    while (pb.next()) {
+        switch (pb.tag()) {
+            case 1: readPackedSigned(pb, true, [&](int64_t v) { ids.push_back(v); }); break;
+            case 8: readPackedSigned(pb, true, [&](int64_t v) { lats.push_back(v); }); break;
+            case 9: readPackedSigned(pb, true, [&](int64_t v) { lons.push_back(v); }); break;
+            default: pb.skip(); break;
+        }
+    }
+
+    size_t n = std::min(ids.size(), std::min(lats.size(), lons.size()));
+    for (size_t i = 0; i < n; i++) {
+        block.nodeIds.push_back(ids[i]);
+        block.nodeLons.push_back(ctx.toFixed(ctx.lonOffset, lons[i]));
+        block.nodeLats.push_back(ctx.toFixed(ctx.latOffset, lats[i]));
+    }
+}
+
+void parseNode(ProtobufReader pb, const BlockContext& ctx, BlockData& block) {
+    long long id = 0;
+    int64_t lat = 0, lon = 0;
+
+    while (pb.next()) {
+        switch (pb.tag()) {
+            case 1: id = pb.svarint(); break;
+            case 8: lat = pb.svarint(); break;
+            case 9: lon = pb.svarint(); break;
+            default: pb.skip(); break;
+        }
+    }
+
+    block.nodeIds.push_back(id);
+    block.nodeLons.push_back(ctx.toFixed(ctx.lonOffset, lon));
+    block.nodeLats.push_back(ctx.toFixed(ctx.latOffset, lat));
+}
+
+bool isAreaKey(const std::string& key) {
+    return key == "building" || key == "landuse" || key == "natural" ||
+           key == "leisure" || key == "amenity";
+}
+
+void parseWay(ProtobufReader pb, const BlockContext& ctx, bool highwaysOnly,
+              BlockData& block) {
+    ParsedWay way;
+    way.id = 0;
+    way.isArea = false;
+    std::vector<uint32_t> keys, vals;
+
+    while (pb.next()) {
+        switch (pb.tag()) {
+            case 1: way.id = (long long)pb.varint(); break;
+            case 2: readPackedUnsigned(pb, [&](uint32_t v) { keys.push_back(v); }); break;
+            case 3: readPackedUnsigned(pb, [&](uint32_t v) { vals.push_back(v); }); break;
+            case 8: readPackedSigned(pb, true, [&](int64_t v) { way.refs.push_back(v); }); break;
+            default: pb.skip(); break;
+        }
+    }
+
+    bool isHighway = false;
+    bool areaTag = false;
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (keys[i] >= ctx.strings.size()) continue;
+        const std::string& key = ctx.strings[keys[i]];
+        if (key == "highway") isHighway = true;
+        if (isAreaKey(key)) areaTag = true;
+        if (key == "area" && i < vals.size() && vals[i] < ctx.strings.size() &&
+            ctx.strings[vals[i]] == "yes") {
+            areaTag = true;
+        }
+    }
+
+    if (highwaysOnly && !isHighway) return;
+    if (!isHighway && !areaTag) return;
+    if (way.refs.size() < 2) return;
+
+    // Las etiquetas quedan como atributos, igual que las properties de GeoJSON
+    for (size_t i = 0; i < keys.size() && i < vals.size(); i++) {
+        if (keys[i] < ctx.strings.size() && vals[i] < ctx.strings.size()) {
+            way.tags.push_back(std::make_pair(ctx.strings[keys[i]], ctx.strings[vals[i]]));
+        }
+    }
+
+    bool closed = way.refs.size() >= 4 && way.refs.front() == way.refs.back();
+    way.isArea = closed && areaTag;
+    block.ways.push_back(std::move(way));
+}
+
+bool parsePrimitiveBlock(const std::vector<uint8_t>& data, bool highwaysOnly,
+                         BlockData& block) {
+    ProtobufReader pb(data.data(), data.size());
+    BlockContext ctx;
+    ctx.granularity = 100;
+    ctx.latOffset = 0;
+    ctx.lonOffset = 0;
+
+    // Los grupos se procesan al final: granularity/offset pueden venir después
+    std::vector<ProtobufReader> groups;
+
+    while (pb.next()) {
+        switch (pb.tag()) {
+            case 1: {
+                ProtobufReader table = pb.message();
+                while (table.next()) {
+                    if (table.tag() == 1) ctx.strings.push_back(table.string());
+                    else table.skip();
+                }
+                break;
+            }
+            case 2: groups.push_back(pb.message()); break;
+            case 17: ctx.granularity = (int64_t)pb.varint(); break;
+            case 19: ctx.latOffset = (int64_t)pb.varint(); break;
+            case 20: ctx.lonOffset = (int64_t)pb.varint(); break;
+            default: pb.skip(); break;
+        }
+    }
+    if (pb.hasError()) return false;
+
+    for (auto& group : groups) {
+        while (group.next()) {
+            switch (group.tag()) {
+                case 1: parseNode(group.message(), ctx, block); break;
+                case 2: parseDenseNodes(group.message(), ctx, block); break;
+                case 3: parseWay(group.message(), ctx, highwaysOnly, block); break;
+                default: group.skip(); break;
+            }
+        }
+        if (group.hasError()) return false;
+    }
+
+    return true;
+}
+
+// El OSMHeader lista las características requeridas para leer el archivo
+bool checkHeaderBlock(const std::vector<uint8_t>& data) {
+    ProtobufReader pb(data.data(), data.size());
+    while (pb.next()) {
+        if (pb.tag() == 4) {
+            std::string feature = pb.string();
+            if (feature != "OsmSchema-V0.6" && feature != "DenseNodes") {
+                return false;
+            }
+        } else {
+            pb.skip();
+        }
+    }
+    return !pb.hasError();
+}
+
+} // namespace
+
+// ===== PBFReader =====
+
+PBFReader::PBFReader()
+    : threadCount(0), highwaysOnly(true), blockCount(0), missingNodes(0) {}
+
+bool PBFReader::loadFromFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Las geometrías anteriores se conservan hasta que la carga termine bien:
+    // el R-Tree de la aplicación puede seguir apuntando a ellas
+    nodeStore.clear();
+    blockCount = 0;
+    missingNodes = 0;
+
+    // Paso 1: leer los blobs comprimidos (la descompresión se hace en paralelo)
+    std::vector<std::vector<uint8_t>> blobs;
+    bool headerSeen = false;
+    uint32_t headerSize;
+
+    while (readBigEndian32(file, headerSize)) {
+        if (headerSize > 64 * 1024) return false;
+
+        std::vector<uint8_t> headerBytes(headerSize);
+        if (!file.read((char*)headerBytes.data(), headerSize)) return false;
+
+        std::string type;
+        uint32_t dataSize = 0;
+        ProtobufReader header(headerBytes.data(), headerBytes.size());
+        while (header.next()) {
+            if (header.tag() == 1) type = header.string();
+            else if (header.tag() == 3) dataSize = (uint32_t)header.varint();
+            else header.skip();
+        }
+        if (header.hasError() || dataSize > 32 * 1024 * 1024) return false;
+
+        std::vector<uint8_t> blob(dataSize);
+        if (!file.read((char*)blob.data(), dataSize)) return false;
+
+        if (type == "OSMHeader") {
+            std::vector<uint8_t> raw;
+            if (!decodeBlob(blob, raw) || !checkHeaderBlock(raw)) return false;
+            headerSeen = true;
+        } else if (type == "OSMData") {
+            blobs.push_back(std::move(blob));
+        }
+    }
+    file.close();
+
+    if (!headerSeen) return false;
+    blockCount = (int)blobs.size();
+
+    // Paso 2: descomprimir y decodificar cada bloque en paralelo
+    int threads = resolveThreadCount(threadCount);
+
+    std::vector<BlockData> blocks(blobs.size());
+    std::atomic<bool> failed(false);
+
+    parallelFor((int)blobs.size(), threads, [&](int i) {
+        std::vector<uint8_t> raw;
+        if (!decodeBlob(blobs[i], raw) ||
+            !parsePrimitiveBlock(raw, highwaysOnly, blocks[i])) {
+            failed = true;
+        }
+        std::vector<uint8_t>().swap(blobs[i]);
+    });
+
+    if (failed) return false;
+
+    // Paso 3: volcar los nodos al almacén compacto
+    size_t totalNodes = 0;
+    for (const auto& block : blocks) totalNodes += block.nodeIds.size();
+    nodeStore.reserve(totalNodes);
+
+    for (auto& block : blocks) {
+        for (size_t i = 0; i < block.nodeIds.size(); i++) {
+            nodeStore.add(block.nodeIds[i], block.nodeLons[i], block.nodeLats[i]);
+        }
+        std::vector<long long>().swap(block.nodeIds);
+        std::vector<int32_t>().swap(block.nodeLons);
+        std::vector<int32_t>().swap(block.nodeLats);
+    }
+    nodeStore.finalize();
+
+    // Paso 4: resolver las vías a coordenadas (en paralelo, en orden de bloque)
+    std::vector<ParsedWay*> ways;
+    for (auto& block : blocks) {
+        for (auto& way : block.ways) ways.push_back(&way);
+    }
+
+    std::vector<Geometry> resolved(ways.size());
+    std::atomic<int> missing(0);
+
+    parallelFor((int)ways.size(), threads, [&](int i) {
+        ParsedWay& way = *ways[i];
+        Geometry& geom = resolved[i];
+        geom.type = way.isArea ? GEOM_POLYGON : GEOM_LINESTRING;
+        geom.properties.swap(way.tags);
+        geom.points.reserve(way.refs.size());
+        geom.nodeIds.reserve(way.refs.size());
+
+        for (long long ref : way.refs) {
+            Point p;
+            if (nodeStore.find(ref, p)) {
+                geom.points.push_back(p);
+                geom.nodeIds.push_back(ref);
+            } else {
+                missing++;
+            }
+        }
+        geom.calculateMBR();
+    });
+
+    missingNodes = missing;
+
+    std::vector<Geometry> loaded;
+    loaded.reserve(resolved.size());
+    for (auto& geom : resolved) {
+        if (geom.points.size() < 2) continue;
+        geom.id = (int)loaded.size();
+        loaded.push_back(std::move(geom));
+    }
+
+    if (loaded.empty()) return false;
+    geometries.swap(loaded);
+    return true;
+}
+
+Rect PBFReader::getBounds() const {
+    if (geometries.empty()) return Rect();
+
+    Rect bounds = geometries[0].mbr;
+    for (const auto& geom : geometries) {
+        bounds.expand(geom.mbr);
+    }
+    return bounds;
+}
@@ -0,0 +1,278 @@
+#include "../include/PackedRTree.h"
+#include <cstring>
+#include <queue>
+#include <limits>
+
+namespace {
+const size_t ITEM_BYTES = 4 * sizeof(double) + sizeof(uint64_t);
+}
+
+void PackedRTree::computeLevelBounds() {
+    levelBounds.clear();
+    if (numItems == 0) return;
+
+    // Cantidad de nodos por nivel, desde las hojas hasta la raíz
+    std::vector<size_t> counts;
+    size_t n = numItems;
+    counts.push_back(n);
+    while (n > 1) {
+        n = (n + nodeSize - 1) / nodeSize;
+        counts.push_back(n);
+    }
+
+    // La raíz va primero en el arreglo; las hojas al final
+    std::vector<size_t> starts(counts.size());
+    size_t offset = 0;
+    for (size_t i = counts.size(); i-- > 0;) {
+        starts[i] = offset;
+        offset += counts[i];
+    }
+
+    for (size_t i = 0; i < counts.size(); i++) {
+        levelBounds.push_back(std::make_pair(starts[i], starts[i] + counts[i]));
+    }
+}
+
+bool PackedRTree::hasValidLinks() const {
+    for (size_t level = 1; level < levelBounds.size(); level++) {
+        size_t childStart = levelBounds[level - 1].first;
+        for (size_t pos = levelBounds[level].first; pos < levelBounds[level].second; pos++) {
+            if (nodes[pos].offset != childStart + (pos - levelBounds[level].first) * nodeSize) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void PackedRTree::build(const std::vector<PackedRTreeItem>& leaves, uint16_t ns) {
+    numItems = leaves.size();
+    nodeSize = ns < 2 ? 2 : ns;
+    computeLevelBounds();
+
+    nodes.clear();
+    if (numItems == 0) return;
+
+    nodes.resize(levelBounds[0].second);
+    std::copy(leaves.begin(), leaves.end(), nodes.begin() + levelBounds[0].first);
+
+    // Cada nivel superior agrupa nodeSize hijos consecutivos
+    for (size_t level = 0; level + 1 < levelBounds.size(); level++) {
+        size_t childStart = levelBounds[level].first;
+        size_t childEnd = levelBounds[level].second;
+        size_t pos = levelBounds[level + 1].first;
+
+        for (size_t c = childStart; c < childEnd; c += nodeSize) {
+            size_t end = std::min(c + nodeSize, childEnd);
+            PackedRTreeItem parent;
+            parent.box = nodes[c].box;
+            for (size_t i = c + 1; i < end; i++) {
+                parent.box.expand(nodes[i].box);
+            }
+            parent.offset = c;
+            nodes[pos++] = parent;
+        }
+    }
+}
+
+void PackedRTree::search(const Rect& range, std::vector<size_t>& results) const {
+    if (numItems == 0) return;
+
+    size_t leafStart = levelBounds[0].first;
+
+    // Pila de (índice de nodo, nivel)
+    std::vector<std::pair<size_t, size_t>> stack;
+    stack.push_back(std::make_pair((size_t)0, levelBounds.size() - 1));
+
+    while (!stack.empty()) {
+        size_t nodeIndex = stack.back().first;
+        size_t level = stack.back().second;
+        stack.pop_back();
+
+        size_t end = std::min(nodeIndex + nodeSize, levelBounds[level].second);
+        for (size_t pos = nodeIndex; pos < end; pos++) {
+            if (!nodes[pos].box.intersects(range)) continue;
+
+            if (level == 0) {
+                results.push_back(pos - leafStart);
+            } else {
+                stack.push_back(std::make_pair((size_t)nodes[pos].offset, level - 1));
+            }
+        }
+    }
+}
+
+size_t PackedRTree::nearest(const Point& p, const std::function<double(size_t)>& exactDistance,
+                            double* distance) const {
+    if (numItems == 0) return NOT_FOUND;
+
+    size_t leafStart = levelBounds[0].first;
+    size_t best = NOT_FOUND;
+    double bestDist = std::numeric_limits<double>::max();
+
+    // Cola de (distancia a la caja, índice de nodo, nivel), la menor primero
+    typedef std::pair<double, std::pair<size_t, size_t>> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    queue.push(Entry(nodes[0].box.distanceTo(p), std::make_pair((size_t)0, levelBounds.size() - 1)));
+
+    while (!queue.empty()) {
+        Entry entry = queue.top();
+        queue.pop();
+        if (entry.first >= bestDist) break;  // Nada más cerca en el resto de la cola
+
+        size_t pos = entry.second.first;
+        size_t level = entry.second.second;
+
+        if (level == 0) {
+            double d = exactDistance(pos - leafStart);
+            if (d < bestDist) {
+                bestDist = d;
+                best = pos - leafStart;
+            }
+            continue;
+        }
+
+        size_t child = (size_t)nodes[pos].offset;
+        size_t end = std::min(child + nodeSize, levelBounds[level - 1].second);
+        for (; child < end; child++) {
+            double d = nodes[child].box.distanceTo(p);
+            if (d < bestDist) {
+                queue.push(Entry(d, std::make_pair(child, level - 1)));
+            }
+        }
+    }
+
+    if (distance) *distance = bestDist;
+    return best;
+}
+
+void PackedRTree::nearestFirst(const Point& p,
+                               const std::function<bool(size_t, double)>& visit) const {
+    if (numItems == 0) return;
+
+    size_t leafStart = levelBounds[0].first;
+
+    // Nodos y hojas en la misma cola: una hoja sale cuando no queda nada
+    // más cercano sin abrir
+    typedef std::pair<double, std::pair<size_t, size_t>> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    queue.push(Entry(nodes[0].box.distanceTo(p), std::make_pair((size_t)0, levelBounds.size() - 1)));
+
+    while (!queue.empty()) {
+        Entry entry = queue.top();
+        queue.pop();
+
+        size_t pos = entry.second.first;
+        size_t level = entry.second.second;
+        if (level == 0) {
+            if (!visit(pos - leafStart, entry.first)) return;
+            continue;
+        }
+
+        size_t child = (size_t)nodes[pos].offset;
+        size_t end = std::min(child + nodeSize, levelBounds[level - 1].second);
+        for (; child < end; child++) {
+            queue.push(Entry(nodes[child].box.distanceTo(p), std::make_pair(child, level - 1)));
+        }
+    }
+}
+
+size_t PackedRTree::serializedSize(size_t count, uint16_t ns) {
+    if (count == 0) return 0;
+    size_t total = count;
+    size_t n = count;
+    while (n > 1) {
+        n = (n + ns - 1) / ns;
+        total += n;
+    }
+    return total * ITEM_BYTES;
+}
+
+void PackedRTree::serialize(std::vector<uint8_t>& out) const {
+    size_t start = out.size();
+    out.resize(start + nodes.size() * ITEM_BYTES);
+    uint8_t* p = out.data() + start;
+
+    for (const auto& item : nodes) {
+        double box[4] = {item.box.minX, item.box.minY, item.box.maxX, item.box.maxY};
+        std::memcpy(p, box, sizeof(box));
+        std::memcpy(p + sizeof(box), &item.offset, sizeof(uint64_t));
+        p += ITEM_BYTES;
+    }
+}
+
+bool PackedRTree::deserialize(const uint8_t* data, size_t size, size_t count, uint16_t ns) {
+    if (ns < 2 || size != serializedSize(count, ns)) return false;
+
+    numItems = count;
+    nodeSize = ns;
+    computeLevelBounds();
+
+    nodes.resize(size / ITEM_BYTES);
+    const uint8_t* p = data;
+    for (auto& item : nodes) {
+        double box[4];
+        std::memcpy(box, p, sizeof(box));
+        std::memcpy(&item.offset, p + sizeof(box), sizeof(uint64_t));
+        item.box = Rect(box[0], box[1], box[2], box[3]);
+        p += ITEM_BYTES;
+    }
+    if (!hasValidLinks()) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool PackedRTree::attach(const std::shared_ptr<MappedFile>& file, uint8_t* data, size_t size,
+                         size_t count, uint16_t ns) {
+    // Con otra disposición en memoria (o sin alinear) se copia como siempre
+    if (sizeof(PackedRTreeItem) != ITEM_BYTES || (uintptr_t)data % alignof(PackedRTreeItem) != 0) {
+        return deserialize(data, size, count, ns);
+    }
+    if (ns < 2 || size != serializedSize(count, ns)) return false;
+
+    numItems = count;
+    nodeSize = ns;
+    computeLevelBounds();
+    nodes.attach(file, (PackedRTreeItem*)data, size / ITEM_BYTES);
+    if (!hasValidLinks()) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void PackedRTree::clear() {
+    nodes.clear();
+    levelBounds.clear();
+    numItems = 0;
+}
+
+uint32_t PackedRTree::hilbertIndex(const Point& p, const Rect& extent) {
+    const uint32_t n = 1u << 16;
+    double w = extent.maxX - extent.minX;
+    double h = extent.maxY - extent.minY;
+
+    double fx = w > 0 ? std::min(1.0, std::max(0.0, (p.x - extent.minX) / w)) : 0.0;
+    double fy = h > 0 ? std::min(1.0, std::max(0.0, (p.y - extent.minY) / h)) : 0.0;
+    uint32_t x = (uint32_t)(fx * (n - 1));
+    uint32_t y = (uint32_t)(fy * (n - 1));
+
+    uint32_t d = 0;
+    for (uint32_t s = n / 2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        d += s * s * ((3 * rx) ^ ry);
+
+        // Rotar el cuadrante
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
@@ -0,0 +1,137 @@
+#include "../include/Parallel.h"
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+
+namespace {
+// Hilos 1..n esperando tandas; cada tanda se identifica por su número
+class WorkerPool {
+private:
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    std::vector<std::thread> workers;  // workers[k] es el hilo k + 1
+    const std::function<void(int)>* job;
+    int wanted;        // Hilos de la tanda en curso (incluido el 0)
+    int remaining;     // Hilos de la tanda que no terminaron
+    uint64_t batch;
+    bool stopping;
+    std::exception_ptr error;  // Primera excepción de un hilo de la tanda
+
+    void loop(int thread) {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&]() { return stopping || batch != seen; });
+            if (stopping) return;
+            seen = batch;
+            if (thread >= wanted) continue;
+
+            const std::function<void(int)>* current = job;
+            lock.unlock();
+            std::exception_ptr thrown;
+            try {
+                (*current)(thread);
+            } catch (...) {
+                thrown = std::current_exception();
+            }
+            lock.lock();
+            if (thrown && !error) error = thrown;
+            if (--remaining == 0) finished.notify_one();
+        }
+    }
+
+public:
+    std::atomic<bool> busy;
+
+    WorkerPool() : job(nullptr), wanted(0), remaining(0), batch(0), stopping(false), busy(false) {}
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& th : workers) th.join();
+    }
+
+    void run(int threads, const std::function<void(int)>& fn) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while ((int)workers.size() < threads - 1) {
+                int thread = (int)workers.size() + 1;
+                workers.emplace_back([this, thread]() { loop(thread); });
+            }
+            job = &fn;
+            wanted = threads;
+            remaining = threads - 1;
+            error = nullptr;
+            batch++;
+        }
+        wake.notify_all();
+
+        // Aunque fn(0) lance, los demás hilos siguen usando fn: se los espera
+        // antes de salir (fn vive en la pila de quien llama)
+        struct WaitBatch {
+            WorkerPool& owner;
+            ~WaitBatch() {
+                std::unique_lock<std::mutex> lock(owner.mutex);
+                owner.finished.wait(lock, [&]() { return owner.remaining == 0; });
+                owner.job = nullptr;
+            }
+        };
+        std::exception_ptr thrown;
+        {
+            WaitBatch wait{*this};
+            fn(0);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            thrown = error;
+            error = nullptr;
+        }
+        if (thrown) std::rethrow_exception(thrown);
+    }
+};
+
+WorkerPool& pool() {
+    static WorkerPool instance;
+    return instance;
+}
+}
+
+void runOnWorkers(int threads, const std::function<void(int)>& job) {
+    if (threads <= 1) {
+        job(0);
+        return;
+    }
+
+    WorkerPool& workers = pool();
+    if (!workers.busy.exchange(true)) {
+        struct Release {
+            std::atomic<bool>& busy;
+            ~Release() { busy = false; }
+        } release{workers.busy};
+        workers.run(threads, job);
+        return;
+    }
+
+    // El grupo está ocupado (llamada desde dentro de un trabajo o desde otro
+    // hilo a la vez): hilos propios de esta llamada. Sus excepciones se
+    // relanzan en el hilo 0, igual que en el grupo
+    std::vector<std::exception_ptr> errors(threads);
+    auto guarded = [&](int thread) {
+        try {
+            job(thread);
+        } catch (...) {
+            errors[thread] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> extra;
+    for (int t = 1; t < threads; t++) extra.emplace_back(guarded, t);
+    guarded(0);
+    for (auto& th : extra) th.join();
+    for (const auto& e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+}
@@ -0,0 +1,161 @@
+#include "../include/Projection.h"
+#include <sstream>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+const double DEG = PI / 180.0;
+
+// Radio medio terrestre (IUGG), el mismo para haversine y equirectangular
+const double EARTH_RADIUS = 6371008.8;
+
+// Elipsoide WGS84 y parámetros UTM
+const double WGS84_A = 6378137.0;
+const double WGS84_F = 1.0 / 298.257223563;
+const double UTM_K0 = 0.9996;
+const double UTM_FALSE_EASTING = 500000.0;
+const double UTM_FALSE_NORTHING_SOUTH = 10000000.0;
+
+const double E2 = WGS84_F * (2 - WGS84_F);   // Excentricidad al cuadrado
+const double EP2 = E2 / (1 - E2);            // Segunda excentricidad al cuadrado
+
+// Longitud de arco del meridiano desde el ecuador (Snyder, 3-21)
+double meridianArc(double phi) {
+    double e4 = E2 * E2, e6 = e4 * E2;
+    return WGS84_A * ((1 - E2 / 4 - 3 * e4 / 64 - 5 * e6 / 256) * phi
+                      - (3 * E2 / 8 + 3 * e4 / 32 + 45 * e6 / 1024) * std::sin(2 * phi)
+                      + (15 * e4 / 256 + 45 * e6 / 1024) * std::sin(4 * phi)
+                      - (35 * e6 / 3072) * std::sin(6 * phi));
+}
+
+double centralMeridian(int zone) {
+    return (zone - 1) * 6.0 - 180.0 + 3.0;
+}
+
+} // namespace
+
+Projection::Projection()
+    : type(PROJ_NONE), lon0(0), lat0(0), cosLat0(1), zone(0), south(false) {}
+
+bool Projection::isGeographic(const Rect& extent) {
+    return extent.minX >= -180 && extent.maxX <= 180 &&
+           extent.minY >= -90 && extent.maxY <= 90 &&
+           extent.maxX > extent.minX && extent.maxY > extent.minY;
+}
+
+Projection Projection::forExtent(const Rect& extent, ProjectionType t) {
+    Projection proj;
+    if (t == PROJ_NONE || !isGeographic(extent)) return proj;
+
+    Point c = extent.center();
+    proj.type = t;
+    proj.lon0 = c.x;
+    proj.lat0 = c.y;
+    proj.cosLat0 = std::cos(c.y * DEG);
+
+    if (t == PROJ_UTM) {
+        proj.zone = std::min(60, std::max(1, (int)std::floor((c.x + 180.0) / 6.0) + 1));
+        proj.south = c.y < 0;
+        proj.lon0 = centralMeridian(proj.zone);
+    }
+    return proj;
+}
+
+Point Projection::forward(const Point& p) const {
+    switch (type) {
+        case PROJ_EQUIRECTANGULAR:
+            return Point(EARTH_RADIUS * (p.x - lon0) * DEG * cosLat0,
+                         EARTH_RADIUS * (p.y - lat0) * DEG);
+
+        case PROJ_UTM: {
+            // Snyder, "Map Projections: A Working Manual", 8-9 a 8-15
+            double phi = p.y * DEG;
+            double sinPhi = std::sin(phi), cosPhi = std::cos(phi), tanPhi = std::tan(phi);
+            double N = WGS84_A / std::sqrt(1 - E2 * sinPhi * sinPhi);
+            double T = tanPhi * tanPhi;
+            double C = EP2 * cosPhi * cosPhi;
+            double A = cosPhi * (p.x - lon0) * DEG;
+            double A2 = A * A, A3 = A2 * A, A4 = A3 * A, A5 = A4 * A, A6 = A5 * A;
+
+            double x = UTM_K0 * N * (A + (1 - T + C) * A3 / 6
+                                     + (5 - 18 * T + T * T + 72 * C - 58 * EP2) * A5 / 120);
+            double y = UTM_K0 * (meridianArc(phi) + N * tanPhi *
+                                 (A2 / 2 + (5 - T + 9 * C + 4 * C * C) * A4 / 24
+                                  + (61 - 58 * T + T * T + 600 * C - 330 * EP2) * A6 / 720));
+
+            return Point(x + UTM_FALSE_EASTING, y + (south ? UTM_FALSE_NORTHING_SOUTH : 0));
+        }
+
+        default:
+            return p;
+    }
+}
+
+Point Projection::inverse(const Point& p) const {
+    switch (type) {
+        case PROJ_EQUIRECTANGULAR:
+            return Point(lon0 + p.x / (EARTH_RADIUS * cosLat0) / DEG,
+                         lat0 + p.y / EARTH_RADIUS / DEG);
+
+        case PROJ_UTM: {
+            double x = p.x - UTM_FALSE_EASTING;
+            double y = p.y - (south ? UTM_FALSE_NORTHING_SOUTH : 0);
+
+            double e4 = E2 * E2, e6 = e4 * E2;
+            double mu = y / UTM_K0 / (WGS84_A * (1 - E2 / 4 - 3 * e4 / 64 - 5 * e6 / 256));
+            double e1 = (1 - std::sqrt(1 - E2)) / (1 + std::sqrt(1 - E2));
+            double e1_2 = e1 * e1, e1_3 = e1_2 * e1, e1_4 = e1_3 * e1;
+
+            // Latitud del pie de la perpendicular
+            double phi1 = mu + (3 * e1 / 2 - 27 * e1_3 / 32) * std::sin(2 * mu)
+                          + (21 * e1_2 / 16 - 55 * e1_4 / 32) * std::sin(4 * mu)
+                          + (151 * e1_3 / 96) * std::sin(6 * mu)
+                          + (1097 * e1_4 / 512) * std::sin(8 * mu);
+
+            double sin1 = std::sin(phi1), cos1 = std::cos(phi1), tan1 = std::tan(phi1);
+            double C1 = EP2 * cos1 * cos1;
+            double T1 = tan1 * tan1;
+            double s = 1 - E2 * sin1 * sin1;
+            double N1 = WGS84_A / std::sqrt(s);
+            double R1 = WGS84_A * (1 - E2) / (s * std::sqrt(s));
+            double D = x / (N1 * UTM_K0);
+            double D2 = D * D, D3 = D2 * D, D4 = D3 * D, D5 = D4 * D, D6 = D5 * D;
+
+            double phi = phi1 - (N1 * tan1 / R1) *
+                         (D2 / 2 - (5 + 3 * T1 + 10 * C1 - 4 * C1 * C1 - 9 * EP2) * D4 / 24
+                          + (61 + 90 * T1 + 298 * C1 + 45 * T1 * T1 - 252 * EP2 - 3 * C1 * C1) * D6 / 720);
+            double lambda = (D - (1 + 2 * T1 + C1) * D3 / 6
+                             + (5 - 2 * C1 + 28 * T1 - 3 * C1 * C1 + 8 * EP2 + 24 * T1 * T1) * D5 / 120) / cos1;
+
+            return Point(lon0 + lambda / DEG, phi / DEG);
+        }
+
+        default:
+            return p;
+    }
+}
+
+std::string Projection::getName() const {
+    std::stringstream ss;
+    switch (type) {
+        case PROJ_EQUIRECTANGULAR:
+            ss << "Equirectangular local (lat0 " << lat0 << ")";
+            break;
+        case PROJ_UTM:
+            ss << "UTM zona " << zone << (south ? "S" : "N");
+            break;
+        default:
+            ss << "Sin proyeccion";
+            break;
+    }
+    return ss.str();
+}
+
+double Projection::haversine(const Point& a, const Point& b) {
+    double dLat = (b.y - a.y) * DEG;
+    double dLon = (b.x - a.x) * DEG;
+    double sLat = std::sin(dLat / 2);
+    double sLon = std::sin(dLon / 2);
+    double h = sLat * sLat + std::cos(a.y * DEG) * std::cos(b.y * DEG) * sLon * sLon;
+    return 2 * EARTH_RADIUS * std::asin(std::sqrt(std::min(1.0, h)));
+}
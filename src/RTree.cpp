@@ -1,6 +1,7 @@
 #include "../include/RTree.h"
 #include <limits>
 #include <cmath>
+#include <functional>
 
 RTree::RTree() : height(1), nodeCount(1), geometryCount(0) {
     root = new RTreeNode(true);
@@ -175,6 +176,7 @@ void RTree::adjustTree(RTreeNode* node, RTreeNode* splitNode) {
             parent->children.push_back(splitNode);
             parent->mbrs.push_back(splitNode->mbr);
             splitNode->parent = parent;
+            parent->updateMBR();
 
             if (parent->isFull()) {
                 RTreeNode* newParent = nullptr;
@@ -210,8 +212,12 @@ std::vector<Geometry*> RTree::rangeSearch(const Rect& range) {
     return results;
 }
 
+void RTree::rangeSearch(const Rect& range, std::vector<Geometry*>& results) const {
+    rangeSearchRecursive(root, range, results);
+}
+
 void RTree::rangeSearchRecursive(RTreeNode* node, const Rect& range,
-                                  std::vector<Geometry*>& results) {
+                                  std::vector<Geometry*>& results) const {
     if (!node->mbr.intersects(range)) {
         return;
     }
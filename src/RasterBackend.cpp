@@ -0,0 +1,420 @@
+#include "../include/RasterBackend.h"
+#include "../include/Deflate.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+const double PI = 3.14159265358979323846;
+
+// Trazo discontinuo: largo de raya y de espacio para un ancho de 1 px
+const double DASH_ON = 18, DASH_OFF = 6;
+
+// Fuente de 5x7: una fila por byte, bit 4 = columna izquierda
+const uint8_t DIGITS[10][7] = {
+    {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}, {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E},
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}, {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E},
+    {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}, {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E},
+    {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}, {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},
+    {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}, {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}};
+
+const uint8_t LETTERS[26][7] = {
+    {0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11}, {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E},
+    {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}, {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C},
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}, {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10},
+    {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}, {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11},
+    {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C},
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F},
+    {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}, {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11},
+    {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10},
+    {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}, {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11},
+    {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}, {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04},
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}, {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11},
+    {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}, {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}};
+
+const uint8_t DOT[7] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C};
+
+const uint8_t* glyph(char c) {
+    if (c == '.') return DOT;
+    if (c >= '0' && c <= '9') return DIGITS[c - '0'];
+    if (c >= 'A' && c <= 'Z') return LETTERS[c - 'A'];
+    if (c >= 'a' && c <= 'z') return LETTERS[c - 'a'];
+    return nullptr;
+}
+
+struct CrcTable {
+    uint32_t entries[256];
+
+    CrcTable() {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[n] = c;
+        }
+    }
+};
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+    // Estático local: se inicializa una sola vez aunque codifiquen varios hilos
+    static const CrcTable table;
+    const uint32_t* entries = table.entries;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) crc = entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+void putBigEndian(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back((uint8_t)(v >> 24));
+    out.push_back((uint8_t)(v >> 16));
+    out.push_back((uint8_t)(v >> 8));
+    out.push_back((uint8_t)v);
+}
+
+void appendChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+    size_t start = out.size();
+    putBigEndian(out, (uint32_t)data.size());
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    putBigEndian(out, crc32(out.data() + start + 4, data.size() + 4));
+}
+}
+
+RasterBackend::RasterBackend(int w, int h)
+    : width(std::max(1, w)), height(std::max(1, h)),
+      pixels((size_t)width * height * 4, 0), coverage(width + 1, 0.0f) {}
+
+void RasterBackend::clear(const Color& background) {
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        pixels[i] = background.r;
+        pixels[i + 1] = background.g;
+        pixels[i + 2] = background.b;
+        pixels[i + 3] = background.a;
+    }
+}
+
+Color RasterBackend::getPixel(int x, int y) const {
+    const uint8_t* p = &pixels[((size_t)y * width + x) * 4];
+    return Color(p[0], p[1], p[2], p[3]);
+}
+
+void RasterBackend::blendRow(int y, int x0, int x1, const Color& color) {
+    uint8_t* row = &pixels[(size_t)y * width * 4];
+    float alpha = color.a / 255.0f;
+    for (int x = x0; x <= x1; x++) {
+        float cover = coverage[x];
+        if (cover <= 0) continue;
+        coverage[x] = 0;
+
+        float a = std::min(cover, 1.0f) * alpha;
+        uint8_t* p = row + x * 4;
+        p[0] = (uint8_t)(color.r * a + p[0] * (1 - a) + 0.5f);
+        p[1] = (uint8_t)(color.g * a + p[1] * (1 - a) + 0.5f);
+        p[2] = (uint8_t)(color.b * a + p[2] * (1 - a) + 0.5f);
+        p[3] = (uint8_t)(255 * a + p[3] * (1 - a) + 0.5f);
+    }
+    coverage[x1 + 1] = 0;
+}
+
+void RasterBackend::fillPath(const Point* points, const int* ringSizes, int ringCount,
+                             const Color& color, bool evenOdd) {
+    if (!color.isVisible()) return;
+
+    // Aristas no horizontales, orientadas hacia abajo con su sentido original
+    edges.clear();
+    double minX = 0, minY = 0, maxX = 0, maxY = 0;
+    size_t offset = 0;
+    for (int r = 0; r < ringCount; r++) {
+        int n = ringSizes[r];
+        for (int i = 0; i < n; i++) {
+            const Point& a = points[offset + i];
+            const Point& b = points[offset + (i + 1) % n];
+            if (a.y == b.y) continue;
+            Edge e = a.y < b.y ? Edge{a.x, a.y, b.x, b.y, 1} : Edge{b.x, b.y, a.x, a.y, -1};
+            if (edges.empty()) {
+                minX = std::min(a.x, b.x);
+                maxX = std::max(a.x, b.x);
+                minY = e.y0;
+                maxY = e.y1;
+            } else {
+                minX = std::min(minX, std::min(a.x, b.x));
+                maxX = std::max(maxX, std::max(a.x, b.x));
+                minY = std::min(minY, e.y0);
+                maxY = std::max(maxY, e.y1);
+            }
+            edges.push_back(e);
+        }
+        offset += n;
+    }
+    if (edges.empty() || maxX < 0 || minX >= width || maxY < 0 || minY >= height) return;
+
+    int yStart = std::max(0, (int)std::floor(minY));
+    int yEnd = std::min(height - 1, (int)std::floor(maxY));
+    int xStart = std::max(0, (int)std::floor(minX));
+    int xEnd = std::min(width - 1, (int)std::floor(maxX));
+
+    std::sort(edges.begin(), edges.end(),
+              [](const Edge& a, const Edge& b) { return a.y0 < b.y0; });
+
+    const float weight = 1.0f / SUBSAMPLES;
+    size_t next = 0;
+    active.clear();
+    for (int y = yStart; y <= yEnd; y++) {
+        for (int s = 0; s < SUBSAMPLES; s++) {
+            double sy = y + (s + 0.5) / SUBSAMPLES;
+
+            // Aristas que cruzan esta sublínea: y0 <= sy < y1
+            while (next < edges.size() && edges[next].y0 <= sy) active.push_back(&edges[next++]);
+            size_t kept = 0;
+            for (const Edge* e : active) {
+                if (e->y1 > sy) active[kept++] = e;
+            }
+            active.resize(kept);
+
+            crossings.clear();
+            for (const Edge* e : active) {
+                double x = e->x0 + (sy - e->y0) * (e->x1 - e->x0) / (e->y1 - e->y0);
+                crossings.push_back(std::make_pair(x, e->winding));
+            }
+            std::sort(crossings.begin(), crossings.end());
+
+            // Tramos interiores: cobertura exacta en los píxeles de los extremos
+            int winding = 0;
+            for (size_t i = 0; i + 1 < crossings.size(); i++) {
+                winding += evenOdd ? 1 : crossings[i].second;
+                bool inside = evenOdd ? (winding & 1) != 0 : winding != 0;
+                if (!inside) continue;
+
+                double xa = std::max(0.0, crossings[i].first);
+                double xb = std::min((double)width, crossings[i + 1].first);
+                if (xb <= xa) continue;
+                int ia = (int)xa, ib = (int)xb;
+                if (ia == ib) {
+                    coverage[ia] += (float)(xb - xa) * weight;
+                } else {
+                    coverage[ia] += (float)(ia + 1 - xa) * weight;
+                    for (int x = ia + 1; x < ib; x++) coverage[x] += weight;
+                    coverage[ib] += (float)(xb - ib) * weight;
+                }
+            }
+        }
+        blendRow(y, xStart, xEnd, color);
+    }
+}
+
+void RasterBackend::addStroke(const Point* points, int count, double lineWidth) {
+    double half = lineWidth / 2;
+
+    // Un rectángulo por segmento, todos con la misma orientación
+    for (int i = 0; i + 1 < count; i++) {
+        const Point& a = points[i];
+        const Point& b = points[i + 1];
+        double dx = b.x - a.x, dy = b.y - a.y;
+        double length = std::sqrt(dx * dx + dy * dy);
+        if (length == 0) continue;
+        double nx = -dy / length * half, ny = dx / length * half;
+        path.push_back(Point(a.x + nx, a.y + ny));
+        path.push_back(Point(b.x + nx, b.y + ny));
+        path.push_back(Point(b.x - nx, b.y - ny));
+        path.push_back(Point(a.x - nx, a.y - ny));
+        rings.push_back(4);
+    }
+
+    // Uniones y extremos redondeados (con 1-2 px no se notan)
+    if (lineWidth > 2) {
+        for (int i = 0; i < count; i++) addDisc(points[i], half);
+    }
+}
+
+void RasterBackend::addDisc(const Point& center, double radius) {
+    // Sentido horario como los rectángulos de addStroke (regla no-cero)
+    int sides = std::max(8, std::min(48, (int)std::ceil(PI * radius)));
+    for (int k = 0; k < sides; k++) {
+        double angle = -2 * PI * k / sides;
+        path.push_back(Point(center.x + radius * std::cos(angle), center.y + radius * std::sin(angle)));
+    }
+    rings.push_back(sides);
+}
+
+void RasterBackend::strokePath(const Point* points, int count, const Pen& pen) {
+    if (!pen.isVisible() || count < 2) return;
+
+    double lineWidth = std::max(1.0, pen.width);
+    path.clear();
+    rings.clear();
+
+    if (!pen.dashed) {
+        addStroke(points, count, lineWidth);
+    } else {
+        // Rayas a lo largo de la polilínea, cada una como polilínea propia
+        double on = DASH_ON * lineWidth, off = DASH_OFF * lineWidth;
+        double phase = 0;   // Recorrido dentro del ciclo raya + espacio
+        std::vector<Point> dash;
+        for (int i = 0; i + 1 < count; i++) {
+            Point a = points[i];
+            const Point& b = points[i + 1];
+            double length = a.distanceTo(b);
+            double done = 0;
+            while (done < length) {
+                double step = std::min(length - done, (phase < on ? on : on + off) - phase);
+                double u0 = done / length, u1 = (done + step) / length;
+                if (phase < on) {
+                    Point p0(a.x + (b.x - a.x) * u0, a.y + (b.y - a.y) * u0);
+                    Point p1(a.x + (b.x - a.x) * u1, a.y + (b.y - a.y) * u1);
+                    if (dash.empty()) dash.push_back(p0);
+                    dash.push_back(p1);
+                }
+                done += step;
+                phase += step;
+                if (phase >= on && !dash.empty()) {
+                    addStroke(dash.data(), (int)dash.size(), lineWidth);
+                    dash.clear();
+                }
+                if (phase >= on + off) phase = 0;
+            }
+        }
+        if (dash.size() > 1) addStroke(dash.data(), (int)dash.size(), lineWidth);
+    }
+
+    fillPath(path.data(), rings.data(), (int)rings.size(), pen.color, false);
+}
+
+void RasterBackend::drawPolyline(const Point* points, int count, const Pen& pen) {
+    strokePath(points, count, pen);
+}
+
+void RasterBackend::drawPolygon(const Point* points, const int* ringSizes, int ringCount,
+                                const Color& fill, const Pen& outline) {
+    fillPath(points, ringSizes, ringCount, fill, true);
+    if (!outline.isVisible()) return;
+
+    std::vector<Point> ring;
+    size_t offset = 0;
+    for (int r = 0; r < ringCount; r++) {
+        ring.assign(points + offset, points + offset + ringSizes[r]);
+        if (!ring.empty()) ring.push_back(ring[0]);
+        strokePath(ring.data(), (int)ring.size(), outline);
+        offset += ringSizes[r];
+    }
+}
+
+void RasterBackend::drawCircle(const Point& center, double radius, const Color& fill,
+                               const Pen& outline) {
+    path.clear();
+    rings.clear();
+    addDisc(center, radius);
+    std::vector<Point> disc(path);
+    int size = (int)disc.size();
+
+    fillPath(disc.data(), &size, 1, fill, false);
+    disc.push_back(disc[0]);
+    strokePath(disc.data(), (int)disc.size(), outline);
+}
+
+void RasterBackend::drawText(const Point& topLeft, const std::string& text, double size,
+                             const Color& color) {
+    // 7 filas de la letra más una de separación
+    double scale = size / 8;
+    std::vector<Point> squares;
+    std::vector<int> sizes;
+    for (size_t i = 0; i < text.size(); i++) {
+        const uint8_t* rows = glyph(text[i]);
+        if (!rows) continue;
+        double left = topLeft.x + i * 6 * scale;
+        for (int r = 0; r < 7; r++) {
+            for (int c = 0; c < 5; c++) {
+                if (!(rows[r] & (0x10 >> c))) continue;
+                double x = left + c * scale, y = topLeft.y + r * scale;
+                squares.push_back(Point(x, y));
+                squares.push_back(Point(x + scale, y));
+                squares.push_back(Point(x + scale, y + scale));
+                squares.push_back(Point(x, y + scale));
+                sizes.push_back(4);
+            }
+        }
+    }
+    fillPath(squares.data(), sizes.data(), (int)sizes.size(), color, false);
+}
+
+bool RasterBackend::writePPM(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) return false;
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+    std::vector<uint8_t> row((size_t)width * 3);
+    for (int y = 0; y < height; y++) {
+        const uint8_t* src = &pixels[(size_t)y * width * 4];
+        for (int x = 0; x < width; x++) {
+            row[x * 3] = src[x * 4];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        file.write((const char*)row.data(), row.size());
+    }
+    return file.good();
+}
+
+void RasterBackend::encodePNG(std::vector<uint8_t>& out) const {
+    out.clear();
+    const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    out.insert(out.end(), signature, signature + 8);
+
+    std::vector<uint8_t> header;
+    putBigEndian(header, (uint32_t)width);
+    putBigEndian(header, (uint32_t)height);
+    header.push_back(8);   // Bits por canal
+    header.push_back(6);   // RGBA
+    header.push_back(0);   // Deflate
+    header.push_back(0);   // Filtros estándar
+    header.push_back(0);   // Sin entrelazado
+    appendChunk(out, "IHDR", header);
+
+    // Cada fila con el filtro (ninguno, Sub o Up) que deja la menor suma
+    // de diferencias: el fondo liso y las filas repetidas quedan en ceros
+    size_t rowBytes = (size_t)width * 4;
+    std::vector<uint8_t> raw((rowBytes + 1) * height);
+    std::vector<uint8_t> zeros(rowBytes, 0);
+    for (int y = 0; y < height; y++) {
+        const uint8_t* row = pixels.data() + y * rowBytes;
+        const uint8_t* above = y > 0 ? row - rowBytes : zeros.data();
+        const uint8_t* left = row - 4;  // Sólo se lee desde i >= 4
+        uint32_t cost[3] = {0, 0, 0};
+        for (size_t i = 0; i < 4; i++) {
+            cost[0] += std::abs((int)(int8_t)row[i]);
+            cost[1] += std::abs((int)(int8_t)row[i]);
+            cost[2] += std::abs((int)(int8_t)(row[i] - above[i]));
+        }
+        for (size_t i = 4; i < rowBytes; i++) {
+            cost[0] += std::abs((int)(int8_t)row[i]);
+            cost[1] += std::abs((int)(int8_t)(row[i] - left[i]));
+            cost[2] += std::abs((int)(int8_t)(row[i] - above[i]));
+        }
+        int best = (int)(std::min_element(cost, cost + 3) - cost);
+
+        uint8_t* out = raw.data() + y * (rowBytes + 1);
+        *out++ = (uint8_t)best;
+        if (best == 0) {
+            std::copy(row, row + rowBytes, out);
+        } else if (best == 1) {
+            std::copy(row, row + 4, out);
+            for (size_t i = 4; i < rowBytes; i++) out[i] = (uint8_t)(row[i] - left[i]);
+        } else {
+            for (size_t i = 0; i < rowBytes; i++) out[i] = (uint8_t)(row[i] - above[i]);
+        }
+    }
+
+    std::vector<uint8_t> data;
+    deflateZlib(raw.data(), raw.size(), data);
+    appendChunk(out, "IDAT", data);
+    appendChunk(out, "IEND", std::vector<uint8_t>());
+}
+
+bool RasterBackend::writePNG(const std::string& filename) const {
+    std::vector<uint8_t> png;
+    encodePNG(png);
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) return false;
+    file.write((const char*)png.data(), png.size());
+    return file.good();
+}
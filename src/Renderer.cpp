@@ -1,31 +1,22 @@
 #include "../include/Renderer.h"
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
 
-Renderer::Renderer(HWND window, int w, int h)
-    : hwnd(window), width(w), height(h), zoom(1.0), panOffset(0, 0) {
+Renderer::Renderer(RenderBackend& target)
+    : backend(&target), width(target.getWidth()), height(target.getHeight()),
+      zoom(1.0), panOffset(0, 0), useLevelOfDetail(true), frameStart(std::chrono::steady_clock::now()), drawnCount(0) {
 
     // Configurar colores
-    colorBackground = RGB(240, 240, 240);
-    colorStreet = RGB(50, 50, 50);
-    colorHighlight = RGB(255, 0, 0);
-    colorMBR = RGB(0, 100, 255);
-    colorSearchArea = RGB(0, 200, 0);
-    colorRoute = RGB(255, 0, 0);
-    colorStartPoint = RGB(0, 255, 0);
-    colorEndPoint = RGB(255, 0, 0);
-    colorGraphNode = RGB(100, 100, 255);
-
-    // Crear buffer para doble renderizado
-    HDC hdc = GetDC(hwnd);
-    memDC = CreateCompatibleDC(hdc);
-    memBitmap = CreateCompatibleBitmap(hdc, width, height);
-    SelectObject(memDC, memBitmap);
-    ReleaseDC(hwnd, hdc);
-}
-
-Renderer::~Renderer() {
-    DeleteObject(memBitmap);
-    DeleteDC(memDC);
+    colorBackground = Color(240, 240, 240);
+    colorStreet = Color(50, 50, 50);
+    colorHighlight = Color(255, 0, 0);
+    colorMBR = Color(0, 100, 255);
+    colorSearchArea = Color(0, 200, 0);
+    colorRoute = Color(255, 0, 0);
+    colorStartPoint = Color(0, 255, 0);
+    colorEndPoint = Color(255, 0, 0);
+    colorGraphNode = Color(100, 100, 255);
 }
 
 void Renderer::setViewBounds(const Rect& bounds) {
@@ -59,7 +50,7 @@ void Renderer::resetView() {
     panOffset = Point(0, 0);
 }
 
-POINT Renderer::geoToScreen(const Point& p) {
+Point Renderer::geoToScreen(const Point& p) const {
     // Aplicar pan y zoom
     double adjustedX = (p.x - panOffset.x) * zoom;
     double adjustedY = (p.y - panOffset.y) * zoom;
@@ -68,14 +59,12 @@ POINT Renderer::geoToScreen(const Point& p) {
     double scaleX = width / (viewBounds.maxX - viewBounds.minX);
     double scaleY = height / (viewBounds.maxY - viewBounds.minY);
 
-    POINT screen;
-    screen.x = (int)((adjustedX - viewBounds.minX) * scaleX);
-    screen.y = (int)(height - (adjustedY - viewBounds.minY) * scaleY);
-
-    return screen;
+    // Sin redondear: el backend decide (GDI redondea, el raster suaviza)
+    return Point((adjustedX - viewBounds.minX) * scaleX,
+                 height - (adjustedY - viewBounds.minY) * scaleY);
 }
 
-Point Renderer::screenToGeo(int x, int y) {
+Point Renderer::screenToGeo(int x, int y) const {
     // Escala inversa
     double scaleX = (viewBounds.maxX - viewBounds.minX) / width;
     double scaleY = (viewBounds.maxY - viewBounds.minY) / height;
@@ -91,6 +80,15 @@ Point Renderer::screenToGeo(int x, int y) {
     return geo;
 }
 
+Rect Renderer::visibleArea(double margin) const {
+    // La vista no rota: bastan dos esquinas opuestas
+    Point topLeft = screenToGeo(0, 0);
+    Point bottomRight = screenToGeo(width, height);
+    double padX = margin * (bottomRight.x - topLeft.x) / width;
+    double padY = margin * (topLeft.y - bottomRight.y) / height;
+    return Rect(topLeft.x - padX, bottomRight.y - padY, bottomRight.x + padX, topLeft.y + padY);
+}
+
 Point Renderer::getGeoPoint(int screenX, int screenY) {
     return screenToGeo(screenX, screenY);
 }
@@ -132,214 +130,215 @@ void Renderer::zoomOut(int centerX, int centerY) {
     panOffset.y += (centerGeo.y - newCenterGeo.y);
 }
 
-void Renderer::render(HDC hdc, const std::vector<Geometry>& geometries) {
-    // Limpiar fondo
-    RECT rect = {0, 0, width, height};
-    HBRUSH bgBrush = CreateSolidBrush(colorBackground);
-    FillRect(memDC, &rect, bgBrush);
-    DeleteObject(bgBrush);
-
-    // Renderizar geometrías
-    for (const auto& geom : geometries) {
-        renderGeometry(memDC, geom, false);
-    }
-
-    // Copiar al DC real
-    BitBlt(hdc, 0, 0, width, height, memDC, 0, 0, SRCCOPY);
+void Renderer::drawRect(const Rect& area, const Pen& pen) {
+    Point corners[5] = {geoToScreen(Point(area.minX, area.maxY)), geoToScreen(Point(area.maxX, area.maxY)),
+                        geoToScreen(Point(area.maxX, area.minY)), geoToScreen(Point(area.minX, area.minY)),
+                        geoToScreen(Point(area.minX, area.maxY))};
+    backend->drawPolyline(corners, 5, pen);
 }
 
-void Renderer::renderGeometry(HDC hdc, const Geometry& geom, bool highlight) {
-    HPEN pen = CreatePen(PS_SOLID, highlight ? 3 : 1,
-                        highlight ? colorHighlight : colorStreet);
-    HPEN oldPen = (HPEN)SelectObject(hdc, pen);
-
-    if (geom.type == GEOM_POINT && !geom.points.empty()) {
-        POINT p = geoToScreen(geom.points[0]);
-        Ellipse(hdc, p.x - 3, p.y - 3, p.x + 3, p.y + 3);
-
-    } else if (geom.type == GEOM_LINESTRING && geom.points.size() > 1) {
-        POINT start = geoToScreen(geom.points[0]);
-        MoveToEx(hdc, start.x, start.y, NULL);
+void Renderer::render(const LayerManager& layers) {
+    frameStart = std::chrono::steady_clock::now();
+    drawnCount = 0;
 
-        for (size_t i = 1; i < geom.points.size(); i++) {
-            POINT p = geoToScreen(geom.points[i]);
-            LineTo(hdc, p.x, p.y);
+    // Limpiar fondo
+    backend->clear(colorBackground);
+
+    // Renderizar geometrías, capa por capa en orden de dibujo; de cada capa
+    // sólo las que su R-Tree ubica en pantalla (margen: círculos de radio 3)
+    Rect area = visibleArea(4);
+    double pixelSize = (area.maxX - area.minX) / (width + 8);
+    for (size_t i = 0; i < layers.getLayerCount(); i++) {
+        const Layer& layer = layers.getLayerAt(i);
+        if (!layer.visible) continue;
+
+        // Con poco zoom, el nivel simplificado que corresponde al píxel: su
+        // índice ya no tiene lo que cabe en un píxel
+        int level = useLevelOfDetail ? layer.lod.levelFor(pixelSize) : 0;
+        if (level > 0) {
+            visibleItems.clear();
+            layer.lod.search(level, area, visibleItems);
+            for (size_t item : visibleItems) {
+                const Geometry& source = layer.lod.getSource(level, item);
+                int count = layer.lod.getVertexCount(level, item);
+                screenPoints.clear();
+                for (int k = 0; k < count; k++) {
+                    screenPoints.push_back(geoToScreen(layer.lod.getVertex(level, item, k)));
+                }
+                drawShape(source.type, false);
+            }
+            drawnCount += (int)visibleItems.size();
+            continue;
         }
 
-    } else if (geom.type == GEOM_POLYGON && geom.points.size() > 2) {
-        std::vector<POINT> points;
-        for (const auto& p : geom.points) {
-            points.push_back(geoToScreen(p));
+        visibleGeometries.clear();
+        layer.index.rangeSearch(area, visibleGeometries);
+        for (const auto* geom : visibleGeometries) {
+            // Líneas y polígonos de menos de un píxel no se ven
+            if (useLevelOfDetail && geom->type != GEOM_POINT &&
+                geom->mbr.maxX - geom->mbr.minX < pixelSize &&
+                geom->mbr.maxY - geom->mbr.minY < pixelSize) {
+                continue;
+            }
+            renderGeometry(*geom, false);
+            drawnCount++;
         }
+    }
+}
 
-        // Usar Polygon de WinAPI para polígonos
-        HBRUSH brush = CreateSolidBrush(highlight ? RGB(255, 200, 200) : RGB(200, 200, 200));
-        HBRUSH oldBrush = (HBRUSH)SelectObject(hdc, brush);
+void Renderer::renderGeometry(const Geometry& geom, bool highlight) {
+    screenPoints.clear();
+    for (const auto& p : geom.points) screenPoints.push_back(geoToScreen(p));
+    drawShape(geom.type, highlight);
+}
 
-        Polygon(hdc, points.data(), (int)points.size());
+void Renderer::drawShape(GeometryType type, bool highlight) {
+    Pen pen(highlight ? colorHighlight : colorStreet, highlight ? 3 : 1);
+    int count = (int)screenPoints.size();
 
-        SelectObject(hdc, oldBrush);
-        DeleteObject(brush);
-    }
+    if (type == GEOM_POINT && count > 0) {
+        backend->drawCircle(screenPoints[0], 3, Color(255, 255, 255), pen);
+
+    } else if (type == GEOM_LINESTRING && count > 1) {
+        backend->drawPolyline(screenPoints.data(), count, pen);
 
-    SelectObject(hdc, oldPen);
-    DeleteObject(pen);
+    } else if (type == GEOM_POLYGON && count > 2) {
+        Color fill = highlight ? Color(255, 200, 200) : Color(200, 200, 200);
+        backend->drawPolygon(screenPoints.data(), &count, 1, fill, pen);
+    }
 }
 
-void Renderer::renderRTreeNodes(HDC hdc, RTreeNode* node, int level) {
-    if (!node) return;
+void Renderer::renderRTreeNodes(RTreeNode* node, int level) {
+    if (!node || !node->mbr.intersects(visibleArea(2))) return;
 
     // Color según nivel (más transparente para niveles bajos)
     int colorIntensity = 100 + level * 30;
     if (colorIntensity > 255) colorIntensity = 255;
-
-    COLORREF color = RGB(0, colorIntensity, 255 - level * 20);
-    HPEN pen = CreatePen(PS_DASH, 1, color);
-    HPEN oldPen = (HPEN)SelectObject(hdc, pen);
-    HBRUSH oldBrush = (HBRUSH)SelectObject(hdc, GetStockObject(NULL_BRUSH));
+    int blue = std::max(0, 255 - level * 20);
 
     // Renderizar MBR del nodo
-    POINT tl = geoToScreen(Point(node->mbr.minX, node->mbr.maxY));
-    POINT br = geoToScreen(Point(node->mbr.maxX, node->mbr.minY));
-    Rectangle(hdc, tl.x, tl.y, br.x, br.y);
+    drawRect(node->mbr, Pen(Color(0, (uint8_t)colorIntensity, (uint8_t)blue), 1, true));
 
     // Renderizar hijos recursivamente
     if (!node->isLeaf) {
         for (auto* child : node->children) {
-            renderRTreeNodes(hdc, child, level + 1);
+            renderRTreeNodes(child, level + 1);
         }
     }
-
-    SelectObject(hdc, oldBrush);
-    SelectObject(hdc, oldPen);
-    DeleteObject(pen);
 }
 
-void Renderer::renderSearchArea(HDC hdc, const Rect& area) {
-    HPEN pen = CreatePen(PS_SOLID, 2, colorSearchArea);
-    HPEN oldPen = (HPEN)SelectObject(hdc, pen);
-    HBRUSH oldBrush = (HBRUSH)SelectObject(hdc, GetStockObject(NULL_BRUSH));
-
-    POINT tl = geoToScreen(Point(area.minX, area.maxY));
-    POINT br = geoToScreen(Point(area.maxX, area.minY));
-    Rectangle(hdc, tl.x, tl.y, br.x, br.y);
-
-    SelectObject(hdc, oldBrush);
-    SelectObject(hdc, oldPen);
-    DeleteObject(pen);
+void Renderer::renderSearchArea(const Rect& area) {
+    drawRect(area, Pen(colorSearchArea, 2));
 }
 
-void Renderer::renderSearchResults(HDC hdc, const std::vector<Geometry*>& results) {
+void Renderer::renderSearchResults(const std::vector<Geometry*>& results) {
     for (auto* geom : results) {
-        renderGeometry(hdc, *geom, true);
+        renderGeometry(*geom, true);
     }
 }
 
-void Renderer::renderGraph(HDC hdc, const Graph& graph) {
-    const auto& nodes = graph.getNodes();
-
+void Renderer::renderGraph(const Graph& graph) {
     // Renderizar aristas del grafo
-    HPEN edgePen = CreatePen(PS_SOLID, 1, RGB(150, 150, 200));
-    HPEN oldPen = (HPEN)SelectObject(hdc, edgePen);
-
-    for (const auto& pair : nodes) {
-        const GraphNode& node = pair.second;
-        POINT p1 = geoToScreen(node.position);
-
-        for (size_t i = 0; i < node.neighbors.size(); i++) {
-            int neighborId = node.neighbors[i];
-            const GraphNode* neighbor = graph.getNode(neighborId);
-            if (neighbor && neighbor->id > node.id) {  // Evitar dibujar dos veces
-                POINT p2 = geoToScreen(neighbor->position);
-                MoveToEx(hdc, p1.x, p1.y, NULL);
-                LineTo(hdc, p2.x, p2.y);
-            }
-        }
+    Pen edgePen(Color(150, 150, 200), 1);
+
+    // Cada arista visible con su forma (las cadenas contraídas guardan sus
+    // vértices). El índice tiene cada arista bidireccional una sola vez
+    Rect area = visibleArea(3);
+    std::vector<Point> shape;
+    visibleIds.clear();
+    graph.edgesInRange(area, visibleIds);
+    for (int e : visibleIds) {
+        graph.getEdgeGeometry(e, shape);
+        screenPoints.clear();
+        for (const auto& p : shape) screenPoints.push_back(geoToScreen(p));
+        backend->drawPolyline(screenPoints.data(), (int)screenPoints.size(), edgePen);
     }
-
-    SelectObject(hdc, oldPen);
-    DeleteObject(edgePen);
+    drawnCount += (int)visibleIds.size();
 
     // Renderizar nodos del grafo
-    HBRUSH nodeBrush = CreateSolidBrush(RGB(100, 100, 255));
-    HBRUSH oldBrush = (HBRUSH)SelectObject(hdc, nodeBrush);
-    HPEN nodePen = CreatePen(PS_SOLID, 1, RGB(50, 50, 150));
-    oldPen = (HPEN)SelectObject(hdc, nodePen);
-
-    for (const auto& pair : nodes) {
-        POINT p = geoToScreen(pair.second.position);
-        Ellipse(hdc, p.x - 2, p.y - 2, p.x + 2, p.y + 2);
+    Color nodeFill(100, 100, 255);
+    Pen nodePen(Color(50, 50, 150), 1);
+    visibleIds.clear();
+    graph.nodesInRange(area, visibleIds);
+    for (int u : visibleIds) {
+        backend->drawCircle(geoToScreen(graph.getNodePosition(u)), 2, nodeFill, nodePen);
     }
+    drawnCount += (int)visibleIds.size();
+}
+
+void Renderer::renderIsochrones(const std::vector<Isochrone>& isochrones) {
+    // De mayor a menor presupuesto, así las áreas chicas quedan encima
+    std::vector<const Isochrone*> order;
+    for (const auto& iso : isochrones) order.push_back(&iso);
+    std::sort(order.begin(), order.end(),
+              [](const Isochrone* a, const Isochrone* b) { return a->budget > b->budget; });
+
+    // Colores de lejos (rojo) a cerca (verde)
+    const Color fills[3] = {Color(255, 200, 200), Color(255, 240, 180), Color(190, 240, 190)};
+    const Color borders[3] = {Color(200, 60, 60), Color(200, 160, 0), Color(40, 150, 40)};
+
+    for (size_t i = 0; i < order.size(); i++) {
+        const Isochrone& iso = *order[i];
+        if (iso.rings.empty()) continue;
+
+        // Los huecos quedan sin pintar (regla par-impar)
+        screenPoints.clear();
+        std::vector<int> counts;
+        for (const auto& ring : iso.rings) {
+            for (const auto& p : ring) screenPoints.push_back(geoToScreen(p));
+            counts.push_back((int)ring.size());
+        }
 
-    SelectObject(hdc, oldBrush);
-    SelectObject(hdc, oldPen);
-    DeleteObject(nodeBrush);
-    DeleteObject(nodePen);
+        size_t c = std::min(order.size() - 1 - i, (size_t)2);
+        backend->drawPolygon(screenPoints.data(), counts.data(), (int)counts.size(), fills[c],
+                             Pen(borders[c], 2));
+    }
 }
 
-void Renderer::renderRoute(HDC hdc, const Route& route) {
+void Renderer::renderRoute(const Route& route) {
     if (!route.found || route.path.size() < 2) return;
 
     // Renderizar línea de la ruta en AZUL (como solicitaste)
-    HPEN routePen = CreatePen(PS_SOLID, 5, RGB(0, 100, 255));  // AZUL GRUESO
-    HPEN oldPen = (HPEN)SelectObject(hdc, routePen);
-
-    POINT start = geoToScreen(route.path[0]);
-    MoveToEx(hdc, start.x, start.y, NULL);
-
-    for (size_t i = 1; i < route.path.size(); i++) {
-        POINT p = geoToScreen(route.path[i]);
-        LineTo(hdc, p.x, p.y);
-    }
-
-    SelectObject(hdc, oldPen);
-    DeleteObject(routePen);
+    screenPoints.clear();
+    for (const auto& p : route.path) screenPoints.push_back(geoToScreen(p));
+    backend->drawPolyline(screenPoints.data(), (int)screenPoints.size(),
+                          Pen(Color(0, 100, 255), 5));  // AZUL GRUESO
 
     // Renderizar puntos de la ruta en AMARILLO para destacar
-    HBRUSH pointBrush = CreateSolidBrush(RGB(255, 200, 0));
-    HBRUSH oldBrush = (HBRUSH)SelectObject(hdc, pointBrush);
-    HPEN pointPen = CreatePen(PS_SOLID, 2, RGB(200, 150, 0));
-    oldPen = (HPEN)SelectObject(hdc, pointPen);
-
-    for (const auto& point : route.path) {
-        POINT p = geoToScreen(point);
-        Ellipse(hdc, p.x - 5, p.y - 5, p.x + 5, p.y + 5);
+    Color pointFill(255, 200, 0);
+    Pen pointPen(Color(200, 150, 0), 2);
+    for (const auto& p : screenPoints) {
+        backend->drawCircle(p, 5, pointFill, pointPen);
     }
-
-    SelectObject(hdc, oldBrush);
-    SelectObject(hdc, oldPen);
-    DeleteObject(pointBrush);
-    DeleteObject(pointPen);
 }
 
-void Renderer::renderRoutePoint(HDC hdc, const Point& p, bool isStart) {
-    POINT screen = geoToScreen(p);
+void Renderer::renderRoutePoint(const Point& p, bool isStart) {
+    Point screen = geoToScreen(p);
 
     // Color según si es inicio o fin
-    COLORREF color = isStart ? RGB(0, 255, 0) : RGB(255, 0, 0);  // Verde inicio, Rojo fin
-    HBRUSH brush = CreateSolidBrush(color);
-    HBRUSH oldBrush = (HBRUSH)SelectObject(hdc, brush);
-    HPEN pen = CreatePen(PS_SOLID, 3, RGB(0, 0, 0));
-    HPEN oldPen = (HPEN)SelectObject(hdc, pen);
+    Color color = isStart ? colorStartPoint : colorEndPoint;  // Verde inicio, Rojo fin
 
     // Dibujar círculo más grande y visible
-    Ellipse(hdc, screen.x - 10, screen.y - 10, screen.x + 10, screen.y + 10);
+    backend->drawCircle(screen, 10, color, Pen(Color(0, 0, 0), 3));
 
     // Dibujar letra (S o E)
-    SetBkMode(hdc, TRANSPARENT);
-    SetTextColor(hdc, RGB(255, 255, 255));
-    HFONT font = CreateFont(16, 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE,
-                            DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
-                            ANTIALIASED_QUALITY, DEFAULT_PITCH | FF_DONTCARE, "Arial");
-    HFONT oldFont = (HFONT)SelectObject(hdc, font);
-
-    const char* letter = isStart ? "S" : "E";
-    TextOut(hdc, screen.x - 5, screen.y - 8, letter, 1);
-
-    SelectObject(hdc, oldFont);
-    SelectObject(hdc, oldBrush);
-    SelectObject(hdc, oldPen);
-    DeleteObject(font);
-    DeleteObject(brush);
-    DeleteObject(pen);
+    backend->drawText(Point(screen.x - 5, screen.y - 8), isStart ? "S" : "E", 16,
+                      Color(255, 255, 255));
+}
+
+double Renderer::getFrameTime() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+}
+
+void Renderer::renderFrameStats() {
+    char text[64];
+    snprintf(text, sizeof(text), "%.1f MS  %d OBJ", getFrameTime(), drawnCount);
+
+    // Fondo blanco semitransparente para que se lea sobre el mapa (9 px por
+    // carácter: 6 columnas de la fuente de 5x7 a tamaño 12)
+    double right = 12 + 9.0 * strlen(text);
+    Point box[4] = {Point(4, 4), Point(right, 4), Point(right, 24), Point(4, 24)};
+    int count = 4;
+    backend->drawPolygon(box, &count, 1, Color(255, 255, 255, 200), Pen());
+    backend->drawText(Point(8, 8), text, 12, Color(0, 0, 0));
 }
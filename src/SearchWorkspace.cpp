@@ -0,0 +1,88 @@
+#include "../include/SearchWorkspace.h"
+
+const double SearchWorkspace::INF = std::numeric_limits<double>::max();
+
+namespace {
+const int ARITY = 4;  // Heap 4-ario: menos niveles y hijos contiguos en memoria
+const int WORKSPACE_SLOTS = 2;
+}
+
+SearchWorkspace::SearchWorkspace() : epoch(0) {}
+
+void SearchWorkspace::prepare(int nodeCount) {
+    if ((int)nodes.size() < nodeCount) {
+        NodeState blank = {INF, INF, -1, -1, 0, false};
+        nodes.resize(nodeCount, blank);
+    }
+    heap.clear();
+
+    // Al dar la vuelta el contador, las marcas viejas podrían coincidir
+    if (++epoch == 0) {
+        for (auto& s : nodes) s.stamp = 0;
+        epoch = 1;
+    }
+}
+
+int SearchWorkspace::pop() {
+    int top = heap[0];
+    NodeState& s = nodes[top];
+    s.heapPos = -1;
+    s.settled = true;
+
+    int last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+        heap[0] = last;
+        nodes[last].heapPos = 0;
+        siftDown(0);
+    }
+    return top;
+}
+
+void SearchWorkspace::siftUp(int pos) {
+    int v = heap[pos];
+    double key = nodes[v].key;
+    while (pos > 0) {
+        int parent = (pos - 1) / ARITY;
+        int p = heap[parent];
+        if (nodes[p].key <= key) break;
+        heap[pos] = p;
+        nodes[p].heapPos = pos;
+        pos = parent;
+    }
+    heap[pos] = v;
+    nodes[v].heapPos = pos;
+}
+
+void SearchWorkspace::siftDown(int pos) {
+    int v = heap[pos];
+    double key = nodes[v].key;
+    int size = (int)heap.size();
+    while (true) {
+        int first = pos * ARITY + 1;
+        if (first >= size) break;
+
+        int best = first;
+        double bestKey = nodes[heap[first]].key;
+        int end = first + ARITY < size ? first + ARITY : size;
+        for (int c = first + 1; c < end; c++) {
+            double k = nodes[heap[c]].key;
+            if (k < bestKey) {
+                best = c;
+                bestKey = k;
+            }
+        }
+        if (bestKey >= key) break;
+
+        heap[pos] = heap[best];
+        nodes[heap[pos]].heapPos = pos;
+        pos = best;
+    }
+    heap[pos] = v;
+    nodes[v].heapPos = pos;
+}
+
+SearchWorkspace& SearchWorkspace::forThread(int slot) {
+    thread_local SearchWorkspace workspaces[WORKSPACE_SLOTS];
+    return workspaces[slot];
+}
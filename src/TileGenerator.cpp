@@ -0,0 +1,425 @@
+#include "../include/TileGenerator.h"
+#include "../include/Projection.h"
+#include "../include/Parallel.h"
+#include "../include/FileIO.h"
+#include <algorithm>
+#include <unordered_set>
+#include <fstream>
+#include <cmath>
+
+namespace {
+const double PI = 3.14159265358979323846;
+const double MAX_LATITUDE = 85.0511287798;  // Límite de Web Mercator
+const double MARGIN = 4;  // Píxeles de más alrededor de la tesela (trazos y círculos)
+
+// Mismos estilos que Renderer
+const Color BACKGROUND(240, 240, 240);
+const Color STREET(50, 50, 50);
+const Color POLYGON_FILL(200, 200, 200);
+const Color POINT_FILL(255, 255, 255);
+
+// Liang-Barsky: fracciones [t0, t1] del segmento ab dentro de la caja
+bool clipSegment(const Point& a, const Point& b, const Rect& box, double& t0, double& t1) {
+    double dx = b.x - a.x, dy = b.y - a.y;
+    const double p[4] = {-dx, dx, -dy, dy};
+    const double q[4] = {a.x - box.minX, box.maxX - a.x, a.y - box.minY, box.maxY - a.y};
+    t0 = 0;
+    t1 = 1;
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0) {
+            if (q[i] < 0) return false;
+            continue;
+        }
+        double t = q[i] / p[i];
+        if (p[i] < 0) t0 = std::max(t0, t);
+        else t1 = std::min(t1, t);
+        if (t0 > t1) return false;
+    }
+    return true;
+}
+
+// Sutherland-Hodgman contra un lado de la caja (side: 0 = izq, 1 = der,
+// 2 = arriba, 3 = abajo en píxeles)
+void clipRing(const std::vector<Point>& in, const Rect& box, int side, std::vector<Point>& out) {
+    out.clear();
+    auto inside = [&](const Point& p) {
+        switch (side) {
+            case 0: return p.x >= box.minX;
+            case 1: return p.x <= box.maxX;
+            case 2: return p.y >= box.minY;
+            default: return p.y <= box.maxY;
+        }
+    };
+    auto cross = [&](const Point& a, const Point& b) {
+        double t;
+        switch (side) {
+            case 0: t = (box.minX - a.x) / (b.x - a.x); break;
+            case 1: t = (box.maxX - a.x) / (b.x - a.x); break;
+            case 2: t = (box.minY - a.y) / (b.y - a.y); break;
+            default: t = (box.maxY - a.y) / (b.y - a.y); break;
+        }
+        return Point(a.x + t * (b.x - a.x), a.y + t * (b.y - a.y));
+    };
+
+    for (size_t i = 0; i < in.size(); i++) {
+        const Point& a = in[i];
+        const Point& b = in[(i + 1) % in.size()];
+        bool aIn = inside(a), bIn = inside(b);
+        if (aIn && bIn) {
+            out.push_back(b);
+        } else if (aIn) {
+            out.push_back(cross(a, b));
+        } else if (bIn) {
+            out.push_back(cross(a, b));
+            out.push_back(b);
+        }
+    }
+}
+}
+
+// ---------------------------------------------------------------------------
+// TileCache
+
+TileCache::TileCache(size_t capacityBytes) : capacity(capacityBytes), used(0), hits(0), misses(0) {}
+
+bool TileCache::get(const TileKey& key, std::vector<uint8_t>& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = lookup.find(key.pack());
+    if (it == lookup.end()) {
+        misses++;
+        return false;
+    }
+    entries.splice(entries.begin(), entries, it->second);  // Pasa a ser la más reciente
+    out = it->second->second;
+    hits++;
+    return true;
+}
+
+void TileCache::put(const TileKey& key, const std::vector<uint8_t>& data) {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t packed = key.pack();
+    auto it = lookup.find(packed);
+    if (it != lookup.end()) {
+        used -= it->second->second.size();
+        entries.erase(it->second);
+        lookup.erase(it);
+    }
+    if (data.size() > capacity) return;
+
+    entries.push_front(std::make_pair(packed, data));
+    lookup[packed] = entries.begin();
+    used += data.size();
+
+    // Descartar las menos usadas hasta volver a la capacidad
+    while (used > capacity) {
+        used -= entries.back().second.size();
+        lookup.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+bool TileCache::erase(const TileKey& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = lookup.find(key.pack());
+    if (it == lookup.end()) return false;
+    used -= it->second->second.size();
+    entries.erase(it->second);
+    lookup.erase(it);
+    return true;
+}
+
+void TileCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    lookup.clear();
+    used = 0;
+    hits = misses = 0;
+}
+
+void TileCache::setCapacity(size_t capacityBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capacity = capacityBytes;
+    while (used > capacity) {
+        used -= entries.back().second.size();
+        lookup.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+size_t TileCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t TileCache::getBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+size_t TileCache::getHits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+size_t TileCache::getMisses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+// ---------------------------------------------------------------------------
+// Geometría de las teselas
+
+Point TileGenerator::toPixel(const Point& lonLat, int z) {
+    double scale = std::ldexp((double)TILE_SIZE, z);
+    double lat = std::max(-MAX_LATITUDE, std::min(MAX_LATITUDE, lonLat.y));
+    double s = std::sin(lat * PI / 180);
+    return Point((lonLat.x + 180) / 360 * scale,
+                 (0.5 - std::log((1 + s) / (1 - s)) / (4 * PI)) * scale);
+}
+
+Rect TileGenerator::tileBounds(const TileKey& key) {
+    double n = std::ldexp(1.0, key.z);
+    auto latitude = [&](int y) { return std::atan(std::sinh(PI * (1 - 2 * y / n))) * 180 / PI; };
+    return Rect(key.x / n * 360 - 180, latitude(key.y + 1), (key.x + 1) / n * 360 - 180, latitude(key.y));
+}
+
+void TileGenerator::tileRange(const Rect& area, int z, int& x0, int& y0, int& x1, int& y1) {
+    int last = (1 << z) - 1;
+    Point topLeft = toPixel(Point(area.minX, area.maxY), z);
+    Point bottomRight = toPixel(Point(area.maxX, area.minY), z);
+    x0 = std::max(0, std::min(last, (int)std::floor(topLeft.x / TILE_SIZE)));
+    y0 = std::max(0, std::min(last, (int)std::floor(topLeft.y / TILE_SIZE)));
+    x1 = std::max(0, std::min(last, (int)std::floor(bottomRight.x / TILE_SIZE)));
+    y1 = std::max(0, std::min(last, (int)std::floor(bottomRight.y / TILE_SIZE)));
+}
+
+void TileGenerator::clipLine(const Point* pts, int count, const Rect& box, std::vector<Point>& out,
+                             std::vector<int>& counts) {
+    // Tramos consecutivos dentro de la caja, cada uno como polilínea
+    size_t partStart = out.size();
+    auto flush = [&]() {
+        size_t length = out.size() - partStart;
+        if (length > 1) counts.push_back((int)length);
+        else out.resize(partStart);
+        partStart = out.size();
+    };
+    for (int i = 1; i < count; i++) {
+        const Point& a = pts[i - 1];
+        const Point& b = pts[i];
+        double t0, t1;
+        if (!clipSegment(a, b, box, t0, t1)) {
+            flush();
+            continue;
+        }
+        if (t0 > 0 || out.size() == partStart) {
+            flush();
+            out.push_back(Point(a.x + t0 * (b.x - a.x), a.y + t0 * (b.y - a.y)));
+        }
+        out.push_back(Point(a.x + t1 * (b.x - a.x), a.y + t1 * (b.y - a.y)));
+        if (t1 < 1) flush();
+    }
+    flush();
+}
+
+void TileGenerator::clipPolygon(const Point* ring, int count, const Rect& box, std::vector<Point>& out,
+                                std::vector<Point>& scratch) {
+    out.assign(ring, ring + count);
+    for (int side = 0; side < 4 && out.size() > 2; side++) {
+        clipRing(out, box, side, scratch);
+        out.swap(scratch);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// TileGenerator
+
+TileGenerator::TileGenerator(const LayerManager& source, TileFormat tileFormat, size_t cacheBytes)
+    : layers(&source), format(tileFormat), cache(cacheBytes), threadCount(0), minZoom(-1), maxZoom(-1),
+      rendered(0) {}
+
+void TileGenerator::drawFeature(GeometryType type, Workspace& ws) const {
+    // ws.points en píxeles de la tesela; se recorta a la tesela más el margen
+    const std::vector<Point>& pts = ws.points;
+    if (pts.empty()) return;
+    Rect box(-MARGIN, -MARGIN, TILE_SIZE + MARGIN, TILE_SIZE + MARGIN);
+    Pen pen(STREET, 1);
+
+    if (type == GEOM_POINT) {
+        if (box.contains(pts[0])) ws.canvas.drawCircle(pts[0], 3, POINT_FILL, pen);
+        return;
+    }
+
+    Rect extent(pts[0]);
+    for (const auto& p : pts) extent.expand(p);
+    if (!extent.intersects(box)) return;
+    bool inside = box.contains(extent);
+
+    if (type == GEOM_LINESTRING) {
+        if (inside) {
+            ws.canvas.drawPolyline(pts.data(), (int)pts.size(), pen);
+            return;
+        }
+
+        ws.clipped.clear();
+        ws.counts.clear();
+        clipLine(pts.data(), (int)pts.size(), box, ws.clipped, ws.counts);
+        const Point* part = ws.clipped.data();
+        for (int length : ws.counts) {
+            ws.canvas.drawPolyline(part, length, pen);
+            part += length;
+        }
+
+    } else if (type == GEOM_POLYGON) {
+        int count = (int)pts.size();
+        if (count > 1 && pts.front().x == pts.back().x && pts.front().y == pts.back().y) {
+            count--;  // El anillo se cierra solo
+        }
+        if (inside) ws.clipped.assign(pts.begin(), pts.begin() + count);
+        else clipPolygon(pts.data(), count, box, ws.clipped, ws.scratch);
+        count = (int)ws.clipped.size();
+        if (count > 2) ws.canvas.drawPolygon(ws.clipped.data(), &count, 1, POLYGON_FILL, pen);
+    }
+}
+
+void TileGenerator::renderTile(const TileKey& key, Workspace& ws) const {
+    if (format == TILE_MVT) {
+        ws.encoder.encode(*layers, key, ws.data);
+        return;
+    }
+    ws.canvas.clear(BACKGROUND);
+
+    // Caja de la consulta: la tesela más el margen, en lon/lat
+    Rect bounds = tileBounds(key);
+    double pixelSize = (bounds.maxX - bounds.minX) / TILE_SIZE;
+    double pixelHeight = (bounds.maxY - bounds.minY) / TILE_SIZE;
+    Rect area(bounds.minX - MARGIN * pixelSize, bounds.minY - MARGIN * pixelHeight,
+              bounds.maxX + MARGIN * pixelSize, bounds.maxY + MARGIN * pixelHeight);
+    double originX = (double)key.x * TILE_SIZE, originY = (double)key.y * TILE_SIZE;
+
+    for (size_t i = 0; i < layers->getLayerCount(); i++) {
+        const Layer& layer = layers->getLayerAt(i);
+        if (!layer.visible) continue;
+
+        // Igual que Renderer: nivel de detalle según el tamaño del píxel
+        int level = layer.lod.levelFor(pixelSize);
+        if (level > 0) {
+            ws.items.clear();
+            layer.lod.search(level, area, ws.items);
+            for (size_t item : ws.items) {
+                int count = layer.lod.getVertexCount(level, item);
+                ws.points.clear();
+                for (int k = 0; k < count; k++) {
+                    Point p = toPixel(layer.lod.getVertex(level, item, k), key.z);
+                    ws.points.push_back(Point(p.x - originX, p.y - originY));
+                }
+                drawFeature(layer.lod.getSource(level, item).type, ws);
+            }
+            continue;
+        }
+
+        ws.geometries.clear();
+        layer.index.rangeSearch(area, ws.geometries);
+        for (const Geometry* geom : ws.geometries) {
+            if (geom->type != GEOM_POINT && geom->mbr.maxX - geom->mbr.minX < pixelSize &&
+                geom->mbr.maxY - geom->mbr.minY < pixelHeight) {
+                continue;  // Cabe en un píxel
+            }
+            ws.points.clear();
+            for (const auto& lonLat : geom->points) {
+                Point p = toPixel(lonLat, key.z);
+                ws.points.push_back(Point(p.x - originX, p.y - originY));
+            }
+            drawFeature(geom->type, ws);
+        }
+    }
+
+    ws.canvas.encodePNG(ws.data);
+}
+
+bool TileGenerator::saveTile(const TileKey& key, const std::vector<uint8_t>& data) const {
+    std::string folder = directory + "/" + std::to_string(key.z) + "/" + std::to_string(key.x);
+    if (!createDirectories(folder)) return false;
+
+    const char* extension = format == TILE_MVT ? ".mvt" : ".png";
+    std::ofstream file(folder + "/" + std::to_string(key.y) + extension, std::ios::binary);
+    if (!file) return false;
+    file.write((const char*)data.data(), data.size());
+    return file.good();
+}
+
+int TileGenerator::renderAll(const std::vector<TileKey>& keys) {
+    int threads = resolveThreadCount(threadCount);
+    std::vector<Workspace> workspaces(std::min(threads, std::max(1, (int)keys.size())));
+    std::atomic<int> failed(0);
+
+    parallelForThreads((int)keys.size(), (int)workspaces.size(), [&](int i, int thread) {
+        Workspace& ws = workspaces[thread];
+        renderTile(keys[i], ws);
+        cache.put(keys[i], ws.data);
+        if (!directory.empty() && !saveTile(keys[i], ws.data)) failed++;
+    });
+
+    rendered += keys.size();
+    return (int)keys.size() - failed;
+}
+
+bool TileGenerator::getTile(const TileKey& key, std::vector<uint8_t>& data) {
+    if (key.z < 0 || key.z > 30 || key.x < 0 || key.y < 0 || key.x >= (1 << key.z) ||
+        key.y >= (1 << key.z)) {
+        return false;
+    }
+    if (cache.get(key, data)) return true;
+
+    Workspace ws;
+    renderTile(key, ws);
+    cache.put(key, ws.data);
+    rendered++;
+    data.swap(ws.data);
+    return true;
+}
+
+int TileGenerator::generate(int fromZoom, int toZoom) {
+    Rect bounds = layers->getBounds();
+    if (layers->empty() || !Projection::isGeographic(bounds) || fromZoom < 0 || toZoom > 30 ||
+        fromZoom > toZoom) {
+        return 0;
+    }
+
+    std::vector<TileKey> keys;
+    for (int z = fromZoom; z <= toZoom; z++) {
+        int x0, y0, x1, y1;
+        tileRange(bounds, z, x0, y0, x1, y1);
+        for (int x = x0; x <= x1; x++) {
+            for (int y = y0; y <= y1; y++) keys.push_back(TileKey(z, x, y));
+        }
+    }
+
+    minZoom = fromZoom;
+    maxZoom = toZoom;
+    return renderAll(keys);
+}
+
+int TileGenerator::update(const std::vector<Rect>& changed) {
+    if (!hasPyramid() || changed.empty()) return 0;
+
+    // Teselas distintas que tocan alguna caja (con el margen de la tesela,
+    // un trazo que entra desde la vecina también la cambia)
+    std::vector<TileKey> keys;
+    std::unordered_set<uint64_t> seen;
+    for (int z = minZoom; z <= maxZoom; z++) {
+        double pixelDegrees = 360.0 / std::ldexp((double)TILE_SIZE, z);
+        for (const auto& box : changed) {
+            double pad = MARGIN * pixelDegrees;
+            Rect area(box.minX - pad, box.minY - pad, box.maxX + pad, box.maxY + pad);
+            int x0, y0, x1, y1;
+            tileRange(area, z, x0, y0, x1, y1);
+            for (int x = x0; x <= x1; x++) {
+                for (int y = y0; y <= y1; y++) {
+                    TileKey key(z, x, y);
+                    if (seen.insert(key.pack()).second) keys.push_back(key);
+                }
+            }
+        }
+    }
+    return renderAll(keys);
+}
@@ -0,0 +1,75 @@
+#include "../include/UnitIndex.h"
+#include <algorithm>
+
+UnitIndex::UnitIndex() : graph(nullptr) {}
+
+void UnitIndex::clear() {
+    graph = nullptr;
+    positions.clear();
+    snaps.clear();
+    edgeFirst.clear();
+    edgeUnits.clear();
+    euclidean.clear();
+}
+
+bool UnitIndex::build(const Graph& g, const std::deque<Geometry>& geometries) {
+    std::vector<Point> centers;
+    centers.reserve(geometries.size());
+    for (const auto& geom : geometries) centers.push_back(geom.mbr.center());
+    return build(g, centers);
+}
+
+bool UnitIndex::build(const Graph& g, const std::vector<Point>& unitPositions) {
+    clear();
+    if (g.getNodeCount() == 0) return false;
+
+    int count = (int)unitPositions.size();
+    positions = unitPositions;
+    snaps.resize(count);
+    for (int i = 0; i < count; i++) {
+        if (!g.snapToEdge(positions[i], snaps[i])) {
+            clear();
+            return false;
+        }
+    }
+
+    // Listas por arista: contar, acumular y repartir (orden estable)
+    edgeFirst.assign(g.getEdgeCount() + 1, 0);
+    for (const auto& snap : snaps) edgeFirst[g.getEdgeId(snap.edge) + 1]++;
+    for (int id = 0; id < g.getEdgeCount(); id++) edgeFirst[id + 1] += edgeFirst[id];
+
+    edgeUnits.resize(count);
+    std::vector<int> cursor(edgeFirst.begin(), edgeFirst.end() - 1);
+    for (int i = 0; i < count; i++) edgeUnits[cursor[g.getEdgeId(snaps[i].edge)]++] = i;
+
+    // Hojas en orden de Hilbert sobre el punto ubicado en la red: la
+    // distancia euclidiana entre puntos de la red nunca supera la de ruta
+    if (count > 0) {
+        std::vector<Point> located(count);
+        Rect extent;
+        for (int i = 0; i < count; i++) {
+            located[i] = g.getSnapPosition(snaps[i], true);
+            if (i == 0) {
+                extent = Rect(located[i]);
+            } else {
+                extent.expand(located[i]);
+            }
+        }
+
+        std::vector<std::pair<uint32_t, int>> order(count);
+        for (int i = 0; i < count; i++) {
+            order[i] = std::make_pair(PackedRTree::hilbertIndex(located[i], extent), i);
+        }
+        std::sort(order.begin(), order.end());
+
+        std::vector<PackedRTreeItem> leaves(count);
+        for (int i = 0; i < count; i++) {
+            leaves[i].box = Rect(located[order[i].second]);
+            leaves[i].offset = (uint64_t)order[i].second;
+        }
+        euclidean.build(leaves);
+    }
+
+    graph = &g;
+    return true;
+}
@@ -0,0 +1,217 @@
+#include "../include/VectorTile.h"
+#include "../include/TileGenerator.h"
+#include "../include/LayerManager.h"
+#include "../include/Protobuf.h"
+#include <cmath>
+
+namespace {
+// Tipos y comandos de geometría de MVT 2.1
+const int MVT_POINT = 1;
+const int MVT_LINESTRING = 2;
+const int MVT_POLYGON = 3;
+const uint32_t CMD_MOVE_TO = 1;
+const uint32_t CMD_LINE_TO = 2;
+const uint32_t CMD_CLOSE_PATH = 7;
+
+inline uint32_t command(uint32_t id, uint32_t count) { return (id & 7) | (count << 3); }
+}
+
+bool VectorTileEncoder::encodePart(const Point* pts, int count, GeometryType type, int32_t& cursorX,
+                                   int32_t& cursorY) {
+    // A la rejilla, sin vértices repetidos (la cuantización es la última
+    // simplificación: varios vértices caen en la misma celda)
+    grid.clear();
+    for (int i = 0; i < count; i++) {
+        int32_t x = (int32_t)std::lround(pts[i].x);
+        int32_t y = (int32_t)std::lround(pts[i].y);
+        size_t n = grid.size();
+        if (n > 0 && grid[n - 2] == x && grid[n - 1] == y) continue;
+        grid.push_back(x);
+        grid.push_back(y);
+    }
+    int n = (int)grid.size() / 2;
+
+    bool reversed = false;
+    if (type == GEOM_POLYGON) {
+        if (n > 1 && grid[0] == grid[2 * n - 2] && grid[1] == grid[2 * n - 1]) n--;  // ClosePath lo cierra
+        if (n < 3) return false;
+
+        // El anillo exterior va en sentido horario con y hacia abajo: área positiva
+        int64_t area = 0;
+        for (int i = 0; i < n; i++) {
+            int j = (i + 1) % n;
+            area += (int64_t)grid[2 * i] * grid[2 * j + 1] - (int64_t)grid[2 * j] * grid[2 * i + 1];
+        }
+        if (area == 0) return false;
+        reversed = area < 0;
+    } else if (type == GEOM_LINESTRING) {
+        if (n < 2) return false;
+    }
+
+    // Parámetros: deltas respecto del cursor en zigzag
+    for (int k = 0; k < n; k++) {
+        int i = reversed ? n - 1 - k : k;
+        if (k == 0) commands.push_back(command(CMD_MOVE_TO, 1));
+        else if (k == 1) commands.push_back(command(CMD_LINE_TO, n - 1));
+        int32_t x = grid[2 * i], y = grid[2 * i + 1];
+        commands.push_back((uint32_t)ProtobufWriter::zigzag(x - cursorX));
+        commands.push_back((uint32_t)ProtobufWriter::zigzag(y - cursorY));
+        cursorX = x;
+        cursorY = y;
+    }
+    if (type == GEOM_POLYGON) commands.push_back(command(CMD_CLOSE_PATH, 1));
+    return true;
+}
+
+void VectorTileEncoder::addFeature(const Geometry& source, GeometryType type) {
+    // points ya está en unidades de la tesela; se recorta al borde
+    if (points.empty()) return;
+    Rect box(-BUFFER, -BUFFER, EXTENT + BUFFER, EXTENT + BUFFER);
+    commands.clear();
+    int32_t cursorX = 0, cursorY = 0;
+    int mvtType;
+
+    if (type == GEOM_POINT) {
+        if (!box.contains(points[0])) return;
+        encodePart(points.data(), 1, type, cursorX, cursorY);
+        mvtType = MVT_POINT;
+    } else {
+        Rect extent(points[0]);
+        for (const auto& p : points) extent.expand(p);
+        if (!extent.intersects(box)) return;
+        bool inside = box.contains(extent);
+
+        if (type == GEOM_LINESTRING) {
+            // Los tramos que quedan dentro van como una línea múltiple
+            clipped.clear();
+            counts.clear();
+            if (inside) {
+                clipped.assign(points.begin(), points.end());
+                counts.push_back((int)points.size());
+            } else {
+                TileGenerator::clipLine(points.data(), (int)points.size(), box, clipped, counts);
+            }
+            const Point* part = clipped.data();
+            for (int length : counts) {
+                encodePart(part, length, type, cursorX, cursorY);
+                part += length;
+            }
+            mvtType = MVT_LINESTRING;
+        } else {
+            int count = (int)points.size();
+            if (count > 1 && points.front().x == points.back().x && points.front().y == points.back().y) {
+                count--;
+            }
+            if (inside) clipped.assign(points.begin(), points.begin() + count);
+            else TileGenerator::clipPolygon(points.data(), count, box, clipped, scratch);
+            encodePart(clipped.data(), (int)clipped.size(), type, cursorX, cursorY);
+            mvtType = MVT_POLYGON;
+        }
+    }
+    if (commands.empty()) return;
+
+    // Atributos como índices a las claves y valores de la capa
+    tags.clear();
+    for (const auto& property : source.properties) {
+        auto k = keyIndex.emplace(property.first, (uint32_t)keys.size());
+        if (k.second) keys.push_back(&k.first->first);
+        auto v = valueIndex.emplace(property.second, (uint32_t)values.size());
+        if (v.second) values.push_back(&v.first->first);
+        tags.push_back(k.first->second);
+        tags.push_back(v.first->second);
+    }
+
+    feature.clear();
+    ProtobufWriter writer(feature);
+    if (source.id >= 0) writer.field(1, (uint64_t)source.id);
+    writer.packed(2, tags);
+    writer.field(3, (uint64_t)mvtType);
+    writer.packed(4, commands);
+    ProtobufWriter(layer).bytes(2, feature);
+    featureCount++;
+    if (!tags.empty()) taggedCount++;
+}
+
+void VectorTileEncoder::addLayer(const std::string& name, std::vector<uint8_t>& out) {
+    // Lo que va después de las entidades: claves, valores (de texto),
+    // extent y versión
+    feature.clear();
+    ProtobufWriter tail(feature);
+    for (const std::string* k : keys) tail.string(3, *k);
+    for (const std::string* v : values) {
+        tail.key(4, WIRE_LENGTH);
+        tail.varint(1 + ProtobufWriter::varintSize(v->size()) + v->size());
+        tail.string(1, *v);
+    }
+    tail.field(5, EXTENT);
+    tail.field(15, 2);
+
+    ProtobufWriter writer(out);
+    size_t nameSize = 1 + ProtobufWriter::varintSize(name.size()) + name.size();
+    writer.key(3, WIRE_LENGTH);
+    writer.varint(nameSize + layer.size() + feature.size());
+    writer.string(1, name);
+    out.insert(out.end(), layer.begin(), layer.end());
+    out.insert(out.end(), feature.begin(), feature.end());
+}
+
+void VectorTileEncoder::encode(const LayerManager& layers, const TileKey& key, std::vector<uint8_t>& out) {
+    out.clear();
+    featureCount = 0;
+    taggedCount = 0;
+
+    // Caja de la consulta: la tesela más el borde, en lon/lat
+    const int tileSize = TileGenerator::TILE_SIZE;
+    const double scale = (double)EXTENT / tileSize;
+    Rect bounds = TileGenerator::tileBounds(key);
+    double pixelSize = (bounds.maxX - bounds.minX) / tileSize;
+    double pixelHeight = (bounds.maxY - bounds.minY) / tileSize;
+    double margin = BUFFER / scale;
+    Rect area(bounds.minX - margin * pixelSize, bounds.minY - margin * pixelHeight,
+              bounds.maxX + margin * pixelSize, bounds.maxY + margin * pixelHeight);
+    double originX = (double)key.x * tileSize, originY = (double)key.y * tileSize;
+    auto toTile = [&](const Point& lonLat) {
+        Point p = TileGenerator::toPixel(lonLat, key.z);
+        return Point((p.x - originX) * scale, (p.y - originY) * scale);
+    };
+
+    for (size_t i = 0; i < layers.getLayerCount(); i++) {
+        const Layer& source = layers.getLayerAt(i);
+        if (!source.visible) continue;
+
+        layer.clear();
+        keyIndex.clear();
+        valueIndex.clear();
+        keys.clear();
+        values.clear();
+        size_t before = featureCount;
+
+        // Simplificación por zoom: el mismo nivel de detalle que el dibujo
+        int level = source.lod.levelFor(pixelSize);
+        if (level > 0) {
+            items.clear();
+            source.lod.search(level, area, items);
+            for (size_t item : items) {
+                int count = source.lod.getVertexCount(level, item);
+                points.clear();
+                for (int k = 0; k < count; k++) points.push_back(toTile(source.lod.getVertex(level, item, k)));
+                const Geometry& geom = source.lod.getSource(level, item);
+                addFeature(geom, geom.type);
+            }
+        } else {
+            geometries.clear();
+            source.index.rangeSearch(area, geometries);
+            for (const Geometry* geom : geometries) {
+                if (geom->type != GEOM_POINT && geom->mbr.maxX - geom->mbr.minX < pixelSize &&
+                    geom->mbr.maxY - geom->mbr.minY < pixelHeight) {
+                    continue;  // Cabe en un píxel
+                }
+                points.clear();
+                for (const auto& lonLat : geom->points) points.push_back(toTile(lonLat));
+                addFeature(*geom, geom->type);
+            }
+        }
+
+        if (featureCount > before) addLayer(source.name, out);
+    }
+}